@@ -0,0 +1,118 @@
+#include "adc_dma.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+
+struct AdcDmaStream {
+    bool running;
+    int channel;             // ADC FIFO -> sample ring, paced by the ADC DREQ
+    uint32_t cycles_x256;    // clk_adc cycles between conversions, 8 fractional bits
+    uint32_t clk_mhz;
+    uint64_t start_us;
+    volatile uint32_t runs;  // Completed runs, each re-armed
+};
+
+static AdcDmaStream adc_dma_stream = {false, -1, 0, 0, 0, 0};
+
+// A run ends after ADC_DMA_RUN_SAMPLES samples (minutes at full rate):
+// start the channel again where it left off
+static void adc_dma_irq_handler() {
+    AdcDmaStream* s = &adc_dma_stream;
+    if (!dma_channel_get_irq1_status(s->channel)) return;
+
+    dma_channel_acknowledge_irq1(s->channel);
+    s->runs++;
+    dma_channel_set_trans_count(s->channel, ADC_DMA_RUN_SAMPLES, true);
+}
+
+bool adc_dma_stream_start(uint16_t input_mask, uint32_t rate_hz, uint16_t* samples, uint8_t order) {
+    AdcDmaStream* s = &adc_dma_stream;
+    if (s->running || input_mask == 0 || rate_hz == 0) return false;
+
+    // A conversion every (1 + div) cycles, never faster than one conversion takes
+    uint32_t clk_hz = clock_get_hz(clk_adc);
+    uint64_t cycles_x256 = ((uint64_t)clk_hz << 8) / rate_hz;
+    if (cycles_x256 < ADC_DMA_MIN_CYCLES << 8) cycles_x256 = ADC_DMA_MIN_CYCLES << 8;
+    if (cycles_x256 > 0x10000u << 8) cycles_x256 = 0x10000u << 8;
+    s->cycles_x256 = (uint32_t)cycles_x256;
+    s->clk_mhz = clk_hz / 1000000;
+
+    uint first = 0;
+    while (!(input_mask & (1u << first))) first++;
+
+    adc_init();
+    for (uint input = 0; input < ADC_DMA_TEMP_INPUT; input++) {
+        if (input_mask & (1u << input)) adc_gpio_init(26 + input);
+    }
+    adc_set_temp_sensor_enabled(input_mask & (1u << ADC_DMA_TEMP_INPUT));
+    adc_select_input(first);
+    adc_set_round_robin(input_mask);
+    adc_fifo_setup(true, true, 1, false, false);  // DREQ per sample, 12-bit results
+    adc_set_clkdiv((s->cycles_x256 - 256) / 256.0f);
+    adc_fifo_drain();
+
+    s->channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(s->channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, order + 1); // 2-byte entries
+    channel_config_set_dreq(&config, DREQ_ADC);
+    dma_channel_configure(s->channel, &config, samples, &adc_hw->fifo, ADC_DMA_RUN_SAMPLES, true);
+
+    s->runs = 0;
+    irq_add_shared_handler(DMA_IRQ_1, adc_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+    dma_channel_set_irq1_enabled(s->channel, true);
+
+    // The first conversion starts here; every later one is a fixed period on
+    s->start_us = time_us_64();
+    adc_run(true);
+    s->running = true;
+    return true;
+}
+
+void adc_dma_stream_stop() {
+    AdcDmaStream* s = &adc_dma_stream;
+    if (!s->running) return;
+
+    adc_run(false);
+    dma_channel_set_irq1_enabled(s->channel, false);
+    dma_channel_abort(s->channel);
+    dma_channel_unclaim(s->channel);
+    irq_remove_handler(DMA_IRQ_1, adc_dma_irq_handler);
+    adc_set_round_robin(0);
+    adc_fifo_setup(false, false, 0, false, false);
+    adc_fifo_drain();
+    s->running = false;
+}
+
+uint64_t adc_dma_stream_samples() {
+    AdcDmaStream* s = &adc_dma_stream;
+    if (!s->running) return 0;
+
+    // Re-read if the IRQ re-armed the channel between the two reads
+    uint32_t runs;
+    uint32_t remaining;
+    do {
+        runs = s->runs;
+        remaining = dma_hw->ch[s->channel].transfer_count & ADC_DMA_RUN_SAMPLES;
+    } while (runs != s->runs);
+
+    return (uint64_t)runs * ADC_DMA_RUN_SAMPLES + (ADC_DMA_RUN_SAMPLES - remaining);
+}
+
+uint32_t adc_dma_stream_sample_us(uint64_t n) {
+    const AdcDmaStream* s = &adc_dma_stream;
+    return (uint32_t)(s->start_us + n * s->cycles_x256 / ((uint64_t)s->clk_mhz << 8));
+}
+
+uint32_t adc_dma_stream_rate_hz() {
+    const AdcDmaStream* s = &adc_dma_stream;
+    return s->cycles_x256 ? (uint32_t)(((uint64_t)s->clk_mhz * 1000000 << 8) / s->cycles_x256) : 0;
+}
+
+uint32_t adc_dma_stream_restarts() {
+    return adc_dma_stream.runs;
+}
@@ -0,0 +1,143 @@
+#include "adc_stream.h"
+#include <stdio.h>
+#include <string.h>
+#include "adc_dma.h"
+
+#define ADC_STREAM_MASK (ADC_STREAM_ENTRIES - 1)
+
+// DMA ring: ring wrapping needs the buffer aligned to its size in bytes
+static uint16_t adc_stream_samples[ADC_STREAM_ENTRIES] __attribute__((aligned(ADC_STREAM_ENTRIES * 2)));
+
+static bool adc_stream_running = false;
+static uint8_t adc_stream_inputs = 0;
+static uint8_t adc_stream_input[ADC_STREAM_MAX_INPUTS];
+static uint64_t adc_stream_consumed = 0;  // Sample number of the next frame to read
+static AdcStreamStats adc_stream_stats;
+static uint64_t adc_stream_rate_samples = 0;
+static uint32_t adc_stream_rate_us = 0;
+
+bool adc_stream_start(uint16_t input_mask, uint32_t rate_hz) {
+    if (adc_stream_running) return false;
+
+    adc_stream_inputs = 0;
+    for (uint8_t input = 0; input < 16; input++) {
+        if (!(input_mask & (1u << input))) continue;
+        if (adc_stream_inputs == ADC_STREAM_MAX_INPUTS) return false;
+        adc_stream_input[adc_stream_inputs++] = input;
+    }
+
+    memset(&adc_stream_stats, 0, sizeof(adc_stream_stats));
+    adc_stream_consumed = 0;
+    adc_stream_rate_samples = 0;
+    adc_stream_rate_us = time_us_32();
+
+    adc_stream_running = adc_dma_stream_start(input_mask, rate_hz, adc_stream_samples, ADC_STREAM_ORDER);
+    return adc_stream_running;
+}
+
+void adc_stream_stop() {
+    if (!adc_stream_running) return;
+
+    adc_dma_stream_stop();
+    adc_stream_running = false;
+}
+
+// Whole frames a read may take: at most a ring minus the guard
+static uint32_t adc_stream_keep_frames() {
+    return (ADC_STREAM_ENTRIES - ADC_STREAM_GUARD) / adc_stream_inputs;
+}
+
+uint32_t adc_stream_available() {
+    if (!adc_stream_running) return 0;
+
+    uint64_t backlog = (adc_dma_stream_samples() - adc_stream_consumed) / adc_stream_inputs;
+    uint32_t keep = adc_stream_keep_frames();
+    return backlog < keep ? (uint32_t)backlog : keep;
+}
+
+static void adc_stream_update_rate(uint64_t produced) {
+    uint32_t now = time_us_32();
+    if (now - adc_stream_rate_us < 1000000) return;
+
+    adc_stream_stats.rate = (uint32_t)(produced - adc_stream_rate_samples);
+    adc_stream_rate_samples = produced;
+    adc_stream_rate_us = now;
+}
+
+size_t adc_stream_read(AdcBlock* block) {
+    block->frames = 0;
+    if (!adc_stream_running) return 0;
+
+    const uint8_t inputs = adc_stream_inputs;
+    uint64_t produced = adc_dma_stream_samples();
+    adc_stream_stats.received = produced;
+    adc_stream_update_rate(produced);
+
+    uint32_t backlog = (uint32_t)((produced - adc_stream_consumed) / inputs);
+    if (backlog > adc_stream_stats.max_backlog) {
+        adc_stream_stats.max_backlog = backlog;
+    }
+
+    // The ring holds a little under a lap; drop whole frames so the rows
+    // stay with their inputs
+    const uint32_t keep = adc_stream_keep_frames();
+    if (backlog > keep) {
+        adc_stream_stats.dropped += backlog - keep;
+        adc_stream_consumed += (uint64_t)(backlog - keep) * inputs;
+        backlog = keep;
+    }
+
+    size_t count = backlog < ADC_STREAM_BLOCK_FRAMES ? backlog : ADC_STREAM_BLOCK_FRAMES;
+    uint32_t index = (uint32_t)adc_stream_consumed & ADC_STREAM_MASK;
+    for (size_t f = 0; f < count; f++) {
+        for (uint8_t i = 0; i < inputs; i++) {
+            block->samples[i][f] = adc_stream_samples[index];
+            index = (index + 1) & ADC_STREAM_MASK;
+        }
+    }
+
+    // DMA kept going during the copy: drop the oldest frames if it has
+    // since come within the guard of them
+    uint64_t oldest_safe = adc_dma_stream_samples() - (ADC_STREAM_ENTRIES - ADC_STREAM_GUARD);
+    size_t torn = 0;
+    if ((int64_t)(oldest_safe - adc_stream_consumed) > 0) {
+        torn = (size_t)((oldest_safe - adc_stream_consumed + inputs - 1) / inputs);
+        if (torn > count) torn = count;
+        for (uint8_t i = 0; i < inputs; i++) {
+            memmove(block->samples[i], block->samples[i] + torn, (count - torn) * sizeof(uint16_t));
+        }
+        adc_stream_stats.dropped += (uint32_t)torn;
+    }
+
+    uint64_t first = adc_stream_consumed + (uint64_t)torn * inputs;
+    block->timestamp_us = adc_dma_stream_sample_us(first);
+    block->frame_ns = (uint32_t)(1000000000ull * inputs / adc_dma_stream_rate_hz());
+    block->frames = (uint16_t)(count - torn);
+    block->inputs = inputs;
+    memcpy(block->input, adc_stream_input, inputs);
+
+    adc_stream_consumed += (uint64_t)count * inputs;
+    adc_stream_stats.delivered += block->frames;
+    return block->frames;
+}
+
+int adc_stream_row(const AdcBlock* block, uint8_t input) {
+    for (uint8_t i = 0; i < block->inputs; i++) {
+        if (block->input[i] == input) return i;
+    }
+    return -1;
+}
+
+const AdcStreamStats* adc_stream_get_stats() {
+    return &adc_stream_stats;
+}
+
+void adc_stream_print_stats() {
+    if (!adc_stream_running) return;
+
+    const AdcStreamStats* stats = &adc_stream_stats;
+    printf("ADC stream: %u inputs at %u samples/s programmed, %u samples/s received, "
+           "%u frames delivered, %u dropped, backlog max %u of %u, %u DMA re-arms\n",
+           adc_stream_inputs, adc_dma_stream_rate_hz(), stats->rate, stats->delivered, stats->dropped,
+           stats->max_backlog, adc_stream_keep_frames(), adc_dma_stream_restarts());
+}
@@ -0,0 +1,48 @@
+#ifndef ADC_STREAM_H
+#define ADC_STREAM_H
+
+#include "pico/stdlib.h"
+
+// Round-robin ADC acquisition on top of adc_dma: the ring fills at up to
+// 500ksps and the application pulls de-interleaved blocks of whole frames
+// (one conversion of every enabled input) when it gets round to it. A
+// consumer that falls more than a ring behind loses the oldest frames; they
+// are counted, never returned torn or with another input's samples.
+#define ADC_STREAM_ORDER 13                          // log2 ring entries: 16ms at 500ksps
+#define ADC_STREAM_ENTRIES (1u << ADC_STREAM_ORDER)
+#define ADC_STREAM_GUARD 16        // Entries kept clear of the DMA write position while copying
+#define ADC_STREAM_MAX_INPUTS 5    // ADC0-3 and the temperature sensor
+#define ADC_STREAM_BLOCK_FRAMES 128
+
+struct AdcBlock {
+    uint32_t timestamp_us;     // First conversion of the first frame (low 32 bits of the timer)
+    uint32_t frame_ns;         // Between consecutive frames; inputs within a frame are a frame_ns / inputs apart
+    uint16_t frames;
+    uint8_t inputs;
+    uint8_t input[ADC_STREAM_MAX_INPUTS];   // ADC input of each row, ascending
+    uint16_t samples[ADC_STREAM_MAX_INPUTS][ADC_STREAM_BLOCK_FRAMES];
+};
+
+struct AdcStreamStats {
+    uint64_t received;       // Samples written by DMA
+    uint32_t delivered;      // Frames returned by adc_stream_read()
+    uint32_t dropped;        // Frames overwritten before they were read
+    uint32_t max_backlog;    // Most frames waiting at a read
+    uint32_t rate;           // Samples received during the last second
+};
+
+// Setup: rate_hz counts conversions across all inputs (bit n of input_mask
+// = ADC input n, ADC_DMA_TEMP_INPUT for the temperature sensor)
+bool adc_stream_start(uint16_t input_mask, uint32_t rate_hz);
+void adc_stream_stop();
+
+// Consumer: returns the frames copied into block (0 when none are waiting)
+uint32_t adc_stream_available();
+size_t adc_stream_read(AdcBlock* block);
+int adc_stream_row(const AdcBlock* block, uint8_t input);  // -1 if not sampled
+
+// Statistics
+const AdcStreamStats* adc_stream_get_stats();
+void adc_stream_print_stats();
+
+#endif // ADC_STREAM_H
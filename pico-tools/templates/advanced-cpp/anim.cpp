@@ -0,0 +1,236 @@
+#include "anim.h"
+#include <stdio.h>
+#include <string.h>
+
+struct AnimTween {
+    volatile int32_t* target;   // nullptr when the slot is free
+    int32_t from;
+    int32_t to;
+    uint64_t start_us;          // Engine time
+    uint32_t duration_us;
+    AnimEase ease;
+};
+
+struct AnimBus {
+    uint32_t budget;            // Bytes per second
+    uint8_t displays;
+};
+
+struct AnimDisplay {
+    uint8_t bus;
+    uint32_t target_interval_us;
+    uint64_t last_frame_us;
+    uint32_t frame_bytes;       // Running average of bytes per frame
+    uint32_t window_frames;
+    uint32_t window_bytes;
+    AnimDisplayStats stats;
+};
+
+static AnimTween anim_tweens[ANIM_MAX_TWEENS];
+static AnimBus anim_buses[ANIM_MAX_BUSES];
+static AnimDisplay anim_displays[ANIM_MAX_DISPLAYS];
+static uint8_t anim_bus_count = 0;
+static uint8_t anim_display_count = 0;
+
+static uint64_t anim_clock_us = 0;      // Fixed-step engine time
+static uint64_t anim_last_real_us = 0;
+static uint64_t anim_last_sample_us = 0;
+
+// Eased progress in Q16 (0..65536) for linear progress t in Q16
+static uint32_t anim_ease(AnimEase ease, uint32_t t) {
+    switch (ease) {
+        case ANIM_EASE_IN:
+            return (uint32_t)(((uint64_t)t * t) >> 16);
+        case ANIM_EASE_OUT: {
+            uint32_t inv = 65536 - t;
+            return 65536 - (uint32_t)(((uint64_t)inv * inv) >> 16);
+        }
+        case ANIM_EASE_IN_OUT:
+            if (t < 32768) return (uint32_t)(((uint64_t)t * t) >> 15);
+            else {
+                uint32_t inv = 65536 - t;
+                return 65536 - (uint32_t)(((uint64_t)inv * inv) >> 15);
+            }
+        case ANIM_EASE_LINEAR:
+        default:
+            return t;
+    }
+}
+
+static int32_t anim_tween_value(const AnimTween* tween) {
+    uint64_t elapsed = anim_clock_us - tween->start_us;
+    if (elapsed >= tween->duration_us) return tween->to;
+
+    uint32_t t = (uint32_t)((elapsed << 16) / tween->duration_us);
+    int64_t span = (int64_t)tween->to - tween->from;
+    return tween->from + (int32_t)((span * anim_ease(tween->ease, t)) >> 16);
+}
+
+static void anim_step() {
+    anim_clock_us += ANIM_STEP_US;
+
+    for (int i = 0; i < ANIM_MAX_TWEENS; i++) {
+        AnimTween* tween = &anim_tweens[i];
+        if (!tween->target) continue;
+
+        *tween->target = anim_tween_value(tween);
+        if (*tween->target == tween->to && anim_clock_us - tween->start_us >= tween->duration_us) {
+            tween->target = nullptr;
+        }
+    }
+}
+
+static void anim_sample_stats(uint64_t now) {
+    uint64_t elapsed = now - anim_last_sample_us;
+    if (elapsed < 1000000) return;
+
+    for (uint8_t i = 0; i < anim_display_count; i++) {
+        AnimDisplay* display = &anim_displays[i];
+        uint32_t budget = anim_buses[display->bus].budget;
+        uint64_t bytes_per_sec = (uint64_t)display->window_bytes * 1000000 / elapsed;
+
+        display->stats.fps = (uint32_t)((uint64_t)display->window_frames * 1000000 / elapsed);
+        display->stats.utilisation_pct = budget ? (uint32_t)(bytes_per_sec * 100 / budget) : 0;
+        display->window_frames = 0;
+        display->window_bytes = 0;
+    }
+    anim_last_sample_us = now;
+}
+
+uint32_t anim_update() {
+    uint64_t now = time_us_64();
+    if (anim_last_real_us == 0) {
+        anim_last_real_us = now;
+        anim_last_sample_us = now;
+    }
+
+    uint32_t steps = 0;
+    while (now - anim_last_real_us >= ANIM_STEP_US) {
+        anim_last_real_us += ANIM_STEP_US;
+
+        // Past the catch-up limit, time is dropped rather than replayed later
+        if (steps < ANIM_MAX_CATCHUP) {
+            anim_step();
+            steps++;
+        }
+    }
+
+    anim_sample_stats(now);
+    return steps;
+}
+
+uint64_t anim_time_us() {
+    return anim_clock_us;
+}
+
+static AnimTween* anim_find_tween(const volatile int32_t* target) {
+    for (int i = 0; i < ANIM_MAX_TWEENS; i++) {
+        if (anim_tweens[i].target == target) return &anim_tweens[i];
+    }
+    return nullptr;
+}
+
+void anim_tween_to(volatile int32_t* target, int32_t to, uint32_t duration_ms, AnimEase ease) {
+    AnimTween* tween = anim_find_tween(target);
+    if (tween && tween->to == to) return;
+    if (!tween && *target == to) return;
+
+    if (!tween) tween = anim_find_tween(nullptr);
+    if (!tween || duration_ms == 0) {
+        // No free slot (or no duration): jump straight there
+        if (tween) tween->target = nullptr;
+        *target = to;
+        return;
+    }
+
+    tween->target = target;
+    tween->from = *target;
+    tween->to = to;
+    tween->start_us = anim_clock_us;
+    tween->duration_us = duration_ms * 1000;
+    tween->ease = ease;
+}
+
+void anim_tween_cancel(volatile int32_t* target) {
+    AnimTween* tween = anim_find_tween(target);
+    if (tween) tween->target = nullptr;
+}
+
+bool anim_tween_active(const volatile int32_t* target) {
+    return anim_find_tween(target) != nullptr;
+}
+
+int anim_add_bus(uint32_t bytes_per_sec) {
+    if (anim_bus_count >= ANIM_MAX_BUSES) return -1;
+
+    anim_buses[anim_bus_count].budget = bytes_per_sec;
+    anim_buses[anim_bus_count].displays = 0;
+    return anim_bus_count++;
+}
+
+int anim_add_display(int bus, uint32_t target_fps) {
+    if (bus < 0 || bus >= anim_bus_count || anim_display_count >= ANIM_MAX_DISPLAYS) return -1;
+
+    AnimDisplay* display = &anim_displays[anim_display_count];
+    memset(display, 0, sizeof(AnimDisplay));
+    display->bus = (uint8_t)bus;
+    display->target_interval_us = 1000000 / (target_fps ? target_fps : 1);
+    display->stats.interval_us = display->target_interval_us;
+    anim_buses[bus].displays++;
+    return anim_display_count++;
+}
+
+// Target interval, stretched so the display's recent frame size fits its
+// even share of the bus budget
+static uint32_t anim_display_interval(const AnimDisplay* display) {
+    const AnimBus* bus = &anim_buses[display->bus];
+    uint32_t share = bus->budget / (bus->displays ? bus->displays : 1);
+    if (share == 0) return display->target_interval_us;
+
+    uint32_t needed = (uint32_t)((uint64_t)display->frame_bytes * 1000000 / share);
+    return needed > display->target_interval_us ? needed : display->target_interval_us;
+}
+
+bool anim_frame_due(int display_id) {
+    if (display_id < 0 || display_id >= anim_display_count) return false;
+
+    AnimDisplay* display = &anim_displays[display_id];
+    if (display->stats.frames == 0) return true;
+
+    display->stats.interval_us = anim_display_interval(display);
+    return time_us_64() - display->last_frame_us >= display->stats.interval_us;
+}
+
+void anim_frame_done(int display_id, uint32_t bytes) {
+    if (display_id < 0 || display_id >= anim_display_count) return;
+
+    AnimDisplay* display = &anim_displays[display_id];
+    uint64_t now = time_us_64();
+
+    // Whole target intervals that went by without a frame were dropped
+    if (display->stats.frames > 0) {
+        uint64_t late = now - display->last_frame_us;
+        uint32_t intervals = (uint32_t)(late / display->target_interval_us);
+        if (intervals > 1) display->stats.dropped += intervals - 1;
+    }
+
+    display->frame_bytes = (display->frame_bytes * 3 + bytes) / 4;
+    display->last_frame_us = now;
+    display->stats.frames++;
+    display->window_frames++;
+    display->window_bytes += bytes;
+}
+
+const AnimDisplayStats* anim_get_display_stats(int display_id) {
+    if (display_id < 0 || display_id >= anim_display_count) return nullptr;
+    return &anim_displays[display_id].stats;
+}
+
+void anim_print_stats() {
+    for (uint8_t i = 0; i < anim_display_count; i++) {
+        const AnimDisplay* display = &anim_displays[i];
+        printf("Display %u (bus %u): %u fps, %u dropped, %u%% of bus budget, interval %uus\n",
+               i, display->bus, display->stats.fps, display->stats.dropped,
+               display->stats.utilisation_pct, display->stats.interval_us);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef ANIM_H
+#define ANIM_H
+
+#include "pico/stdlib.h"
+
+// Animation engine: tweened values on a fixed-timestep clock, plus a frame
+// governor that paces each display against its bus's byte budget.
+
+// Fixed timestep; tweens advance in whole steps so motion is the same at
+// any loop rate. A slow loop catches up at most ANIM_MAX_CATCHUP steps.
+#define ANIM_STEP_US 5000
+#define ANIM_MAX_CATCHUP 8
+#define ANIM_MAX_TWEENS 16
+#define ANIM_MAX_BUSES 4
+#define ANIM_MAX_DISPLAYS 8
+
+// Bus budget for anim_add_bus(), in bytes per second, from an SCL rate in
+// Hz: 9 clocks per byte (8 data + ACK), less 10% for START/STOP and gaps
+// (40000 bytes/s at 400kHz)
+#define ANIM_I2C_BUDGET(baudrate) ((uint32_t)((uint64_t)(baudrate) * 90u / (9u * 100u)))
+
+enum AnimEase {
+    ANIM_EASE_LINEAR,
+    ANIM_EASE_IN,       // Quadratic
+    ANIM_EASE_OUT,
+    ANIM_EASE_IN_OUT
+};
+
+struct AnimDisplayStats {
+    uint32_t fps;              // Frames sent during the last second
+    uint32_t frames;
+    uint32_t dropped;          // Frames skipped against the target rate
+    uint32_t utilisation_pct;  // This display's share of its bus budget used last second
+    uint32_t interval_us;      // Current frame interval (target or degraded)
+};
+
+// Clock: call once per loop; returns the fixed steps that ran
+uint32_t anim_update();
+uint64_t anim_time_us();
+
+// Tweens: move *target to `to` over duration_ms. Retargeting a value that is
+// already animating continues from where it is; the same target is a no-op.
+void anim_tween_to(volatile int32_t* target, int32_t to, uint32_t duration_ms, AnimEase ease);
+void anim_tween_cancel(volatile int32_t* target);
+bool anim_tween_active(const volatile int32_t* target);
+
+// Frame governor: buses have a byte budget shared by their displays. A
+// display's frame is due at its target rate, or later if its last frames
+// would overrun its share of the bus.
+int anim_add_bus(uint32_t bytes_per_sec);
+int anim_add_display(int bus, uint32_t target_fps);
+bool anim_frame_due(int display);
+void anim_frame_done(int display, uint32_t bytes);
+
+// Statistics
+const AnimDisplayStats* anim_get_display_stats(int display);
+void anim_print_stats();
+
+#endif // ANIM_H
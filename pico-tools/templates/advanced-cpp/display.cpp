@@ -3,110 +3,325 @@
 #include <string.h>
 #include "hardware/i2c.h"
 #include "hardware/gpio.h"
+#include "i2c_arb.h"
+#include "i2c_dma.h"
+#include "i2c_health.h"
+#include "i2c_scan.h"
+#include "oled.h"
+#include "text.h"
+#include "widget.h"
 
-// Display configuration (example for SSD1306 OLED)
-#define DISPLAY_I2C i2c1
-#define DISPLAY_ADDR 0x3C
+// The panel on the display bus: i2c1 at 0x3C (use OLED_SH1106 for 1.3" SH1106 modules)
+using DisplayPanel = OledPanel<1, 0x3C, FB_WIDTH, FB_HEIGHT, OLED_SSD1306>;
 #define DISPLAY_SDA 6
 #define DISPLAY_SCL 7
 
+// Flush through DMA (non-blocking); set to 0 for plain blocking writes
+#ifndef DISPLAY_USE_DMA
+#define DISPLAY_USE_DMA 1
+#endif
+
+// Worst case stream: every page dirty across its full width
+#define DISPLAY_TX_WORDS (FB_PAGES * DISPLAY_WINDOW_MAX_WORDS)
+
 static bool display_available = false;
+static int display_device = -1;  // Health registry entry
+
+// Text cursor for display_print(): x in pixels, y in text rows (pages)
+static uint8_t display_cursor_x = 0;
+static uint8_t display_cursor_y = 0;
+
+// Back buffer: local copy of panel RAM that the application draws into;
+// only changed column windows are sent on flush
+static Framebuffer display_fb;
+
+#if DISPLAY_USE_DMA
+// Front buffer: snapshot of the dirty windows as IC_DATA_CMD words, owned
+// by DMA until the flush completes, so drawing the next frame never waits
+static uint16_t display_tx_stream[DISPLAY_TX_WORDS];
+static I2cTransaction display_txn;
+static display_flush_callback_t display_flush_callback = nullptr;
+static volatile uint32_t display_flush_start_us = 0;
+static volatile uint32_t display_last_flush_us = 0;
+static volatile bool display_resync_pending = false;
+#endif
+
+// Hardware scrolling state: the start line goes out ahead of the next
+// flush; marquee pages are rotated by the panel itself while it runs
+static uint8_t display_start_line = 0;
+static bool display_start_line_pending = false;
+static bool display_marquee_active = false;
+static uint8_t display_marquee_first_page = 0;
+static uint8_t display_marquee_last_page = 0;
+
+// Window and init streams for DMA; display_mux and display_bus panels
+// share this panel's controller and geometry
+size_t display_encode_window(const FramebufferWindow* window, uint16_t* out) {
+    return DisplayPanel::encode_window(window, out);
+}
+
+#if DISPLAY_USE_DMA
+static void display_flush_complete(I2cTransaction* txn, int result, void* context) {
+    (void)txn;
+    (void)context;
+    bool success = result == PICO_OK;
+    display_last_flush_us = time_us_32() - display_flush_start_us;
+    i2c_health_report(display_device, result);
+
+    // A failed transfer leaves panel RAM unknown, so resend everything next
+    // time (applied on the next flush, not here in IRQ context)
+    if (!success) {
+        display_resync_pending = true;
+    }
+
+    if (display_flush_callback) {
+        display_flush_callback(success);
+    }
+}
+#endif
+
+// Blocking transfers to the panel; a mux on the same bus has every channel
+// closed first so the panels behind it do not see them
+static int display_panel_setup() {
+    if (!i2c_arb_lock(DisplayPanel::i2c(), DisplayPanel::address, I2C_ARB_DIRECT)) return PICO_ERROR_GENERIC;
+
+    int result = DisplayPanel::init();
+    i2c_arb_unlock(DisplayPanel::i2c());
+    return result;
+}
+
+// Runs from i2c_health_service(): a panel that comes back has lost its RAM
+// and configuration (it was most likely unplugged), so set it up again
+static void display_health_changed(int device, bool online, void* context) {
+    (void)device;
+    (void)context;
+    display_available = online;
+    if (!online) {
+        printf("Display at 0x%02X went offline\n", DisplayPanel::address);
+        return;
+    }
+    
+    printf("Display at 0x%02X back online, re-initialising\n", DisplayPanel::address);
+    i2c_health_report(display_device, display_panel_setup());
+    display_marquee_active = false;
+    display_start_line_pending = display_start_line != 0;
+    fb_mark_all_dirty(&display_fb);
+    display_flush_async();
+}
 
 void display_init() {
     // Initialize I2C for display
-    i2c_init(DISPLAY_I2C, 400000); // 400kHz
+    i2c_init(DisplayPanel::i2c(), 400000); // 400kHz
     gpio_set_function(DISPLAY_SDA, GPIO_FUNC_I2C);
     gpio_set_function(DISPLAY_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(DISPLAY_SDA);
     gpio_pull_up(DISPLAY_SCL);
     
-    // Test if display is connected
-    uint8_t test_data = 0x00;
-    int result = i2c_write_blocking(DISPLAY_I2C, DISPLAY_ADDR, &test_data, 1, false);
-    
-    if (result >= 0) {
+    fb_init(&display_fb);
+#if DISPLAY_USE_DMA
+    i2c_arb_add_bus(DisplayPanel::i2c());
+    display_txn.i2c = DisplayPanel::i2c();
+    display_txn.addr = DisplayPanel::address;
+    display_txn.channel = I2C_ARB_DIRECT;
+    display_txn.priority = I2C_PRIO_DISPLAY;
+    display_txn.words = display_tx_stream;
+    display_txn.callback = display_flush_complete;
+#endif
+
+    i2c_health_add_bus(DisplayPanel::i2c(), DISPLAY_SDA, DISPLAY_SCL, 400000);
+    display_device = i2c_health_add_device(DisplayPanel::i2c(), DisplayPanel::address, "display",
+                                           I2C_PROBE_WRITE, display_health_changed, nullptr);
+    i2c_scan_add_bus(DisplayPanel::i2c());
+
+    // Test if display is connected; if not, the health service keeps
+    // probing and sets it up when it appears
+    if (i2c_health_probe(display_device)) {
         display_available = true;
-        printf("Display connected at 0x%02X\n", DISPLAY_ADDR);
-        
-        // Initialize display (basic commands for SSD1306)
-        uint8_t init_commands[] = {
-            0x00, 0xAE, // Display off
-            0x00, 0xD5, 0x00, 0x80, // Set display clock divide
-            0x00, 0xA8, 0x00, 0x3F, // Set multiplex ratio
-            0x00, 0xD3, 0x00, 0x00, // Set display offset
-            0x00, 0x40, // Set start line
-            0x00, 0x8D, 0x00, 0x14, // Charge pump
-            0x00, 0x20, 0x00, 0x00, // Memory mode
-            0x00, 0xA1, // Set segment re-map
-            0x00, 0xC8, // Set COM output scan direction
-            0x00, 0xDA, 0x00, 0x12, // Set COM pins
-            0x00, 0x81, 0x00, 0xCF, // Set contrast
-            0x00, 0xD9, 0x00, 0xF1, // Set pre-charge
-            0x00, 0xDB, 0x00, 0x40, // Set VCOM detect
-            0x00, 0xA4, // Entire display on
-            0x00, 0xA6, // Set normal display
-            0x00, 0xAF  // Display on
-        };
+        printf("Display connected at 0x%02X\n", DisplayPanel::address);
         
-        for (size_t i = 0; i < sizeof(init_commands); i += 2) {
-            i2c_write_blocking(DISPLAY_I2C, DISPLAY_ADDR, &init_commands[i], 2, false);
-            sleep_ms(1);
-        }
+        i2c_health_report(display_device, display_panel_setup());
         
         display_clear();
     } else {
-        printf("No display found at 0x%02X\n", DISPLAY_ADDR);
+        printf("No display found at 0x%02X (will keep probing)\n", DisplayPanel::address);
     }
 }
 
+bool display_panel_init() {
+    // The caller holds the bus (i2c_arb_lock) with the panel's channel selected
+    return DisplayPanel::init() >= 0;
+}
+
+size_t display_encode_init(uint16_t* out) {
+    return DisplayPanel::encode_init(out);
+}
+
 void display_update_demo(float temperature, uint16_t light_level) {
     if (!display_available) {
         printf("Display Demo: Temp=%.1f°C, Light=%d\n", temperature, light_level);
         return;
     }
     
-    // This is a simplified demo - real implementation would need
-    // proper font rendering and display buffer management
-    
-    printf("Updating display: Temp=%.1f°C, Light=%d\n", temperature, light_level);
+    // Built on first use; after that a render only redraws widgets whose value moved
+    static WidgetTree widgets;
+    static int temp_id = -1;
+    static int light_id = -1;
+    static int bar_id = -1;
+    if (temp_id < 0) {
+        widget_tree_init(&widgets, &display_fb);
+        temp_id = widget_add_number(&widgets, 0, 0, FB_WIDTH, "Temp: ", 1, "°C");
+        light_id = widget_add_number(&widgets, 0, 2 * TEXT_LINE_HEIGHT, FB_WIDTH, "Light: ", 0, "");
+        bar_id = widget_add_bar(&widgets, 0, FB_HEIGHT - 12, FB_WIDTH, 12, 4095);
+    }
     
-    // Example of sending display data
-    static uint32_t frame_count = 0;
-    frame_count++;
+    int32_t temp_tenths = (int32_t)(temperature * 10.0f + (temperature < 0 ? -0.5f : 0.5f));
+    widget_set_value(&widgets, temp_id, temp_tenths);
+    widget_set_value(&widgets, light_id, light_level);
+    widget_set_value(&widgets, bar_id, light_level);
     
-    // Send some pattern data (placeholder)
-    uint8_t display_data[129];
-    display_data[0] = 0x40; // Data mode
+    uint32_t render_start = time_us_32();
+    widget_tree_render(&widgets);
+    uint32_t render_us = time_us_32() - render_start;
+    const WidgetStats* widget_stats = widget_tree_get_stats(&widgets);
     
-    for (int i = 1; i < 129; i++) {
-        // Create a simple pattern that changes over time
-        display_data[i] = (uint8_t)((i + frame_count) & 0xFF);
-    }
+    // Hand the changed windows to DMA and return; if the previous frame is
+    // still on the bus, this frame's changes stay dirty for the next call
+    display_flush_async();
     
-    i2c_write_blocking(DISPLAY_I2C, DISPLAY_ADDR, display_data, 129, false);
+    const FramebufferStats* stats = display_get_stats();
+    printf("Updating display: Temp=%.1f°C, Light=%d (%u widgets redrawn in %uus, %u pages dirty, "
+           "%u bytes in %u windows, full-page path: %u bytes)\n",
+           temperature, light_level, widget_stats->last_redrawn, render_us, widget_stats->last_dirty_pages,
+           stats->last_frame_bytes, stats->last_frame_windows, FB_FULL_FRAME_BYTES);
 }
 
 void display_clear() {
     if (!display_available) return;
     
-    // Clear display buffer
-    uint8_t clear_data[129];
-    clear_data[0] = 0x40; // Data mode
-    memset(&clear_data[1], 0x00, 128);
+    fb_clear(&display_fb);
+    display_flush();
+}
+
+void display_flush() {
+    if (!display_available) return;
+    
+#if DISPLAY_USE_DMA
+    i2c_arb_wait(&display_txn);
+    display_flush_async();
+    i2c_arb_wait(&display_txn);
+#else
+    uint32_t bytes = 0;
+    uint32_t windows = 0;
+    FramebufferWindow window;
     
-    // Send clear data to all pages
-    for (int page = 0; page < 8; page++) {
-        // Set page address
-        uint8_t page_cmd[] = {0x00, (uint8_t)(0xB0 + page)};
-        i2c_write_blocking(DISPLAY_I2C, DISPLAY_ADDR, page_cmd, 2, false);
-        
-        // Set column address
-        uint8_t col_cmd[] = {0x00, 0x00, 0x00, 0x10};
-        i2c_write_blocking(DISPLAY_I2C, DISPLAY_ADDR, col_cmd, 4, false);
-        
-        // Send clear data
-        i2c_write_blocking(DISPLAY_I2C, DISPLAY_ADDR, clear_data, 129, false);
+    if (!i2c_arb_lock(DisplayPanel::i2c(), DisplayPanel::address, I2C_ARB_DIRECT)) {
+        i2c_health_report(display_device, PICO_ERROR_GENERIC);
+        return;
+    }
+    
+    if (display_start_line_pending) {
+        display_start_line_pending = false;
+        uint8_t start_cmd[] = {0x00, (uint8_t)(0x40 | display_start_line)};
+        i2c_health_report(display_device, DisplayPanel::write(start_cmd, sizeof(start_cmd)));
+        bytes += sizeof(start_cmd);
+        windows++;
+    }
+    
+    while (fb_next_window(&display_fb, &window)) {
+        int sent = DisplayPanel::send_window(&window);
+        i2c_health_report(display_device, sent);
+        if (sent < 0) {
+            // Panel RAM is unknown from here on; stop and resend it all next time
+            fb_mark_all_dirty(&display_fb);
+            break;
+        }
+        bytes += (uint32_t)sent;
+        windows++;
+    }
+    
+    i2c_arb_unlock(DisplayPanel::i2c());
+    fb_record_flush(&display_fb, bytes, windows);
+#endif
+}
+
+bool display_flush_async() {
+    if (!display_available) return false;
+    
+#if DISPLAY_USE_DMA
+    if (i2c_arb_pending(&display_txn)) return false;
+    
+    if (display_resync_pending) {
+        display_resync_pending = false;
+        fb_mark_all_dirty(&display_fb);
+    }
+    
+    // Snapshot the dirty windows into the front buffer, behind a pending
+    // start line change so scrolled content and its new rows land together
+    size_t words = 0;
+    uint32_t windows = 0;
+    FramebufferWindow window;
+    
+    if (display_start_line_pending) {
+        display_start_line_pending = false;
+        display_tx_stream[words++] = 0x00;
+        display_tx_stream[words++] = (uint16_t)(0x40 | display_start_line) | I2C_DMA_STOP;
+        windows++;
+    }
+    
+    while (fb_next_window(&display_fb, &window)) {
+        words += display_encode_window(&window, &display_tx_stream[words]);
+        windows++;
+    }
+    
+    if (windows == 0) return true;
+    
+    fb_record_flush(&display_fb, (uint32_t)words, windows);
+    display_flush_start_us = time_us_32();
+    
+    // Queued behind sensor traffic and sent in chunks that sensor reads can
+    // cut in between
+    display_txn.count = words;
+    if (!i2c_arb_submit(&display_txn)) {
+        fb_mark_all_dirty(&display_fb);
+        return false;
     }
+    return true;
+#else
+    display_flush();
+    return true;
+#endif
+}
+
+bool display_flush_in_progress() {
+#if DISPLAY_USE_DMA
+    return display_available && i2c_arb_pending(&display_txn);
+#else
+    return false;
+#endif
+}
+
+void display_set_flush_callback(display_flush_callback_t callback) {
+#if DISPLAY_USE_DMA
+    display_flush_callback = callback;
+#else
+    (void)callback;
+#endif
+}
+
+uint32_t display_get_last_flush_us() {
+#if DISPLAY_USE_DMA
+    return display_last_flush_us;
+#else
+    return 0;
+#endif
+}
+
+const FramebufferStats* display_get_stats() {
+    return &display_fb.stats;
+}
+
+Framebuffer* display_get_framebuffer() {
+    return &display_fb;
 }
 
 void display_print(const char* text) {
@@ -115,20 +330,91 @@ void display_print(const char* text) {
         return;
     }
     
-    // Placeholder for text rendering
-    // Real implementation would convert text to bitmap and send to display
-    printf("Display Print: %s\n", text);
+    // Draw at the cursor; '\n' moves to the start of the next text row
+    while (true) {
+        int end = text_draw(&display_fb, display_cursor_x, display_cursor_y * TEXT_LINE_HEIGHT, text);
+        display_cursor_x = (uint8_t)(end < FB_WIDTH ? end : FB_WIDTH);
+        
+        text = strchr(text, '\n');
+        if (!text) break;
+        text++;
+        display_cursor_x = 0;
+        display_cursor_y = (uint8_t)((display_cursor_y + 1) % FB_PAGES);
+    }
+    
+    display_flush_async();
 }
 
 void display_set_cursor(uint8_t x, uint8_t y) {
-    if (!display_available) return;
+    // x in pixels, y in text rows; drawing happens in the framebuffer, so
+    // no panel commands are needed here
+    display_cursor_x = x < FB_WIDTH ? x : FB_WIDTH - 1;
+    display_cursor_y = y < FB_PAGES ? y : FB_PAGES - 1;
+}
+
+// Sends a short command sequence as one transaction, after any flush in flight
+static void display_send_commands(const uint8_t* commands, size_t length) {
+    uint8_t data[16];
+    data[0] = 0x00; // Command stream
+    memcpy(&data[1], commands, length);
+    
+#if DISPLAY_USE_DMA
+    i2c_arb_wait(&display_txn);
+#endif
+    int result = PICO_ERROR_GENERIC;
+    if (i2c_arb_lock(DisplayPanel::i2c(), DisplayPanel::address, I2C_ARB_DIRECT)) {
+        result = DisplayPanel::write(data, length + 1);
+        i2c_arb_unlock(DisplayPanel::i2c());
+    }
+    i2c_health_report(display_device, result);
+}
+
+void display_set_start_line(uint8_t line) {
+    line &= FB_HEIGHT - 1;
+    if (line == display_start_line) return;
+    
+    display_start_line = line;
+    display_start_line_pending = true;
+}
+
+uint8_t display_get_start_line() {
+    return display_start_line;
+}
+
+void display_marquee_start(uint8_t first_page, uint8_t last_page, bool left, uint8_t interval) {
+    if (!DisplayPanel::has_scroll) return;
+    if (!display_available || first_page > last_page || last_page >= FB_PAGES) return;
+    
+    display_marquee_stop();
     
-    // Set cursor position on display
-    uint8_t cursor_cmd[] = {
-        0x00, (uint8_t)(0xB0 + y), // Set page
-        0x00, (uint8_t)(x & 0x0F), // Set lower column
-        0x00, (uint8_t)(0x10 + (x >> 4)) // Set upper column
+    // Continuous horizontal scroll: dummy, start page, interval, end page, dummy, dummy
+    uint8_t commands[] = {
+        (uint8_t)(left ? 0x27 : 0x26), 0x00, first_page, (uint8_t)(interval & 0x07), last_page, 0x00, 0xFF,
+        0x2F // Activate scroll
     };
     
-    i2c_write_blocking(DISPLAY_I2C, DISPLAY_ADDR, cursor_cmd, 6, false);
-}
\ No newline at end of file
+    // Everything presented so far must be on the panel before it starts rotating
+    display_flush();
+    display_send_commands(commands, sizeof(commands));
+    
+    display_marquee_active = true;
+    display_marquee_first_page = first_page;
+    display_marquee_last_page = last_page;
+}
+
+void display_marquee_stop() {
+    if (!display_marquee_active) return;
+    
+    uint8_t commands[] = {0x2E}; // Deactivate scroll
+    display_send_commands(commands, sizeof(commands));
+    display_marquee_active = false;
+    
+    // The panel has rotated its RAM, so those pages no longer match the framebuffer
+    for (uint8_t page = display_marquee_first_page; page <= display_marquee_last_page; page++) {
+        fb_mark_dirty(&display_fb, page, 0, FB_WIDTH - 1);
+    }
+}
+
+bool display_marquee_running() {
+    return display_marquee_active;
+}
@@ -2,12 +2,44 @@
 #define DISPLAY_H
 
 #include "pico/stdlib.h"
+#include "framebuffer.h"
 
 // Display interface
 void display_init();
 void display_update_demo(float temperature, uint16_t light_level);
 void display_clear();
-void display_print(const char* text);
-void display_set_cursor(uint8_t x, uint8_t y);
+void display_print(const char* text);           // Draws at the cursor and flushes
+void display_set_cursor(uint8_t x, uint8_t y);  // x in pixels, y in text rows
+
+// Framebuffer access: draw into the framebuffer, then flush the changed windows
+Framebuffer* display_get_framebuffer();
+void display_flush();
+const FramebufferStats* display_get_stats();
+
+// Non-blocking flush: returns immediately while DMA drains the frame.
+// Returns false if the previous flush is still in progress (changes stay
+// dirty and go out with the next call). The callback runs in IRQ context.
+typedef void (*display_flush_callback_t)(bool success);
+bool display_flush_async();
+bool display_flush_in_progress();
+void display_set_flush_callback(display_flush_callback_t callback);
+uint32_t display_get_last_flush_us();
+
+// Hardware scrolling. The start line (0-63) picks the RAM row shown at the
+// top of the screen and goes out with the next flush. A marquee rotates a
+// page range on the panel itself (interval: SSD1306 frame code 0-7); leave
+// those pages undrawn while it runs, stopping it resends them.
+void display_set_start_line(uint8_t line);
+uint8_t display_get_start_line();
+void display_marquee_start(uint8_t first_page, uint8_t last_page, bool left, uint8_t interval);
+void display_marquee_stop();
+bool display_marquee_running();
+
+// Panel-level helpers, shared with display_mux for panels behind the TCA9548A
+#define DISPLAY_WINDOW_MAX_WORDS (FB_WINDOW_OVERHEAD_BYTES + FB_WIDTH)
+#define DISPLAY_INIT_MAX_WORDS 32
+bool display_panel_init();
+size_t display_encode_init(uint16_t* out);
+size_t display_encode_window(const FramebufferWindow* window, uint16_t* out);
 
 #endif // DISPLAY_H
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "display_bus.h"
+#include "display.h"
+#include "i2c_arb.h"
+#include "pio_i2c.h"
+#include <stdio.h>
+#include "hardware/i2c.h"
+#include "hardware/gpio.h"
+
+enum DisplayBusType {
+    DISPLAY_BUS_I2C,  // Hardware I2C controller (instance = 0 or 1)
+    DISPLAY_BUS_PIO   // PIO I2C master (instance = PIO block)
+};
+
+struct DisplayBusConfig {
+    DisplayBusType type;
+    uint8_t instance;
+    uint8_t pin_sda;
+    uint8_t pin_scl;
+    uint32_t baudrate;
+};
+
+// Bus wiring; panels are striped across these in order
+static const DisplayBusConfig display_bus_configs[] = {
+    {DISPLAY_BUS_I2C, 1, 6, 7, 400000},    // i2c1 (the single-display pins)
+#if DISPLAY_BUS_USE_I2C0
+    {DISPLAY_BUS_I2C, 0, 4, 5, 400000},    // i2c0 (sensor pins)
+#endif
+    {DISPLAY_BUS_PIO, 0, 8, 9, 400000},    // pio0 state machine
+    {DISPLAY_BUS_PIO, 0, 10, 11, 400000},  // pio0 state machine
+};
+
+#define DISPLAY_BUS_COUNT (sizeof(display_bus_configs) / sizeof(display_bus_configs[0]))
+#define DISPLAY_BUS_TX_WORDS (FB_PAGES * DISPLAY_WINDOW_MAX_WORDS)
+
+struct DisplayPanel {
+    uint8_t bus;
+    uint8_t addr;
+    bool present;
+    volatile bool pending;   // Presented frame not sent yet
+    volatile bool resync;    // Last transfer failed; resend the whole frame
+    Framebuffer fb;
+};
+
+struct DisplayBus {
+    const DisplayBusConfig* config;
+    PioI2c pio_bus;
+    I2cTransaction txn;              // Hardware buses: queued behind sensor traffic
+    bool ready;
+    volatile bool last_ok;
+    int active_panel;                // Panel owning the transfer in flight
+    uint8_t next_panel;              // Round-robin start among this bus's panels
+    uint32_t transfer_start_us;
+    uint64_t busy_us_at_last_sample;
+    uint32_t bytes;
+    uint32_t bytes_at_last_sample;
+    DisplayBusStats stats;
+    uint16_t tx_stream[DISPLAY_BUS_TX_WORDS];
+};
+
+static DisplayBus display_buses[DISPLAY_BUS_COUNT];
+static DisplayPanel display_panels[DISPLAY_BUS_MAX_PANELS];
+static uint8_t display_panel_total = 0;
+static uint32_t display_bus_last_sample_us = 0;
+
+static i2c_inst_t* display_bus_i2c(const DisplayBus* bus) {
+    return i2c_get_instance(bus->config->instance);
+}
+
+static bool display_bus_busy(DisplayBus* bus) {
+    if (bus->config->type == DISPLAY_BUS_I2C) {
+        return i2c_arb_pending(&bus->txn);
+    }
+    return pio_i2c_busy(&bus->pio_bus);
+}
+
+static void display_bus_transfer_complete(bool success, void* context) {
+    DisplayBus* bus = (DisplayBus*)context;
+
+    bus->stats.busy_us += time_us_32() - bus->transfer_start_us;
+    bus->last_ok = success;
+
+    if (!success) {
+        bus->stats.errors++;
+        if (bus->active_panel >= 0) {
+            display_panels[bus->active_panel].resync = true;
+            display_panels[bus->active_panel].pending = true;
+        }
+    }
+    bus->active_panel = -1;
+}
+
+static void display_bus_txn_complete(I2cTransaction* txn, int result, void* context) {
+    (void)txn;
+    display_bus_transfer_complete(result == PICO_OK, context);
+}
+
+static bool display_bus_start(DisplayBus* bus, uint8_t addr, const uint16_t* words, size_t count) {
+    bus->transfer_start_us = time_us_32();
+    bus->stats.transfers++;
+    bus->bytes += (uint32_t)count;
+
+    if (bus->config->type == DISPLAY_BUS_I2C) {
+        bus->txn.addr = addr;
+        bus->txn.words = words;
+        bus->txn.count = count;
+        return i2c_arb_submit(&bus->txn);
+    }
+    return pio_i2c_write(&bus->pio_bus, addr, words, count,
+                         display_bus_transfer_complete, bus);
+}
+
+// Only used during init, before any panel traffic is in flight
+static bool display_bus_send_blocking(DisplayBus* bus, uint8_t addr, const uint16_t* words, size_t count) {
+    bus->active_panel = -1;
+    if (!display_bus_start(bus, addr, words, count)) return false;
+
+    while (display_bus_busy(bus)) {
+        tight_loop_contents();
+    }
+    return bus->last_ok;
+}
+
+static bool display_bus_setup(DisplayBus* bus) {
+    const DisplayBusConfig* config = bus->config;
+
+    if (config->type == DISPLAY_BUS_I2C) {
+        i2c_inst_t* i2c = i2c_get_instance(config->instance);
+        i2c_init(i2c, config->baudrate);
+        gpio_set_function(config->pin_sda, GPIO_FUNC_I2C);
+        gpio_set_function(config->pin_scl, GPIO_FUNC_I2C);
+        gpio_pull_up(config->pin_sda);
+        gpio_pull_up(config->pin_scl);
+        i2c_arb_add_bus(i2c);
+        bus->txn.i2c = i2c;
+        bus->txn.channel = I2C_ARB_DIRECT;
+        bus->txn.priority = I2C_PRIO_DISPLAY;
+        bus->txn.callback = display_bus_txn_complete;
+        bus->txn.context = bus;
+        return true;
+    }
+
+    PIO pio = pio_get_instance(config->instance);
+    return pio_i2c_init(&bus->pio_bus, pio, config->pin_sda, config->pin_scl, config->baudrate);
+}
+
+bool display_bus_init() {
+    for (uint8_t b = 0; b < DISPLAY_BUS_COUNT; b++) {
+        DisplayBus* bus = &display_buses[b];
+        bus->config = &display_bus_configs[b];
+        bus->active_panel = -1;
+        bus->ready = display_bus_setup(bus);
+
+        if (!bus->ready) {
+            printf("Display bus %u: setup failed (pins %u/%u)\n",
+                   b, bus->config->pin_sda, bus->config->pin_scl);
+        }
+    }
+
+    // Stripe panels across buses so consecutive panels land on different buses
+    uint16_t init_stream[DISPLAY_INIT_MAX_WORDS];
+    size_t init_words = display_encode_init(init_stream);
+    uint16_t probe = 0x00 | I2C_DMA_STOP;
+
+    for (uint8_t p = 0; p < DISPLAY_BUS_MAX_PANELS; p++) {
+        DisplayPanel* panel = &display_panels[p];
+        DisplayBus* bus = &display_buses[p % DISPLAY_BUS_COUNT];
+
+        panel->bus = p % DISPLAY_BUS_COUNT;
+        panel->addr = 0x3C + p / DISPLAY_BUS_COUNT;
+        fb_init(&panel->fb);
+
+        if (!bus->ready || !display_bus_send_blocking(bus, panel->addr, &probe, 1)) {
+            continue;
+        }
+
+        display_bus_send_blocking(bus, panel->addr, init_stream, init_words);
+        panel->present = true;
+        panel->pending = true; // First flush clears the panel
+        display_panel_total++;
+
+        printf("Display panel %u: bus %u at 0x%02X\n", p, panel->bus, panel->addr);
+    }
+
+    printf("Display buses: %u panels on %u buses\n",
+           display_panel_total, (unsigned)DISPLAY_BUS_COUNT);
+
+    display_bus_last_sample_us = time_us_32();
+    return display_panel_total > 0;
+}
+
+uint8_t display_bus_count() {
+    return DISPLAY_BUS_COUNT;
+}
+
+uint8_t display_bus_panel_count() {
+    return display_panel_total;
+}
+
+Framebuffer* display_bus_get_framebuffer(uint8_t panel) {
+    if (panel >= DISPLAY_BUS_MAX_PANELS) return nullptr;
+    return &display_panels[panel].fb;
+}
+
+void display_bus_present(uint8_t panel) {
+    if (panel >= DISPLAY_BUS_MAX_PANELS || !display_panels[panel].present) return;
+
+    if (fb_is_dirty(&display_panels[panel].fb)) {
+        display_panels[panel].pending = true;
+    }
+}
+
+// Next waiting panel on this bus, round-robin so two panels sharing a bus alternate
+static int display_bus_pick_panel(DisplayBus* bus, uint8_t bus_index) {
+    for (uint8_t i = 0; i < DISPLAY_BUS_MAX_PANELS; i++) {
+        uint8_t p = (bus->next_panel + i) % DISPLAY_BUS_MAX_PANELS;
+        if (display_panels[p].bus == bus_index && display_panels[p].pending) {
+            bus->next_panel = (p + 1) % DISPLAY_BUS_MAX_PANELS;
+            return p;
+        }
+    }
+    return -1;
+}
+
+static void display_bus_sample_stats() {
+    uint32_t now = time_us_32();
+    uint32_t elapsed = now - display_bus_last_sample_us;
+    if (elapsed < 1000000) return;
+
+    for (uint8_t b = 0; b < DISPLAY_BUS_COUNT; b++) {
+        DisplayBus* bus = &display_buses[b];
+        uint64_t busy = bus->stats.busy_us - bus->busy_us_at_last_sample;
+
+        bus->stats.utilisation_pct = (uint32_t)(busy * 100 / elapsed);
+        bus->stats.bytes_per_sec = (uint32_t)((uint64_t)(bus->bytes - bus->bytes_at_last_sample) * 1000000 / elapsed);
+        bus->busy_us_at_last_sample = bus->stats.busy_us;
+        bus->bytes_at_last_sample = bus->bytes;
+    }
+    display_bus_last_sample_us = now;
+}
+
+void display_bus_service() {
+    display_bus_sample_stats();
+
+    // Every idle bus gets its next transfer, so the buses run side by side
+    for (uint8_t b = 0; b < DISPLAY_BUS_COUNT; b++) {
+        DisplayBus* bus = &display_buses[b];
+        if (!bus->ready || display_bus_busy(bus)) continue;
+
+        int p = display_bus_pick_panel(bus, b);
+        if (p < 0) continue;
+
+        DisplayPanel* panel = &display_panels[p];
+        if (panel->resync) {
+            panel->resync = false;
+            fb_mark_all_dirty(&panel->fb);
+        }
+        panel->pending = false;
+
+        size_t words = 0;
+        uint32_t windows = 0;
+        FramebufferWindow window;
+        while (fb_next_window(&panel->fb, &window)) {
+            words += display_encode_window(&window, &bus->tx_stream[words]);
+            windows++;
+        }
+        if (windows == 0) continue;
+
+        fb_record_flush(&panel->fb, (uint32_t)words, windows);
+        bus->active_panel = p;
+        if (!display_bus_start(bus, panel->addr, bus->tx_stream, words)) {
+            bus->active_panel = -1;
+            panel->resync = true;
+            panel->pending = true;
+        }
+    }
+}
+
+const DisplayBusStats* display_bus_get_stats(uint8_t bus) {
+    if (bus >= DISPLAY_BUS_COUNT) return nullptr;
+    return &display_buses[bus].stats;
+}
+
+void display_bus_print_stats() {
+    for (uint8_t b = 0; b < DISPLAY_BUS_COUNT; b++) {
+        const DisplayBus* bus = &display_buses[b];
+        if (!bus->ready) continue;
+
+        printf("Display bus %u (%s%u): %u%% busy, %u B/s, %u transfers, %u errors\n",
+               b, bus->config->type == DISPLAY_BUS_I2C ? "i2c" : "pio", bus->config->instance,
+               bus->stats.utilisation_pct, bus->stats.bytes_per_sec,
+               bus->stats.transfers, bus->stats.errors);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef DISPLAY_BUS_H
+#define DISPLAY_BUS_H
+
+#include "pico/stdlib.h"
+#include "framebuffer.h"
+
+// Panels striped across several I2C buses that all flush at the same time.
+// Panel n goes to bus n % bus_count, at 0x3C for the first panel on a bus
+// and 0x3D for the second.
+#define DISPLAY_BUS_MAX_PANELS 5
+
+// i2c0 carries the sensors (sensor.cpp); set to 1 once they move elsewhere
+#ifndef DISPLAY_BUS_USE_I2C0
+#define DISPLAY_BUS_USE_I2C0 0
+#endif
+
+// Per-bus counters, sampled once per second by display_bus_service()
+struct DisplayBusStats {
+    uint32_t utilisation_pct;  // Share of the last second spent transmitting
+    uint32_t bytes_per_sec;    // Stream bytes sent during the last second
+    uint32_t transfers;        // DMA transfers started
+    uint32_t errors;           // Transfers that ended in a NACK
+    uint64_t busy_us;          // Total time spent transmitting
+};
+
+// Setup: brings up every configured bus and probes its panels
+bool display_bus_init();
+uint8_t display_bus_count();
+uint8_t display_bus_panel_count();
+
+// Drawing: draw into a panel's framebuffer, then present it to queue a flush
+Framebuffer* display_bus_get_framebuffer(uint8_t panel);
+void display_bus_present(uint8_t panel);
+
+// Starts a transfer on every idle bus with waiting panels; never blocks
+void display_bus_service();
+
+// Statistics
+const DisplayBusStats* display_bus_get_stats(uint8_t bus);
+void display_bus_print_stats();
+
+#endif // DISPLAY_BUS_H
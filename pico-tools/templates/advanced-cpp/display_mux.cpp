@@ -0,0 +1,288 @@
+#include "display_mux.h"
+#include "display.h"
+#include "i2c_arb.h"
+#include "i2c_health.h"
+#include "i2c_scan.h"
+#include <stdio.h>
+#include "hardware/i2c.h"
+
+// TCA9548A on the display bus (same controller as display.cpp)
+#define DISPLAY_MUX_I2C i2c1
+#define DISPLAY_MUX_ADDR 0x70
+#define DISPLAY_MUX_PANEL_ADDR 0x3C
+#define DISPLAY_MUX_NONE 0xFF
+
+// Slices a fully dirty frame takes (only whole windows go in a slice)
+#define MUX_WINDOWS_PER_SLICE (DISPLAY_MUX_SLICE_WORDS / DISPLAY_WINDOW_MAX_WORDS)
+#define MUX_FRAME_SLICES ((FB_PAGES + MUX_WINDOWS_PER_SLICE - 1) / MUX_WINDOWS_PER_SLICE)
+
+static_assert(DISPLAY_MUX_CHANNELS <= 8, "TCA9548A has 8 channels");
+static_assert(DISPLAY_MUX_SLICE_WORDS >= DISPLAY_WINDOW_MAX_WORDS,
+              "A slice must hold at least one full-width window");
+
+struct MuxChannel {
+    bool present;             // Panel answered during init
+    volatile bool pending;    // Presented frame not fully sent yet
+    volatile bool resync;     // Last slice failed; resend the whole frame
+    volatile bool reinit;     // ... and the panel may have been power cycled
+    volatile bool last_slice; // The slice in flight finishes a frame
+    volatile uint8_t failures;      // Consecutive failed slices
+    volatile uint32_t retry_ms;     // Skipped by the scheduler until then
+    Framebuffer fb;
+    DisplayMuxChannelStats stats;
+    uint32_t frames_at_last_sample;
+};
+
+static MuxChannel mux_channels[DISPLAY_MUX_CHANNELS];
+static bool mux_available = false;
+static int mux_device = -1;  // Health registry entry for the TCA9548A
+// Scheduler state only: which channel the mux actually has selected is the
+// arbiter's business (locks and scans switch it too), see i2c_arb_get_stats()
+static uint8_t mux_last_served = DISPLAY_MUX_NONE;  // Channel of the last slice queued
+static uint8_t mux_frame_slices = 0;  // Slices of its unfinished frame queued in a row (0: none open)
+static uint32_t mux_last_fps_sample_ms = 0;
+
+// One slice at a time is queued, so a single stream buffer is enough; a
+// panel that needs setting up again gets its init stream in front
+static uint16_t mux_tx_stream[DISPLAY_INIT_MAX_WORDS + DISPLAY_MUX_SLICE_WORDS];
+static I2cTransaction mux_txn;
+
+static void display_mux_slice_complete(I2cTransaction* txn, int result, void* context) {
+    (void)txn;
+    MuxChannel* channel = (MuxChannel*)context;
+
+    if (result == PICO_OK) {
+        channel->failures = 0;
+        if (channel->last_slice) channel->stats.frames++;
+        return;
+    }
+
+    // Panel RAM and the mux state are unknown after a NACK. A panel that
+    // keeps failing is probably unplugged: back off like the health
+    // registry does, and re-initialise it once it answers again.
+    channel->resync = true;
+    if (channel->failures > 0) channel->reinit = true;
+    channel->pending = true;
+
+    uint8_t shift = channel->failures < 4 ? channel->failures : 4;
+    uint32_t backoff = (uint32_t)I2C_HEALTH_PROBE_MIN_MS << shift;
+    if (backoff > I2C_HEALTH_PROBE_MAX_MS) backoff = I2C_HEALTH_PROBE_MAX_MS;
+    channel->retry_ms = to_ms_since_boot(get_absolute_time()) + (channel->failures ? backoff : 0);
+    if (channel->failures < 255) channel->failures++;
+}
+
+static bool display_mux_ready(const MuxChannel* c, uint32_t now) {
+    if (!c->pending) return false;
+    return c->failures == 0 || (int32_t)(now - c->retry_ms) >= 0;
+}
+
+// A channel part way through a frame keeps the bus until the frame is out,
+// up to the slices a full frame takes (so presenting again mid-frame cannot
+// hold it forever). Then pending channels are visited in round-robin order
+// starting after it; the current channel is only kept when nobody else is
+// waiting, so a full cycle costs one switch per waiting panel and none of
+// them starve.
+static int display_mux_pick_channel(uint32_t now) {
+    if (mux_last_served != DISPLAY_MUX_NONE && mux_frame_slices > 0 && mux_frame_slices < MUX_FRAME_SLICES &&
+        display_mux_ready(&mux_channels[mux_last_served], now)) {
+        return mux_last_served;
+    }
+
+    int start = (mux_last_served == DISPLAY_MUX_NONE) ? 0 : mux_last_served + 1;
+    for (int i = 0; i < DISPLAY_MUX_CHANNELS; i++) {
+        int channel = (start + i) % DISPLAY_MUX_CHANNELS;
+        if (display_mux_ready(&mux_channels[channel], now)) return channel;
+    }
+    return -1;
+}
+
+// Probe every channel and set up the panels found; the whole frame of each
+// goes out on its first visit
+static int display_mux_scan() {
+    int panels = 0;
+    mux_last_served = DISPLAY_MUX_NONE;
+    mux_frame_slices = 0;
+    for (uint8_t ch = 0; ch < DISPLAY_MUX_CHANNELS; ch++) {
+        MuxChannel* channel = &mux_channels[ch];
+        channel->present = false;
+        channel->reinit = false;
+        channel->failures = 0;
+
+        // Blocking, with the arbiter holding everything else back
+        if (!i2c_arb_lock(DISPLAY_MUX_I2C, DISPLAY_MUX_PANEL_ADDR, ch)) continue;
+
+        uint8_t test_data = 0x00;
+        bool found = i2c_write_timeout_us(DISPLAY_MUX_I2C, DISPLAY_MUX_PANEL_ADDR, &test_data, 1, false,
+                                          I2C_HEALTH_TIMEOUT_US(1)) >= 0;
+        if (found) {
+            display_panel_init();
+        }
+        i2c_arb_unlock(DISPLAY_MUX_I2C);
+        if (!found) continue;
+
+        fb_mark_all_dirty(&channel->fb);
+        channel->present = true;
+        channel->pending = true; // First flush clears the panel
+        panels++;
+    }
+    return panels;
+}
+
+// Runs from i2c_health_service(); a mux that was power cycled comes back
+// with every channel off, so rescan behind it
+static void display_mux_health_changed(int device, bool online, void* context) {
+    (void)device;
+    (void)context;
+    if (!online) {
+        printf("TCA9548A at 0x%02X went offline\n", DISPLAY_MUX_ADDR);
+        return;
+    }
+
+    int panels = display_mux_scan();
+    printf("TCA9548A at 0x%02X back online: %d/%d display channels populated\n",
+           DISPLAY_MUX_ADDR, panels, DISPLAY_MUX_CHANNELS);
+}
+
+bool display_mux_init() {
+    // Reading the control register only succeeds if the mux is fitted
+    mux_device = i2c_health_add_device(DISPLAY_MUX_I2C, DISPLAY_MUX_ADDR, "mux", I2C_PROBE_READ,
+                                       display_mux_health_changed, nullptr);
+    if (!i2c_health_probe(mux_device)) {
+        printf("No TCA9548A found at 0x%02X\n", DISPLAY_MUX_ADDR);
+        return false;
+    }
+
+    // Every slice carries its channel; the arbiter switches the mux in front of it
+    i2c_arb_add_mux(DISPLAY_MUX_I2C, DISPLAY_MUX_ADDR, mux_device);
+    i2c_scan_add_mux(DISPLAY_MUX_I2C);
+    mux_txn.i2c = DISPLAY_MUX_I2C;
+    mux_txn.addr = DISPLAY_MUX_PANEL_ADDR;
+    mux_txn.priority = I2C_PRIO_DISPLAY;
+    mux_txn.words = mux_tx_stream;
+    mux_txn.callback = display_mux_slice_complete;
+
+    for (uint8_t ch = 0; ch < DISPLAY_MUX_CHANNELS; ch++) {
+        fb_init(&mux_channels[ch].fb);
+    }
+    int panels = display_mux_scan();
+
+    printf("TCA9548A at 0x%02X: %d/%d display channels populated\n",
+           DISPLAY_MUX_ADDR, panels, DISPLAY_MUX_CHANNELS);
+
+    mux_available = panels > 0;
+    mux_last_fps_sample_ms = to_ms_since_boot(get_absolute_time());
+    return mux_available;
+}
+
+bool display_mux_available() {
+    return mux_available;
+}
+
+Framebuffer* display_mux_get_framebuffer(uint8_t channel) {
+    if (channel >= DISPLAY_MUX_CHANNELS) return nullptr;
+    return &mux_channels[channel].fb;
+}
+
+void display_mux_present(uint8_t channel) {
+    if (channel >= DISPLAY_MUX_CHANNELS || !mux_channels[channel].present) return;
+
+    // Presenting again before the last frame went out just merges into the
+    // same dirty windows, so a slow channel never queues up extra switches
+    if (fb_is_dirty(&mux_channels[channel].fb)) {
+        mux_channels[channel].pending = true;
+    }
+}
+
+void display_mux_service() {
+    if (!mux_available) return;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if (now - mux_last_fps_sample_ms >= 1000) {
+        for (int ch = 0; ch < DISPLAY_MUX_CHANNELS; ch++) {
+            MuxChannel* channel = &mux_channels[ch];
+            channel->stats.fps = channel->stats.frames - channel->frames_at_last_sample;
+            channel->frames_at_last_sample = channel->stats.frames;
+        }
+        mux_last_fps_sample_ms = now;
+    }
+
+    // One slice queued at a time. While the mux itself is offline the
+    // health service owns the bus.
+    if (i2c_arb_pending(&mux_txn) || !i2c_health_online(mux_device)) return;
+
+    int ch = display_mux_pick_channel(now);
+    if (ch < 0) return;
+
+    MuxChannel* channel = &mux_channels[ch];
+    if (ch != mux_last_served) {
+        mux_last_served = (uint8_t)ch;
+        mux_frame_slices = 0;
+    }
+
+    // A panel that may have been power cycled is set up again in the same
+    // transaction, ahead of its frame
+    size_t words = 0;
+    if (channel->reinit) {
+        channel->reinit = false;
+        words = display_encode_init(mux_tx_stream);
+    }
+
+    if (channel->resync) {
+        channel->resync = false;
+        fb_mark_all_dirty(&channel->fb);
+    }
+
+    // Fill one slice with whole windows; the rest stays dirty for the next visit
+    size_t init_words = words;
+    uint32_t windows = 0;
+    FramebufferWindow window;
+
+    while (words - init_words + DISPLAY_WINDOW_MAX_WORDS <= DISPLAY_MUX_SLICE_WORDS &&
+           fb_next_window(&channel->fb, &window)) {
+        words += display_encode_window(&window, &mux_tx_stream[words]);
+        windows++;
+    }
+
+    // The frame is counted when its last slice has been acknowledged
+    bool finished = !fb_is_dirty(&channel->fb);
+    if (finished) {
+        channel->pending = false;
+        mux_frame_slices = 0;
+    }
+
+    if (words == 0) return;
+    channel->last_slice = finished;
+    if (!finished) mux_frame_slices++;
+
+    fb_record_flush(&channel->fb, (uint32_t)(words - init_words), windows);
+    channel->stats.slices++;
+    channel->stats.bytes += (uint32_t)words;
+
+    mux_txn.channel = (uint8_t)ch;
+    mux_txn.count = words;
+    mux_txn.context = channel;
+    i2c_arb_submit(&mux_txn);
+}
+
+const DisplayMuxChannelStats* display_mux_get_stats(uint8_t channel) {
+    if (channel >= DISPLAY_MUX_CHANNELS) return nullptr;
+    return &mux_channels[channel].stats;
+}
+
+void display_mux_print_stats() {
+    if (!mux_available) return;
+
+    // Selects are made (and counted) by the arbiter, so they include locks
+    // and scans that opened a panel's channel as well as its own slices
+    const I2cArbStats* arb = i2c_arb_get_stats(DISPLAY_MUX_I2C);
+    printf("Display mux: %u mux switches on i2c%u\n", arb ? arb->mux_switches : 0,
+           i2c_get_index(DISPLAY_MUX_I2C));
+    for (int ch = 0; ch < DISPLAY_MUX_CHANNELS; ch++) {
+        const MuxChannel* channel = &mux_channels[ch];
+        if (!channel->present) continue;
+
+        printf("  CH%d: %u fps, %u frames, %u slices, %u switches, %u bytes\n",
+               ch, channel->stats.fps, channel->stats.frames, channel->stats.slices,
+               arb ? arb->channel_selects[ch] : 0, channel->stats.bytes);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef DISPLAY_MUX_H
+#define DISPLAY_MUX_H
+
+#include "pico/stdlib.h"
+#include "framebuffer.h"
+
+// TCA9548A channels carrying SSD1306 panels (channel 0 .. DISPLAY_MUX_CHANNELS-1)
+#define DISPLAY_MUX_CHANNELS 5
+
+// Largest DMA transfer queued for one panel at a time; a fully dirty frame
+// is sent as two slices, back to back, before the scheduler moves on
+#define DISPLAY_MUX_SLICE_WORDS 544
+
+// Per-channel counters
+struct DisplayMuxChannelStats {
+    uint32_t frames;        // Frames whose last slice was acknowledged
+    uint32_t fps;           // Frames completed during the last second
+    uint32_t slices;        // DMA transfers sent to this channel
+    uint32_t bytes;         // Bytes sent to this channel (mux selects not included)
+};
+
+// Setup (call after display_init(), which brings up the bus)
+bool display_mux_init();
+bool display_mux_available();
+
+// Drawing: draw into a channel's framebuffer, then present it to queue a flush
+Framebuffer* display_mux_get_framebuffer(uint8_t channel);
+void display_mux_present(uint8_t channel);
+
+// Scheduler: call from the main loop; never blocks on panel data
+void display_mux_service();
+
+// Statistics
+const DisplayMuxChannelStats* display_mux_get_stats(uint8_t channel);
+void display_mux_print_stats();
+
+#endif // DISPLAY_MUX_H
@@ -0,0 +1,439 @@
+#include "dsp_filter.h"
+#include <stdio.h>
+#include <string.h>
+#include "hardware/clocks.h"
+#if DSP_USE_SIMD
+#include <arm_acle.h>
+#endif
+
+static bool dsp_use_simd = DSP_USE_SIMD;
+
+void dsp_set_simd_enabled(bool enabled) {
+    dsp_use_simd = enabled && DSP_USE_SIMD;
+}
+
+bool dsp_simd_enabled() {
+    return dsp_use_simd;
+}
+
+static int16_t dsp_saturate(int32_t value) {
+    if (value > INT16_MAX) return INT16_MAX;
+    if (value < INT16_MIN) return INT16_MIN;
+    return (int16_t)value;
+}
+
+// Rounds half away from zero, so positive and negative inputs behave alike
+static int16_t dsp_round_div(int32_t sum, uint32_t divisor) {
+    int64_t half = divisor / 2;
+    return (int16_t)((sum >= 0 ? sum + half : sum - half) / (int64_t)divisor);
+}
+
+// Median networks, written once for single samples and for two samples
+// packed in one register (SSUB16 sets a GE flag per lane, SEL picks by it)
+static inline int16_t dsp_min(int16_t a, int16_t b) { return a < b ? a : b; }
+static inline int16_t dsp_max(int16_t a, int16_t b) { return a < b ? b : a; }
+
+#if DSP_USE_SIMD
+struct DspPair {
+    int32_t lanes;
+};
+
+static inline DspPair dsp_min(DspPair a, DspPair b) {
+    __ssub16(a.lanes, b.lanes);
+    return {(int32_t)__sel(b.lanes, a.lanes)};
+}
+
+static inline DspPair dsp_max(DspPair a, DspPair b) {
+    __ssub16(a.lanes, b.lanes);
+    return {(int32_t)__sel(a.lanes, b.lanes)};
+}
+
+static inline DspPair dsp_load_pair(const int16_t* p) {
+    DspPair pair;
+    memcpy(&pair.lanes, p, sizeof(pair.lanes));  // Unaligned LDR
+    return pair;
+}
+
+static inline int32_t dsp_pack(int16_t lo, int16_t hi) {
+    return (int32_t)((uint16_t)lo | ((uint32_t)(uint16_t)hi << 16));
+}
+#endif
+
+template <typename T> static inline T dsp_med3(T a, T b, T c) {
+    return dsp_max(dsp_min(a, b), dsp_min(dsp_max(a, b), c));
+}
+
+template <typename T> static inline T dsp_med5(T a, T b, T c, T d, T e) {
+    T low = dsp_max(dsp_min(a, b), dsp_min(c, d));
+    T high = dsp_min(dsp_max(a, b), dsp_max(c, d));
+    return dsp_med3(e, low, high);
+}
+
+// Boxcar sums
+static int32_t dsp_sum_soft(const int16_t* x, size_t count) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += x[i];
+    }
+    return sum;
+}
+
+#if DSP_USE_SIMD
+// SMLAD against (1, 1) adds two samples per instruction
+static int32_t dsp_sum_simd(const int16_t* x, size_t count) {
+    int32_t sum = 0;
+    size_t i = 0;
+    for (; i + 1 < count; i += 2) {
+        sum = __smlad(dsp_load_pair(x + i).lanes, 0x00010001, sum);
+    }
+    if (i < count) {
+        sum += x[i];
+    }
+    return sum;
+}
+#endif
+
+static size_t dsp_run_boxcar(DspStage* stage, int16_t* x, size_t count) {
+    size_t out = 0;
+    size_t i = 0;
+
+    while (i < count) {
+        size_t take = stage->factor - stage->phase;
+        if (take > count - i) take = count - i;
+#if DSP_USE_SIMD
+        stage->acc[0] += dsp_use_simd ? dsp_sum_simd(x + i, take) : dsp_sum_soft(x + i, take);
+#else
+        stage->acc[0] += dsp_sum_soft(x + i, take);
+#endif
+        stage->phase += (uint16_t)take;
+        i += take;
+
+        // Outputs trail the inputs they came from, so writing in place is safe
+        if (stage->phase == stage->factor) {
+            x[out++] = dsp_round_div(stage->acc[0], stage->factor);
+            stage->acc[0] = 0;
+            stage->phase = 0;
+        }
+    }
+    return out;
+}
+
+// Integrators at the input rate, combs at the output rate. The sums wrap
+// (unsigned arithmetic), which a CIC tolerates as long as the final value
+// fits: factor^order * 32768 <= 2^31.
+static size_t dsp_run_cic(DspStage* stage, int16_t* x, size_t count) {
+    uint32_t* integrators = (uint32_t*)&stage->acc[0];
+    uint32_t* combs = (uint32_t*)&stage->acc[DSP_CIC_MAX_ORDER];
+    const uint8_t order = stage->order;
+    uint32_t gain = 1;
+    for (uint8_t k = 0; k < order; k++) gain *= stage->factor;
+
+    size_t out = 0;
+    for (size_t i = 0; i < count; i++) {
+        integrators[0] += (uint32_t)(int32_t)x[i];
+        for (uint8_t k = 1; k < order; k++) {
+            integrators[k] += integrators[k - 1];
+        }
+        if (++stage->phase < stage->factor) continue;
+
+        stage->phase = 0;
+        uint32_t value = integrators[order - 1];
+        for (uint8_t k = 0; k < order; k++) {
+            uint32_t delayed = combs[k];
+            combs[k] = value;
+            value -= delayed;
+        }
+        x[out++] = dsp_round_div((int32_t)value, gain);
+    }
+    return out;
+}
+
+// Processed from the end backwards: output i needs inputs i-window+1..i,
+// none of which has been overwritten yet. Inputs before the block come
+// from history.
+static size_t dsp_run_median(DspStage* stage, int16_t* x, size_t count) {
+    const int w = stage->factor;
+    int16_t* history = stage->history;
+    if (count == 0) return 0;
+
+    if (!stage->primed) {
+        for (int k = 0; k < w - 1; k++) history[k] = x[0];
+        stage->primed = true;
+    }
+
+    // The last window-1 inputs become the next block's history
+    int16_t next[4];
+    for (int k = 0; k < w - 1; k++) {
+        int j = (int)count - (w - 1) + k;
+        next[k] = j >= 0 ? x[j] : history[w - 1 + j];
+    }
+
+    int i = (int)count - 1;
+#if DSP_USE_SIMD
+    // Two outputs per pass: lane 0 is output i-1, lane 1 is output i
+    if (dsp_use_simd) {
+        for (; i >= w; i -= 2) {
+            const int16_t* p = x + i - 1;
+            DspPair median = w == 3
+                ? dsp_med3(dsp_load_pair(p - 2), dsp_load_pair(p - 1), dsp_load_pair(p))
+                : dsp_med5(dsp_load_pair(p - 4), dsp_load_pair(p - 3), dsp_load_pair(p - 2),
+                           dsp_load_pair(p - 1), dsp_load_pair(p));
+            memcpy(x + i - 1, &median.lanes, sizeof(median.lanes));
+        }
+    }
+#endif
+    for (; i >= 0; i--) {
+        int16_t v[5];
+        for (int k = 0; k < w; k++) {
+            int j = i - (w - 1) + k;
+            v[k] = j >= 0 ? x[j] : history[w - 1 + j];
+        }
+        x[i] = w == 3 ? dsp_med3(v[0], v[1], v[2]) : dsp_med5(v[0], v[1], v[2], v[3], v[4]);
+    }
+
+    memcpy(history, next, (w - 1) * sizeof(int16_t));
+    return count;
+}
+
+// State in Q16, so small steps are not lost to the shift
+static size_t dsp_run_ema(DspStage* stage, int16_t* x, size_t count) {
+    if (count == 0) return 0;
+    if (!stage->primed) {
+        stage->acc[0] = (int32_t)x[0] * 65536;
+        stage->primed = true;
+    }
+
+    int32_t state = stage->acc[0];
+    for (size_t i = 0; i < count; i++) {
+        state += (int32_t)(((int64_t)x[i] * 65536 - state) >> stage->factor);
+        x[i] = (int16_t)((state + 0x8000) >> 16);
+    }
+    stage->acc[0] = state;
+    return count;
+}
+
+// y = (b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2) / 2^14, rounded and saturated.
+// The sum wraps like SMLAD does, so both versions agree even on overflow.
+static size_t dsp_run_iir(DspStage* stage, int16_t* x, size_t count) {
+    const int16_t* c = stage->coeffs;
+    int16_t x1 = (int16_t)stage->acc[0];
+    int16_t x2 = (int16_t)stage->acc[1];
+    int16_t y1 = (int16_t)stage->acc[2];
+    int16_t y2 = (int16_t)stage->acc[3];
+
+#if DSP_USE_SIMD
+    if (dsp_use_simd) {
+        const int32_t b01 = dsp_pack(c[0], c[1]);
+        const int32_t b2a1 = dsp_pack(c[2], (int16_t)-c[3]);
+        const int32_t a2 = -c[4];
+        for (size_t i = 0; i < count; i++) {
+            int16_t in = x[i];
+            int32_t sum = __smlad(dsp_pack(in, x1), b01, 1 << 13);
+            sum = __smlad(dsp_pack(x2, y1), b2a1, sum);
+            sum = __smlabb(y2, a2, sum);
+            int16_t out = (int16_t)__ssat(sum >> 14, 16);
+            x2 = x1; x1 = in;
+            y2 = y1; y1 = out;
+            x[i] = out;
+        }
+    } else
+#endif
+    {
+        for (size_t i = 0; i < count; i++) {
+            int16_t in = x[i];
+            uint32_t sum = (1u << 13) + (uint32_t)(c[0] * in) + (uint32_t)(c[1] * x1) + (uint32_t)(c[2] * x2) -
+                           (uint32_t)(c[3] * y1) - (uint32_t)(c[4] * y2);
+            int16_t out = dsp_saturate((int32_t)sum >> 14);
+            x2 = x1; x1 = in;
+            y2 = y1; y1 = out;
+            x[i] = out;
+        }
+    }
+
+    stage->acc[0] = x1;
+    stage->acc[1] = x2;
+    stage->acc[2] = y1;
+    stage->acc[3] = y2;
+    return count;
+}
+
+void dsp_pipeline_init(DspPipeline* pipeline) {
+    memset(pipeline, 0, sizeof(*pipeline));
+}
+
+static DspStage* dsp_add_stage(DspPipeline* pipeline, DspStageType type, uint8_t factor) {
+    if (pipeline->count >= DSP_MAX_STAGES) return nullptr;
+
+    DspStage* stage = &pipeline->stages[pipeline->count];
+    memset(stage, 0, sizeof(*stage));
+    stage->type = type;
+    stage->factor = factor;
+    return stage;
+}
+
+int dsp_add_boxcar(DspPipeline* pipeline, uint8_t factor) {
+    if (factor == 0 || !dsp_add_stage(pipeline, DSP_BOXCAR, factor)) return -1;
+    return pipeline->count++;
+}
+
+int dsp_add_cic(DspPipeline* pipeline, uint8_t factor, uint8_t order) {
+    if (factor < 2 || order == 0 || order > DSP_CIC_MAX_ORDER) return -1;
+
+    uint32_t gain = 1;
+    for (uint8_t k = 0; k < order; k++) gain *= factor;
+    if (gain > 65536) return -1;
+
+    DspStage* stage = dsp_add_stage(pipeline, DSP_CIC, factor);
+    if (!stage) return -1;
+    stage->order = order;
+    return pipeline->count++;
+}
+
+int dsp_add_median(DspPipeline* pipeline, uint8_t window) {
+    if ((window != 3 && window != 5) || !dsp_add_stage(pipeline, DSP_MEDIAN, window)) return -1;
+    return pipeline->count++;
+}
+
+int dsp_add_ema(DspPipeline* pipeline, uint8_t shift) {
+    if (shift == 0 || shift > 15 || !dsp_add_stage(pipeline, DSP_EMA, shift)) return -1;
+    return pipeline->count++;
+}
+
+int dsp_add_iir(DspPipeline* pipeline, int16_t b0, int16_t b1, int16_t b2, int16_t a1, int16_t a2) {
+    // -a1 and -a2 must fit in a 16-bit lane
+    if (a1 == INT16_MIN || a2 == INT16_MIN) return -1;
+
+    DspStage* stage = dsp_add_stage(pipeline, DSP_IIR, 0);
+    if (!stage) return -1;
+    int16_t coeffs[5] = {b0, b1, b2, a1, a2};
+    memcpy(stage->coeffs, coeffs, sizeof(coeffs));
+    return pipeline->count++;
+}
+
+void dsp_pipeline_reset(DspPipeline* pipeline) {
+    for (uint8_t s = 0; s < pipeline->count; s++) {
+        DspStage* stage = &pipeline->stages[s];
+        stage->phase = 0;
+        stage->primed = false;
+        memset(stage->acc, 0, sizeof(stage->acc));
+        memset(stage->history, 0, sizeof(stage->history));
+    }
+}
+
+size_t dsp_pipeline_run(DspPipeline* pipeline, int16_t* samples, size_t count) {
+    for (uint8_t s = 0; s < pipeline->count && count > 0; s++) {
+        DspStage* stage = &pipeline->stages[s];
+        switch (stage->type) {
+            case DSP_BOXCAR: count = dsp_run_boxcar(stage, samples, count); break;
+            case DSP_CIC: count = dsp_run_cic(stage, samples, count); break;
+            case DSP_MEDIAN: count = dsp_run_median(stage, samples, count); break;
+            case DSP_EMA: count = dsp_run_ema(stage, samples, count); break;
+            case DSP_IIR: count = dsp_run_iir(stage, samples, count); break;
+        }
+    }
+    return count;
+}
+
+// Benchmark: each stage type on its own over a noisy 12-bit ramp with spikes
+#define DSP_BENCH_BLOCK 256
+#define DSP_BENCH_BLOCKS 400
+#define DSP_BENCH_STAGES 6
+
+static const char* const dsp_bench_names[DSP_BENCH_STAGES] = {
+    "boxcar/16", "cic/8x3", "median3", "median5", "ema>>4", "iir"
+};
+
+static void dsp_bench_pipeline(DspPipeline* pipeline, int which) {
+    dsp_pipeline_init(pipeline);
+    switch (which) {
+        case 0: dsp_add_boxcar(pipeline, 16); break;
+        case 1: dsp_add_cic(pipeline, 8, 3); break;
+        case 2: dsp_add_median(pipeline, 3); break;
+        case 3: dsp_add_median(pipeline, 5); break;
+        case 4: dsp_add_ema(pipeline, 4); break;
+        case 5: // 2nd-order Butterworth low-pass at 0.1 fs
+            dsp_add_iir(pipeline, DSP_Q14(0.0675f), DSP_Q14(0.1349f), DSP_Q14(0.0675f),
+                        DSP_Q14(-1.1430f), DSP_Q14(0.4128f));
+            break;
+    }
+}
+
+static void dsp_bench_signal(int16_t* x, size_t count, uint32_t seed) {
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        int32_t value = (int32_t)((i * 13) & 0x0FFF) + (int32_t)((seed >> 24) & 0x3F) - 32;
+        if ((seed & 0x3F00) == 0) value = 4095;  // Occasional spike
+        x[i] = dsp_saturate(value < 0 ? 0 : value > 4095 ? 4095 : value);
+    }
+}
+
+// Cycles per input sample in tenths, from elapsed time and the system clock
+static uint32_t dsp_cycles_x10(uint64_t elapsed_us, uint32_t samples) {
+    return (uint32_t)(elapsed_us * (clock_get_hz(clk_sys) / 100000) / samples);
+}
+
+static void dsp_benchmark_mode(bool simd, const int16_t* input) {
+    static int16_t block[DSP_BENCH_BLOCK];
+    const uint32_t samples = DSP_BENCH_BLOCK * DSP_BENCH_BLOCKS;
+    dsp_set_simd_enabled(simd);
+
+    // The block copy is timed on its own and taken off every stage
+    uint64_t start = time_us_64();
+    for (int b = 0; b < DSP_BENCH_BLOCKS; b++) {
+        memcpy(block, input, sizeof(block));
+        __asm volatile("" : : "r"(block) : "memory");
+    }
+    uint64_t copy_us = time_us_64() - start;
+
+    printf("DSP (%s), cycles per input sample:", simd ? "simd" : "portable");
+    for (int s = 0; s < DSP_BENCH_STAGES; s++) {
+        DspPipeline pipeline;
+        dsp_bench_pipeline(&pipeline, s);
+
+        start = time_us_64();
+        for (int b = 0; b < DSP_BENCH_BLOCKS; b++) {
+            memcpy(block, input, sizeof(block));
+            dsp_pipeline_run(&pipeline, block, DSP_BENCH_BLOCK);
+        }
+        uint64_t elapsed = time_us_64() - start;
+        uint32_t cycles = dsp_cycles_x10(elapsed > copy_us ? elapsed - copy_us : 0, samples);
+        printf(" %s %u.%u", dsp_bench_names[s], cycles / 10, cycles % 10);
+    }
+    printf("\n");
+}
+
+void dsp_benchmark() {
+    static int16_t input[DSP_BENCH_BLOCK];
+    dsp_bench_signal(input, DSP_BENCH_BLOCK, 1);
+
+    bool was_enabled = dsp_simd_enabled();
+
+    dsp_benchmark_mode(false, input);
+#if DSP_USE_SIMD
+    dsp_benchmark_mode(true, input);
+
+    // Both versions must match sample for sample, state carried across
+    // blocks of odd and even lengths included
+    static int16_t out[2][DSP_BENCH_BLOCK];
+    bool identical = true;
+    for (int s = 0; s < DSP_BENCH_STAGES; s++) {
+        DspPipeline pipelines[2];
+        for (int m = 0; m < 2; m++) dsp_bench_pipeline(&pipelines[m], s);
+
+        for (int b = 0; b < 16; b++) {
+            size_t count = DSP_BENCH_BLOCK - (size_t)(b * 7);
+            size_t produced[2];
+            for (int m = 0; m < 2; m++) {
+                dsp_set_simd_enabled(m == 1);
+                dsp_bench_signal(out[m], count, (uint32_t)b + 2);
+                produced[m] = dsp_pipeline_run(&pipelines[m], out[m], count);
+            }
+            identical = identical && produced[0] == produced[1] &&
+                        memcmp(out[0], out[1], produced[0] * sizeof(int16_t)) == 0;
+        }
+    }
+    printf("DSP: simd and portable output %s\n", identical ? "identical" : "DIFFERENT");
+#endif
+
+    dsp_set_simd_enabled(was_enabled);
+}
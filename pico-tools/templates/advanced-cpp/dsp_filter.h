@@ -0,0 +1,74 @@
+#ifndef DSP_FILTER_H
+#define DSP_FILTER_H
+
+#include "pico/stdlib.h"
+
+// Block filter pipeline for 16-bit samples (ADC rows, pot readings). Stages
+// run in order over a block, in place, and keep their state between blocks,
+// so a stream can be fed in blocks of any size. Decimating stages shorten
+// the block.
+//
+// Boxcar sums, medians and the IIR have an Armv8-M DSP version (SMLAD,
+// SSUB16/SEL on two 16-bit lanes) and a plain C version that produces the
+// same output bit for bit; the C version is always built, so the pipeline
+// also runs on the RP2040's M0+ and on the host.
+#ifndef DSP_USE_SIMD
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#define DSP_USE_SIMD 1
+#else
+#define DSP_USE_SIMD 0
+#endif
+#endif
+
+#define DSP_MAX_STAGES 6
+#define DSP_CIC_MAX_ORDER 4
+#define DSP_Q14(x) ((int16_t)((x) * 16384.0f + ((x) < 0 ? -0.5f : 0.5f)))  // IIR coefficients
+
+enum DspStageType : uint8_t {
+    DSP_BOXCAR,   // Mean of every factor samples (decimates by factor)
+    DSP_CIC,      // order-stage CIC decimator, normalised to unity gain
+    DSP_MEDIAN,   // Median of the last 3 or 5 samples: removes single spikes
+    DSP_EMA,      // y += (x - y) / 2^shift
+    DSP_IIR       // Biquad, Q14 coefficients, direct form I, saturating; the 32-bit
+                  // sum needs sum(|coefficient|) x peak input < 2^17
+};
+
+struct DspStage {
+    DspStageType type;
+    uint8_t factor;          // BOXCAR/CIC decimation, MEDIAN window, EMA shift
+    uint8_t order;           // CIC
+    uint16_t phase;          // BOXCAR/CIC: inputs into the current output
+    bool primed;             // MEDIAN/EMA: history filled from the first sample
+    int16_t coeffs[5];       // IIR: b0 b1 b2 a1 a2
+    int32_t acc[2 * DSP_CIC_MAX_ORDER];  // Sums, integrators and combs, EMA and IIR state
+    int16_t history[4];      // MEDIAN: last inputs, oldest first
+};
+
+struct DspPipeline {
+    DspStage stages[DSP_MAX_STAGES];
+    uint8_t count;
+};
+
+// Setup: each returns the stage index, or -1 if the pipeline is full or the
+// parameters are out of range
+void dsp_pipeline_init(DspPipeline* pipeline);
+int dsp_add_boxcar(DspPipeline* pipeline, uint8_t factor);
+int dsp_add_cic(DspPipeline* pipeline, uint8_t factor, uint8_t order);  // factor^order <= 65536
+int dsp_add_median(DspPipeline* pipeline, uint8_t window);
+int dsp_add_ema(DspPipeline* pipeline, uint8_t shift);
+int dsp_add_iir(DspPipeline* pipeline, int16_t b0, int16_t b1, int16_t b2, int16_t a1, int16_t a2);
+void dsp_pipeline_reset(DspPipeline* pipeline);  // Clears state, keeps the stages
+
+// Filters samples[0..count) in place; returns the samples left after decimation
+size_t dsp_pipeline_run(DspPipeline* pipeline, int16_t* samples, size_t count);
+
+// Runtime switch, mainly for benchmarking; on by default when built with
+// DSP_USE_SIMD
+void dsp_set_simd_enabled(bool enabled);
+bool dsp_simd_enabled();
+
+// Prints cycles per input sample for each stage type with and without the
+// DSP instructions, and checks that both versions agree
+void dsp_benchmark();
+
+#endif // DSP_FILTER_H
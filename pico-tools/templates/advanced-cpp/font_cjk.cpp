@@ -0,0 +1,215 @@
+#include "font_cjk.h"
+#include "font_cjk_data.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FONT_CJK_PAGES ((FONT_CJK_HEIGHT + 7) / 8)
+#define FONT_CJK_NO_GLYPH 0xFFFF
+
+struct FontCjkCacheSlot {
+    uint16_t glyph;         // Glyph index, FONT_CJK_NO_GLYPH when empty
+    uint32_t last_used;     // Cache tick of the most recent hit
+    uint8_t columns[FONT_CJK_PAGES][FONT_CJK_ADVANCE];
+};
+
+static FontCjkCacheSlot font_cjk_cache[FONT_CJK_CACHE_SLOTS];
+static uint32_t font_cjk_tick = 0;
+static FontCjkStats font_cjk_stats;
+static uint16_t font_cjk_fallback = FONT_CJK_NO_GLYPH;
+
+// Binary search of the sorted glyph table
+static uint16_t font_cjk_find(uint32_t codepoint) {
+    int low = 0;
+    int high = FONT_CJK_GLYPH_COUNT - 1;
+
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        uint32_t value = font_cjk_glyphs[mid].codepoint;
+        if (value == codepoint) return (uint16_t)mid;
+        if (value < codepoint) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return FONT_CJK_NO_GLYPH;
+}
+
+void font_cjk_init() {
+    for (int i = 0; i < FONT_CJK_CACHE_SLOTS; i++) {
+        font_cjk_cache[i].glyph = FONT_CJK_NO_GLYPH;
+        font_cjk_cache[i].last_used = 0;
+    }
+    font_cjk_tick = 0;
+    memset(&font_cjk_stats, 0, sizeof(font_cjk_stats));
+    font_cjk_fallback = font_cjk_find('?');
+}
+
+uint8_t font_cjk_height() {
+    return FONT_CJK_HEIGHT;
+}
+
+// Unpacks one glyph's PackBits stream into its trimmed columns
+static void font_cjk_decompress(uint16_t glyph, FontCjkCacheSlot* slot) {
+    const FontCjkGlyph* entry = &font_cjk_glyphs[glyph];
+    memset(slot->columns, 0, sizeof(slot->columns));
+
+    const uint8_t* src = &font_cjk_data[entry->offset];
+    size_t total = (size_t)entry->columns * FONT_CJK_PAGES;
+    size_t n = 0;
+
+    while (n < total) {
+        uint8_t control = *src++;
+        size_t count = control < 0x80 ? control + 1u : control - 126u;
+        bool repeat = control >= 0x80;
+
+        for (size_t i = 0; i < count && n < total; i++, n++) {
+            uint8_t value = repeat ? *src : src[i];
+            slot->columns[n / entry->columns][entry->first_column + n % entry->columns] = value;
+        }
+        src += repeat ? 1 : count;
+    }
+}
+
+// Cached columns for a glyph, decompressing into the least recently used
+// slot on a miss
+static const FontCjkCacheSlot* font_cjk_fetch(uint16_t glyph) {
+    font_cjk_tick++;
+
+    FontCjkCacheSlot* victim = &font_cjk_cache[0];
+    for (int i = 0; i < FONT_CJK_CACHE_SLOTS; i++) {
+        FontCjkCacheSlot* slot = &font_cjk_cache[i];
+        if (slot->glyph == glyph) {
+            slot->last_used = font_cjk_tick;
+            font_cjk_stats.hits++;
+            return slot;
+        }
+        if (slot->last_used < victim->last_used) victim = slot;
+    }
+
+    font_cjk_stats.misses++;
+    if (victim->glyph != FONT_CJK_NO_GLYPH) font_cjk_stats.evictions++;
+
+    victim->glyph = glyph;
+    victim->last_used = font_cjk_tick;
+    font_cjk_decompress(glyph, victim);
+    return victim;
+}
+
+void font_cjk_text_set(FontCjkText* text, const char* utf8) {
+    const uint8_t* s = (const uint8_t*)utf8;
+    text->length = 0;
+    font_cjk_stats.strings++;
+
+    while (*s && text->length < FONT_CJK_TEXT_MAX) {
+        uint32_t codepoint;
+        int extra;
+
+        if (*s < 0x80) {
+            codepoint = *s;
+            extra = 0;
+        } else if ((*s & 0xE0) == 0xC0) {
+            codepoint = *s & 0x1F;
+            extra = 1;
+        } else if ((*s & 0xF0) == 0xE0) {
+            codepoint = *s & 0x0F;
+            extra = 2;
+        } else {
+            codepoint = *s & 0x07;
+            extra = 3;
+        }
+        s++;
+
+        for (; extra > 0 && (*s & 0xC0) == 0x80; extra--) {
+            codepoint = (codepoint << 6) | (*s++ & 0x3F);
+        }
+        if (extra > 0) codepoint = '?'; // Truncated sequence
+
+        uint16_t glyph = font_cjk_find(codepoint);
+        if (glyph == FONT_CJK_NO_GLYPH) glyph = font_cjk_fallback;
+        if (glyph == FONT_CJK_NO_GLYPH) continue;
+
+        text->glyphs[text->length++] = glyph;
+    }
+}
+
+int font_cjk_draw(Framebuffer* fb, int x, uint8_t page, const FontCjkText* text) {
+    // Gather the visible columns of every page, then write each page once
+    uint8_t columns[FONT_CJK_PAGES][FB_WIDTH];
+    int first = x < 0 ? 0 : x;
+    size_t count = 0;
+
+    for (uint8_t i = 0; i < text->length && x < FB_WIDTH; i++) {
+        const FontCjkCacheSlot* slot = font_cjk_fetch(text->glyphs[i]);
+        for (int c = 0; c < FONT_CJK_ADVANCE; c++, x++) {
+            if (x < 0 || x >= FB_WIDTH) continue;
+            for (int p = 0; p < FONT_CJK_PAGES; p++) {
+                columns[p][count] = slot->columns[p][c];
+            }
+            count++;
+        }
+    }
+
+    for (int p = 0; p < FONT_CJK_PAGES && count > 0; p++) {
+        fb_write(fb, (uint8_t)(page + p), (uint8_t)first, columns[p], count);
+    }
+    return x;
+}
+
+int font_cjk_width(const FontCjkText* text) {
+    return text->length * FONT_CJK_ADVANCE;
+}
+
+const FontCjkStats* font_cjk_get_stats() {
+    return &font_cjk_stats;
+}
+
+uint32_t font_cjk_hit_rate_pct() {
+    uint32_t lookups = font_cjk_stats.hits + font_cjk_stats.misses;
+    return lookups ? (uint32_t)((uint64_t)font_cjk_stats.hits * 100 / lookups) : 0;
+}
+
+void font_cjk_print_stats() {
+    printf("CJK glyph cache: %u%% hits (%u hits, %u misses, %u evictions, %u strings decoded)\n",
+           font_cjk_hit_rate_pct(), font_cjk_stats.hits, font_cjk_stats.misses,
+           font_cjk_stats.evictions, font_cjk_stats.strings);
+}
+
+void font_cjk_benchmark() {
+    static const char* const names[] = {"カットオフ", "レゾナンス", "ボリューム", "アタック", "ディケイ"};
+    const int label_count = sizeof(names) / sizeof(names[0]);
+    const uint32_t passes = 200;
+
+    static Framebuffer scratch;
+    static FontCjkText labels[sizeof(names) / sizeof(names[0])];
+    fb_init(&scratch);
+
+    // Cold: every pass starts with an empty cache, so each glyph is decompressed
+    uint64_t cold_us = 0;
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        font_cjk_init();
+        for (int i = 0; i < label_count; i++) font_cjk_text_set(&labels[i], names[i]);
+
+        uint64_t start = time_us_64();
+        for (int i = 0; i < label_count; i++) {
+            font_cjk_draw(&scratch, 0, (uint8_t)(i % FB_PAGES), &labels[i]);
+        }
+        cold_us += time_us_64() - start;
+    }
+
+    // Warm: same labels again with the cache already filled
+    uint64_t start = time_us_64();
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        for (int i = 0; i < label_count; i++) {
+            font_cjk_draw(&scratch, 0, (uint8_t)(i % FB_PAGES), &labels[i]);
+        }
+    }
+    uint64_t warm_us = time_us_64() - start;
+
+    printf("CJK labels: %u.%02uus cold, %u.%02uus warm per %d-label frame (%u%% hits warm)\n",
+           (unsigned)(cold_us / passes), (unsigned)(cold_us * 100 / passes % 100),
+           (unsigned)(warm_us / passes), (unsigned)(warm_us * 100 / passes % 100),
+           label_count, font_cjk_hit_rate_pct());
+
+    font_cjk_init();
+}
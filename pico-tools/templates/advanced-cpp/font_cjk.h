@@ -0,0 +1,52 @@
+#ifndef FONT_CJK_H
+#define FONT_CJK_H
+
+#include "pico/stdlib.h"
+#include "framebuffer.h"
+
+// Compressed bitmap font for Japanese labels. The glyph table is generated
+// by pico-font-convert (font_cjk_data.h); glyphs are decoded on first use
+// into a small LRU cache in SRAM, so repeated labels never touch flash.
+#define FONT_CJK_CACHE_SLOTS 32
+#define FONT_CJK_TEXT_MAX 24
+
+// One entry of the generated glyph table
+struct FontCjkGlyph {
+    uint32_t codepoint;
+    uint16_t offset;        // Start of the PackBits data in font_cjk_data (converter keeps it < 64 KiB)
+    uint8_t first_column;   // Blank columns trimmed from the left
+    uint8_t columns;        // Columns stored (0 for a blank glyph)
+};
+
+// A label decoded once from UTF-8 into glyph indices, ready to draw every frame
+struct FontCjkText {
+    uint16_t glyphs[FONT_CJK_TEXT_MAX];
+    uint8_t length;
+};
+
+struct FontCjkStats {
+    uint32_t hits;           // Glyphs drawn from the cache
+    uint32_t misses;         // Glyphs decompressed from flash
+    uint32_t evictions;      // Misses that replaced a cached glyph
+    uint32_t strings;        // UTF-8 strings decoded by font_cjk_text_set()
+};
+
+// Setup (also empties the cache)
+void font_cjk_init();
+uint8_t font_cjk_height();
+
+// Text: decode once, then draw as often as needed. Drawing starts on a
+// page boundary and covers as many pages as the font is tall.
+void font_cjk_text_set(FontCjkText* text, const char* utf8);
+int font_cjk_draw(Framebuffer* fb, int x, uint8_t page, const FontCjkText* text);
+int font_cjk_width(const FontCjkText* text);
+
+// Statistics
+const FontCjkStats* font_cjk_get_stats();
+uint32_t font_cjk_hit_rate_pct();
+void font_cjk_print_stats();
+
+// Prints render time for typical pot labels with a cold and a warm cache
+void font_cjk_benchmark();
+
+#endif // FONT_CJK_H
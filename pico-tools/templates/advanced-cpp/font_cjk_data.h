@@ -0,0 +1,54 @@
+// Generated by pico-font-convert from sample_kana.bdf - do not edit
+// 24 glyphs, 166 bytes of glyph data (192 bytes uncompressed)
+#ifndef FONT_CJK_DATA_H
+#define FONT_CJK_DATA_H
+
+#include "font_cjk.h"
+
+#define FONT_CJK_HEIGHT 8
+#define FONT_CJK_ADVANCE 8
+#define FONT_CJK_GLYPH_COUNT 24
+
+// Sorted by codepoint for binary search
+static const FontCjkGlyph font_cjk_glyphs[FONT_CJK_GLYPH_COUNT] = {
+    {0x0020, 0, 0, 0}, //  
+    {0x003F, 0, 0, 6}, // ?
+    {0x30A2, 8, 0, 7}, // ア
+    {0x30A3, 16, 2, 3}, // ィ
+    {0x30A4, 20, 0, 6}, // イ
+    {0x30AA, 27, 0, 6}, // オ
+    {0x30AB, 34, 0, 6}, // カ
+    {0x30AF, 42, 0, 7}, // ク
+    {0x30B1, 50, 0, 7}, // ケ
+    {0x30B9, 58, 0, 7}, // ス
+    {0x30BE, 66, 0, 8}, // ゾ
+    {0x30BF, 75, 0, 7}, // タ
+    {0x30C3, 83, 0, 6}, // ッ
+    {0x30C7, 90, 0, 8}, // デ
+    {0x30C8, 99, 1, 4}, // ト
+    {0x30CA, 105, 0, 7}, // ナ
+    {0x30D5, 112, 0, 6}, // フ
+    {0x30DC, 119, 0, 8}, // ボ
+    {0x30E0, 128, 0, 7}, // ム
+    {0x30E5, 136, 0, 6}, // ュ
+    {0x30EA, 143, 1, 5}, // リ
+    {0x30EC, 150, 1, 5}, // レ
+    {0x30F3, 156, 0, 7}, // ン
+    {0x30FC, 164, 0, 7}, // ー
+};
+
+static const uint8_t font_cjk_data[166] = {
+    0x00, 0x02, 0x80, 0x01, 0x02, 0x51, 0x09, 0x06, 0x06, 0x01, 0x41, 0x21, 0x1D, 0x05, 0x03, 0x01,
+    0x02, 0x10, 0x08, 0x7C, 0x05, 0x10, 0x08, 0x04, 0x7C, 0x02, 0x01, 0x05, 0x44, 0x24, 0x14, 0x4C,
+    0x7F, 0x04, 0x02, 0x44, 0x24, 0x1F, 0x80, 0x44, 0x00, 0x3C, 0x06, 0x04, 0x42, 0x43, 0x22, 0x12,
+    0x0E, 0x02, 0x04, 0x04, 0x03, 0x42, 0x22, 0x1E, 0x80, 0x02, 0x06, 0x40, 0x21, 0x11, 0x09, 0x0D,
+    0x13, 0x20, 0x07, 0x02, 0x4C, 0x40, 0x20, 0x10, 0x0D, 0x02, 0x01, 0x06, 0x44, 0x42, 0x2B, 0x12,
+    0x0A, 0x06, 0x02, 0x05, 0x04, 0x08, 0x44, 0x48, 0x20, 0x1C, 0x07, 0x08, 0x0A, 0x4A, 0x3A, 0x0A,
+    0x09, 0x0A, 0x01, 0x00, 0x7F, 0x80, 0x04, 0x00, 0x08, 0x03, 0x04, 0x44, 0x24, 0x1F, 0x81, 0x04,
+    0x80, 0x41, 0x03, 0x21, 0x11, 0x09, 0x07, 0x07, 0x24, 0x14, 0x44, 0x7F, 0x04, 0x15, 0x26, 0x01,
+    0x06, 0x20, 0x30, 0x2C, 0x23, 0x20, 0x28, 0x30, 0x00, 0x20, 0x81, 0x24, 0x01, 0x3C, 0x20, 0x00,
+    0x0F, 0x80, 0x40, 0x01, 0x20, 0x1F, 0x04, 0x7F, 0x40, 0x20, 0x10, 0x08, 0x06, 0x41, 0x42, 0x40,
+    0x20, 0x10, 0x08, 0x06, 0x85, 0x08,
+};
+
+#endif // FONT_CJK_DATA_H
@@ -0,0 +1,67 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// SSD1306 geometry: 128 columns x 8 pages, each page byte holds 8 vertical pixels
+#define FB_WIDTH 128
+#define FB_HEIGHT 64
+#define FB_PAGES (FB_HEIGHT / 8)
+
+// Bytes the old full-page path put on the bus per frame:
+// page command (2) + column command (4) + data write (1 + 128) for every page
+#define FB_FULL_FRAME_BYTES (FB_PAGES * (2 + 4 + 1 + FB_WIDTH))
+
+// Bytes the windowed path sends per dirty window besides its columns:
+// control byte + page and column commands (4, see oled.h), then the data control byte
+#define FB_WINDOW_OVERHEAD_BYTES 5
+
+// Flush accounting, updated by the display driver after every flush
+struct FramebufferStats {
+    uint32_t frames;             // Flushes that sent at least one window
+    uint32_t last_frame_bytes;   // Bytes sent by the most recent flush
+    uint32_t last_frame_windows; // Column windows sent by the most recent flush
+    uint64_t total_bytes;        // Bytes sent since fb_init()
+};
+
+// One contiguous run of changed columns inside a single page
+struct FramebufferWindow {
+    uint8_t page;
+    uint8_t start;        // First column (inclusive)
+    uint8_t end;          // Last column (inclusive)
+    const uint8_t* data;  // Points at pixels[page][start]
+    uint8_t length;       // end - start + 1
+};
+
+// 128x64 page-major framebuffer with per-page dirty column ranges
+struct Framebuffer {
+    uint8_t pixels[FB_PAGES][FB_WIDTH];
+    uint8_t dirty_pages;            // Bit n set when page n needs flushing
+    uint8_t dirty_start[FB_PAGES];  // Lowest dirty column per page
+    uint8_t dirty_end[FB_PAGES];    // Highest dirty column per page
+    FramebufferStats stats;
+};
+
+// Setup
+void fb_init(Framebuffer* fb);
+
+// Drawing (only bytes that actually change are marked dirty)
+void fb_clear(Framebuffer* fb);
+void fb_fill(Framebuffer* fb, uint8_t pattern);
+void fb_set_pixel(Framebuffer* fb, int x, int y, bool on);
+bool fb_get_pixel(const Framebuffer* fb, int x, int y);
+void fb_write(Framebuffer* fb, uint8_t page, uint8_t x, const uint8_t* data, size_t length);
+void fb_write_masked(Framebuffer* fb, uint8_t page, uint8_t x, const uint8_t* data, uint8_t mask, size_t length);
+
+// Dirty tracking
+void fb_mark_dirty(Framebuffer* fb, uint8_t page, uint8_t start, uint8_t end);
+void fb_mark_all_dirty(Framebuffer* fb);
+bool fb_is_dirty(const Framebuffer* fb);
+uint32_t fb_dirty_bytes(const Framebuffer* fb);
+bool fb_next_window(Framebuffer* fb, FramebufferWindow* window);
+
+// Accounting
+void fb_record_flush(Framebuffer* fb, uint32_t bytes, uint32_t windows);
+
+#endif // FRAMEBUFFER_H
@@ -0,0 +1,29 @@
+#ifndef GFX_H
+#define GFX_H
+
+#include "pico/stdlib.h"
+#include "framebuffer.h"
+
+// Drawing primitives on the framebuffer. Everything is clipped to the
+// screen and works a page at a time with precomputed row masks, so cost
+// scales with columns x pages touched rather than with pixels.
+
+// Lines and rectangles (on = set pixels, off = clear them)
+void gfx_hline(Framebuffer* fb, int x, int y, int w, bool on);
+void gfx_vline(Framebuffer* fb, int x, int y, int h, bool on);
+void gfx_fill_rect(Framebuffer* fb, int x, int y, int w, int h, bool on);
+void gfx_rect(Framebuffer* fb, int x, int y, int w, int h, bool on);
+
+// Horizontal level meter: 1-pixel outline, filled from the left in
+// proportion to value / max, cleared beyond that
+void gfx_bar(Framebuffer* fb, int x, int y, int w, int h, uint32_t value, uint32_t max);
+
+// 1-bpp bitmap in framebuffer layout: (h + 7) / 8 pages of w column bytes,
+// bit n = row n. Replaces the covered w x h pixels; any x, y and size
+// work, and only the part that lands on screen is read.
+void gfx_blit(Framebuffer* fb, int x, int y, const uint8_t* bitmap, int w, int h);
+
+// Prints fast-path vs per-pixel timings for a pot meter redraw
+void gfx_benchmark();
+
+#endif // GFX_H
@@ -0,0 +1,75 @@
+#include "adc_loopback.h"
+#include "adc_dma.h"
+
+#define LOOP_CLK_MHZ 48
+
+static bool loop_running = false;
+static uint16_t* loop_samples = nullptr;
+static uint32_t loop_mask = 0;
+static uint8_t loop_inputs = 0;
+static uint32_t loop_cycles_x256 = 0;
+static uint64_t loop_count = 0;        // Samples written
+static uint32_t loop_advance = 0;
+
+bool adc_dma_stream_start(uint16_t input_mask, uint32_t rate_hz, uint16_t* samples, uint8_t order) {
+    if (loop_running || input_mask == 0 || rate_hz == 0) return false;
+
+    // Same rounding as the ADC divider on target
+    uint64_t cycles_x256 = ((uint64_t)LOOP_CLK_MHZ * 1000000 << 8) / rate_hz;
+    if (cycles_x256 < ADC_DMA_MIN_CYCLES << 8) cycles_x256 = ADC_DMA_MIN_CYCLES << 8;
+    if (cycles_x256 > 0x10000u << 8) cycles_x256 = 0x10000u << 8;
+    loop_cycles_x256 = (uint32_t)cycles_x256;
+
+    loop_inputs = 0;
+    for (int input = 0; input < 16; input++) {
+        if (input_mask & (1u << input)) loop_inputs++;
+    }
+    loop_samples = samples;
+    loop_mask = (1u << order) - 1;
+    loop_count = 0;
+    loop_advance = 0;
+    loop_running = true;
+    return true;
+}
+
+void adc_dma_stream_stop() {
+    loop_running = false;
+}
+
+void adc_loopback_run(uint32_t samples) {
+    if (!loop_running) return;
+
+    for (uint32_t i = 0; i < samples; i++) {
+        uint64_t n = loop_count++;
+        uint32_t frame = (uint32_t)(n / loop_inputs);
+        uint32_t slot = (uint32_t)(n % loop_inputs);
+        loop_samples[n & loop_mask] = (uint16_t)(((frame & 0x1FF) << 3) | slot);
+    }
+}
+
+void adc_loopback_set_advance_per_poll(uint32_t samples) {
+    loop_advance = samples;
+}
+
+uint8_t adc_loopback_inputs() {
+    return loop_inputs;
+}
+
+uint64_t adc_dma_stream_samples() {
+    if (!loop_running) return 0;
+
+    adc_loopback_run(loop_advance);
+    return loop_count;
+}
+
+uint32_t adc_dma_stream_sample_us(uint64_t n) {
+    return (uint32_t)(n * loop_cycles_x256 / (LOOP_CLK_MHZ << 8));
+}
+
+uint32_t adc_dma_stream_rate_hz() {
+    return loop_cycles_x256 ? (uint32_t)(((uint64_t)LOOP_CLK_MHZ * 1000000 << 8) / loop_cycles_x256) : 0;
+}
+
+uint32_t adc_dma_stream_restarts() {
+    return 0;
+}
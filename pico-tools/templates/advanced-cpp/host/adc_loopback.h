@@ -0,0 +1,19 @@
+#ifndef ADC_LOOPBACK_H
+#define ADC_LOOPBACK_H
+
+#include "pico/stdlib.h"
+
+// Host stand-in for adc_dma. Nothing runs by itself: adc_loopback_run()
+// plays the ADC and DMA for a number of conversions. Each sample encodes its
+// position in the round robin (low 3 bits) and its frame number (upper 9
+// bits), so order, gaps and samples on the wrong row all show in the data.
+// clk_adc is 48MHz as on target.
+void adc_loopback_run(uint32_t samples);
+
+// DMA progress between two polls of adc_dma_stream_samples(), e.g. while
+// the consumer copies a block out
+void adc_loopback_set_advance_per_poll(uint32_t samples);
+
+uint8_t adc_loopback_inputs();
+
+#endif // ADC_LOOPBACK_H
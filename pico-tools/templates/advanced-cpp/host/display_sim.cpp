@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <string.h>
+#include "i2c_sim.h"
+#include "display.h"
+#include "display_mux.h"
+#include "i2c_arb.h"
+#include "i2c_health.h"
+#include "i2c_scan.h"
+#include "text.h"
+#include "gfx.h"
+
+// Runs the real display and mux code against the bus model, prints what
+// each phase put on the wire and writes every panel to <out-dir>/*.pgm.
+// Exits non-zero if any panel's RAM differs from its framebuffer.
+#define SIM_FRAMES 10
+#define SIM_PGM_SCALE 4
+
+static const char* sim_out_dir = ".";
+
+static int sim_check_panel(int panel, const Framebuffer* fb, const char* name) {
+    const uint8_t* ram = i2c_sim_panel_ram(panel);
+    int mismatched = 0;
+
+    for (int page = 0; page < FB_PAGES; page++) {
+        for (int x = 0; x < FB_WIDTH; x++) {
+            if (ram[page * FB_WIDTH + x] != fb->pixels[page][x]) mismatched++;
+        }
+    }
+
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s.pgm", sim_out_dir, name);
+    bool dumped = i2c_sim_dump_pgm(panel, path, SIM_PGM_SCALE);
+
+    printf("%-24s %s, %d of %d bytes differ from the framebuffer%s\n",
+           name, mismatched ? "MISMATCH" : "ok", mismatched, FB_PAGES * FB_WIDTH,
+           dumped ? "" : " (PGM not written)");
+    return mismatched ? 1 : 0;
+}
+
+// Unplug the panel mid-run: after I2C_HEALTH_OFFLINE_AFTER failed flushes
+// the display goes offline and stops using the bus; plugged back in, the
+// background re-probe finds it, re-initialises it and resends the frame
+static int sim_hot_plug(int panel) {
+    Framebuffer* fb = display_get_framebuffer();
+
+    i2c_sim_set_connected(panel, false);
+    for (int i = 0; i < I2C_HEALTH_OFFLINE_AFTER; i++) {
+        text_draw(fb, 0, 5 * TEXT_LINE_HEIGHT, "Unplugged");
+        display_flush_async();
+    }
+    i2c_health_service(); // Offline callback runs here, outside IRQ context
+
+    i2c_sim_reset_stats();
+    for (int i = 0; i < SIM_FRAMES; i++) {
+        display_flush_async();
+        i2c_health_service(); // Not due yet: no probe traffic either
+    }
+    i2c_sim_print_stats(1, "offline, 10 flushes");
+
+    i2c_sim_set_connected(panel, true);
+    sleep_ms(I2C_HEALTH_PROBE_MIN_MS + 10);
+    i2c_sim_reset_stats();
+    i2c_health_service();
+    i2c_sim_print_stats(1, "re-probe + re-init");
+    i2c_health_print_stats();
+
+    int failures = i2c_sim_get_stats(1)->bytes == 0 ? 1 : 0;
+    if (failures) printf("replug: panel was not re-probed\n");
+    return failures + sim_check_panel(panel, fb, "replug");
+}
+
+static int sim_single_panel() {
+    printf("=== One SSD1306 on i2c1 ===\n");
+    i2c_sim_reset();
+    int panel = i2c_sim_add_panel(1, I2C_SIM_DIRECT, 0x3C);
+
+    display_init();
+    i2c_sim_print_stats(1, "init + clear");
+
+    i2c_sim_reset_stats();
+    for (int frame = 0; frame < SIM_FRAMES; frame++) {
+        float temperature = 21.0f + frame * 0.3f;
+        uint16_t light = (uint16_t)(frame * 4095 / (SIM_FRAMES - 1));
+        display_update_demo(temperature, light);
+    }
+    i2c_sim_print_stats(1, "widget frames");
+
+    // The same screen sent in full, as a flush without dirty windows would
+    i2c_sim_reset_stats();
+    fb_mark_all_dirty(display_get_framebuffer());
+    display_flush();
+    i2c_sim_print_stats(1, "one full frame");
+
+    int failures = sim_check_panel(panel, display_get_framebuffer(), "single");
+    return failures + sim_hot_plug(panel);
+}
+
+// Background enumeration of the bus and every mux channel, interleaved with
+// the mux scheduler the way the main loop runs them
+static int sim_scan_mux() {
+    i2c_sim_reset_stats();
+    uint32_t generation = i2c_scan_generation(i2c1);
+    for (int i = 0; i < 1000 && i2c_scan_generation(i2c1) == generation; i++) {
+        i2c_scan_service();
+        display_mux_service();
+    }
+    i2c_sim_print_stats(1, "scan");
+    i2c_scan_report();
+
+    int failures = i2c_scan_present(i2c1, I2C_SCAN_DIRECT, 0x70) ? 0 : 1;
+    for (uint8_t ch = 0; ch < I2C_SCAN_MUX_CHANNELS; ch++) {
+        bool expected = ch < DISPLAY_MUX_CHANNELS;
+        if (i2c_scan_present(i2c1, ch, 0x3C) != expected) failures++;
+    }
+    if (failures) printf("scan: device map is wrong\n");
+    return failures;
+}
+
+// DMA left running between polls, every panel fully dirty, and a
+// sensor-class read of the mux register queued in the middle of a slice: it
+// must go out once the chunk on the wire ends, not after the whole slice
+static int sim_arbiter() {
+    static const uint16_t read_words[] = {I2C_DMA_READ, I2C_DMA_READ | I2C_DMA_STOP};
+    uint8_t rx[2] = {0xAA, 0xAA};
+    I2cTransaction sensor = {};
+    sensor.i2c = i2c1;
+    sensor.addr = 0x70;
+    sensor.channel = I2C_ARB_ANY;
+    sensor.priority = I2C_PRIO_SENSOR;
+    sensor.words = read_words;
+    sensor.count = 2;
+    sensor.rx = rx;
+    sensor.rx_len = sizeof(rx);
+
+    i2c_sim_set_dma_deferred(true);
+    for (uint8_t ch = 0; ch < DISPLAY_MUX_CHANNELS; ch++) {
+        Framebuffer* fb = display_mux_get_framebuffer(ch);
+        text_draw(fb, 0, 4 * TEXT_LINE_HEIGHT, "Arbiter");
+        fb_mark_all_dirty(fb);
+        display_mux_present(ch);
+    }
+
+    // Mux select, then the slice's first chunk
+    display_mux_service();
+    i2c_arb_service();
+    uint32_t preempted = i2c_arb_get_stats(i2c1)->classes[I2C_PRIO_DISPLAY].preemptions;
+
+    i2c_arb_submit(&sensor);
+    int polls = 0;
+    while (i2c_arb_pending(&sensor) && polls < 100) {
+        polls++;
+    }
+
+    // Let the display side drain
+    for (int i = 0; i < 2000 && (i2c_sim_dma_pending(1) || i < 8 * DISPLAY_MUX_CHANNELS); i++) {
+        i2c_arb_service();
+        display_mux_service();
+    }
+    i2c_sim_set_dma_deferred(false);
+    i2c_arb_print_stats();
+
+    int failures = 0;
+    preempted = i2c_arb_get_stats(i2c1)->classes[I2C_PRIO_DISPLAY].preemptions - preempted;
+    printf("sensor read queued mid-slice: done after %d transfers, mux register 0x%02X, display preempted %u times\n",
+           polls, rx[0], preempted);
+    if (polls > 2 || preempted == 0) {
+        printf("arbiter: the sensor read waited for more than one chunk\n");
+        failures++;
+    }
+    if (rx[0] != rx[1] || __builtin_popcount(rx[0]) != 1) {
+        printf("arbiter: the mux register did not come back with one channel open\n");
+        failures++;
+    }
+    return failures;
+}
+
+static int sim_mux_panels() {
+    printf("\n=== %d SSD1306 behind a TCA9548A on i2c1 ===\n", DISPLAY_MUX_CHANNELS);
+    i2c_sim_reset();
+    i2c_sim_add_mux(1, 0x70);
+
+    int panels[DISPLAY_MUX_CHANNELS];
+    for (uint8_t ch = 0; ch < DISPLAY_MUX_CHANNELS; ch++) {
+        panels[ch] = i2c_sim_add_panel(1, ch, 0x3C);
+    }
+
+    display_mux_init();
+    i2c_sim_print_stats(1, "init");
+
+    i2c_sim_reset_stats();
+    for (int frame = 0; frame < SIM_FRAMES; frame++) {
+        for (uint8_t ch = 0; ch < DISPLAY_MUX_CHANNELS; ch++) {
+            Framebuffer* fb = display_mux_get_framebuffer(ch);
+            char label[16];
+            snprintf(label, sizeof(label), "Panel %u", ch);
+            text_draw(fb, 0, 0, label);
+            gfx_bar(fb, 0, FB_HEIGHT - 12, FB_WIDTH, 12, (uint32_t)(frame * (ch + 1)), SIM_FRAMES * DISPLAY_MUX_CHANNELS);
+            display_mux_present(ch);
+        }
+
+        // Transfers finish immediately here, so a few passes drain every channel
+        for (int i = 0; i < 4 * DISPLAY_MUX_CHANNELS; i++) {
+            display_mux_service();
+        }
+    }
+    i2c_sim_print_stats(1, "bar frames");
+    display_mux_print_stats();
+
+    int failures = sim_scan_mux();
+
+    // Panel traffic after the scan must still land on the right channels
+    for (uint8_t ch = 0; ch < DISPLAY_MUX_CHANNELS; ch++) {
+        text_draw(display_mux_get_framebuffer(ch), 0, 3 * TEXT_LINE_HEIGHT, "Scanned");
+        display_mux_present(ch);
+    }
+    for (int i = 0; i < 4 * DISPLAY_MUX_CHANNELS; i++) {
+        display_mux_service();
+    }
+    failures += sim_arbiter();
+
+    for (uint8_t ch = 0; ch < DISPLAY_MUX_CHANNELS; ch++) {
+        char name[16];
+        snprintf(name, sizeof(name), "mux_ch%u", ch);
+        failures += sim_check_panel(panels[ch], display_mux_get_framebuffer(ch), name);
+    }
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        sim_out_dir = argv[1];
+    }
+
+    int failures = sim_single_panel();
+    failures += sim_mux_panels();
+
+    printf("\n%s\n", failures ? "FAILED: panel RAM does not match" : "All panels match their framebuffers");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "text.h"
+#include "gfx.h"
+#include "font_cjk.h"
+#include "font_cjk_data.h"
+
+// Runs the drawing benchmarks the target prints at boot on the host, so a
+// change to a fast path can be timed without a board. Host figures are for
+// comparing paths with each other, not for predicting target numbers.
+// Then checks the page-mask fast paths against drawing one pixel at a
+// time over random placements, partly or wholly off screen, with bitmaps
+// up to 200 rows tall, and decodes every glyph in font_cjk_data.h against
+// the BDF font it was generated from (SIM_FONT_BDF, or the path given as
+// the first argument). Exits non-zero if anything differs.
+#define SIM_TRIALS 20000
+#define SIM_MAX_W 30
+#define SIM_MAX_H 200
+
+static uint32_t sim_seed = 1;
+
+static uint32_t sim_random(uint32_t range) {
+    sim_seed = sim_seed * 1664525u + 1013904223u;
+    return (sim_seed >> 8) % range;
+}
+
+// Same noise in both framebuffers, so untouched pixels are checked too
+static void sim_fill_noise(Framebuffer* a, Framebuffer* b) {
+    fb_init(a);
+    for (int page = 0; page < FB_PAGES; page++) {
+        for (int x = 0; x < FB_WIDTH; x++) {
+            a->pixels[page][x] = (uint8_t)sim_random(256);
+        }
+    }
+    *b = *a;
+}
+
+static bool sim_same(const Framebuffer* a, const Framebuffer* b) {
+    return memcmp(a->pixels, b->pixels, sizeof(a->pixels)) == 0;
+}
+
+static int sim_check_blit() {
+    static uint8_t bitmap[((SIM_MAX_H + 7) / 8) * SIM_MAX_W];
+    static Framebuffer fast, reference;
+    int mismatches = 0;
+
+    for (int trial = 0; trial < SIM_TRIALS; trial++) {
+        int w = 1 + (int)sim_random(SIM_MAX_W);
+        int h = 1 + (int)sim_random(SIM_MAX_H);
+        int x = (int)sim_random(FB_WIDTH + 2 * SIM_MAX_W) - SIM_MAX_W;
+        int y = (int)sim_random(FB_HEIGHT + 2 * SIM_MAX_H) - SIM_MAX_H - 50;
+        for (int i = 0; i < (h + 7) / 8 * w; i++) bitmap[i] = (uint8_t)sim_random(256);
+        sim_fill_noise(&fast, &reference);
+
+        gfx_blit(&fast, x, y, bitmap, w, h);
+        for (int row = 0; row < h; row++) {
+            for (int col = 0; col < w; col++) {
+                fb_set_pixel(&reference, x + col, y + row, (bitmap[(row / 8) * w + col] >> (row % 8)) & 1);
+            }
+        }
+
+        if (!sim_same(&fast, &reference) && mismatches++ < 5) {
+            printf("  gfx_blit differs: x=%d y=%d w=%d h=%d\n", x, y, w, h);
+        }
+    }
+
+    printf("gfx_blit       %5d placements, %d differ from per-pixel %s\n", SIM_TRIALS, mismatches,
+           mismatches ? "MISMATCH" : "ok");
+    return mismatches ? 1 : 0;
+}
+
+static int sim_check_fill_rect() {
+    static Framebuffer fast, reference;
+    int mismatches = 0;
+
+    for (int trial = 0; trial < SIM_TRIALS; trial++) {
+        int w = (int)sim_random(FB_WIDTH + 20);
+        int h = (int)sim_random(FB_HEIGHT + 20);
+        int x = (int)sim_random(FB_WIDTH + 40) - 20;
+        int y = (int)sim_random(FB_HEIGHT + 40) - 20;
+        bool on = sim_random(2);
+        sim_fill_noise(&fast, &reference);
+
+        gfx_fill_rect(&fast, x, y, w, h, on);
+        for (int row = 0; row < h; row++) {
+            for (int col = 0; col < w; col++) {
+                fb_set_pixel(&reference, x + col, y + row, on);
+            }
+        }
+
+        if (!sim_same(&fast, &reference) && mismatches++ < 5) {
+            printf("  gfx_fill_rect differs: x=%d y=%d w=%d h=%d %s\n", x, y, w, h, on ? "on" : "off");
+        }
+    }
+
+    printf("gfx_fill_rect  %5d rectangles, %d differ from per-pixel %s\n", SIM_TRIALS, mismatches,
+           mismatches ? "MISMATCH" : "ok");
+    return mismatches ? 1 : 0;
+}
+
+struct SimBdfGlyph {
+    uint32_t codepoint;
+    int bbx[4];                  // Width, rows, x offset, y offset
+    std::vector<uint32_t> rows;  // Top down, MSB = leftmost pixel
+};
+
+// Just enough BDF for pico-font-convert's inputs
+static bool sim_load_bdf(const char* path, int* ascent, std::vector<SimBdfGlyph>* glyphs) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+
+    char line[256];
+    int bbox[4] = {0, 0, 0, 0};
+    bool in_bitmap = false;
+    SimBdfGlyph glyph;
+    int32_t encoding = -1;
+    *ascent = -1;
+
+    while (fgets(line, sizeof(line), f)) {
+        if (in_bitmap) {
+            if (strncmp(line, "ENDCHAR", 7) == 0) {
+                in_bitmap = false;
+                if (encoding >= 0) {
+                    glyph.codepoint = (uint32_t)encoding;
+                    glyphs->push_back(glyph);
+                }
+            } else {
+                glyph.rows.push_back((uint32_t)strtoul(line, nullptr, 16));
+            }
+            continue;
+        }
+
+        if (sscanf(line, "FONTBOUNDINGBOX %d %d %d %d", &bbox[0], &bbox[1], &bbox[2], &bbox[3]) == 4) continue;
+        if (sscanf(line, "FONT_ASCENT %d", ascent) == 1) continue;
+        if (strncmp(line, "STARTCHAR", 9) == 0) {
+            glyph = SimBdfGlyph();
+            encoding = -1;
+        } else if (sscanf(line, "ENCODING %d", &encoding) == 1) {
+        } else if (sscanf(line, "BBX %d %d %d %d", &glyph.bbx[0], &glyph.bbx[1], &glyph.bbx[2], &glyph.bbx[3]) == 4) {
+        } else if (strncmp(line, "BITMAP", 6) == 0) {
+            in_bitmap = true;
+        }
+    }
+    fclose(f);
+
+    if (*ascent < 0) *ascent = bbox[1] + bbox[3];
+    return true;
+}
+
+// UTF-8 for one codepoint, as a label would spell it
+static void sim_utf8(uint32_t cp, char* out) {
+    if (cp < 0x80) {
+        *out++ = (char)cp;
+    } else if (cp < 0x800) {
+        *out++ = (char)(0xC0 | (cp >> 6));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *out++ = (char)(0xE0 | (cp >> 12));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else {
+        *out++ = (char)(0xF0 | (cp >> 18));
+        *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    }
+    *out = 0;
+}
+
+// Every glyph in the table, drawn through the cache, against the same
+// placement rules pico-font-convert uses
+static int sim_check_font_cjk(const char* bdf_path) {
+    int ascent;
+    std::vector<SimBdfGlyph> bdf;
+    if (!sim_load_bdf(bdf_path, &ascent, &bdf)) {
+        printf("font_cjk       cannot read %s MISMATCH\n", bdf_path);
+        return 1;
+    }
+
+    static Framebuffer fb;
+    int mismatches = 0;
+    font_cjk_init();
+
+    for (int g = 0; g < FONT_CJK_GLYPH_COUNT; g++) {
+        uint32_t cp = font_cjk_glyphs[g].codepoint;
+        const SimBdfGlyph* source = nullptr;
+        for (const SimBdfGlyph& candidate : bdf) {
+            if (candidate.codepoint == cp) source = &candidate;
+        }
+
+        bool ok = source != nullptr;
+        if (ok) {
+            char utf8[5];
+            FontCjkText text;
+            sim_utf8(cp, utf8);
+            font_cjk_text_set(&text, utf8);
+            fb_clear(&fb);
+            font_cjk_draw(&fb, 0, 0, &text);
+
+            // Trailing bits of each BDF row are padding to a whole byte
+            int width = source->bbx[0];
+            int row_bits = (width + 7) / 8 * 8;
+            int top = ascent - (source->bbx[3] + source->bbx[1]);
+            for (int y = 0; y < FONT_CJK_HEIGHT && ok; y++) {
+                for (int x = 0; x < FONT_CJK_ADVANCE && ok; x++) {
+                    int r = y - top;
+                    int c = x - source->bbx[2];
+                    bool expected = r >= 0 && r < (int)source->rows.size() && c >= 0 && c < width &&
+                                    ((source->rows[r] >> (row_bits - 1 - c)) & 1);
+                    ok = fb_get_pixel(&fb, x, y) == expected;
+                }
+            }
+        }
+
+        if (!ok && mismatches++ < 5) {
+            printf("  font_cjk U+%04X %s\n", cp, source ? "decodes differently" : "is not in the BDF");
+        }
+    }
+
+    printf("font_cjk       %5d glyphs, %d differ from %s %s\n", FONT_CJK_GLYPH_COUNT, mismatches,
+           strrchr(bdf_path, '/') ? strrchr(bdf_path, '/') + 1 : bdf_path, mismatches ? "MISMATCH" : "ok");
+    font_cjk_init();
+    return mismatches ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    const char* bdf_path = argc > 1 ? argv[1] : SIM_FONT_BDF;
+
+    text_benchmark();
+    gfx_benchmark();
+    font_cjk_benchmark();
+
+    printf("\n");
+    int failures = 0;
+    failures += sim_check_blit();
+    failures += sim_check_fill_rect();
+    failures += sim_check_font_cjk(bdf_path);
+
+    printf("\n%s\n", failures ? "FAILED: drawing differs from the reference"
+                              : "Fast paths match per-pixel drawing and CJK glyphs match their font");
+    return failures ? 1 : 0;
+}
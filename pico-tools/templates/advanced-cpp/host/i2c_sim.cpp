@@ -0,0 +1,506 @@
+#include "i2c_sim.h"
+#include <stdio.h>
+#include <string.h>
+#include "hardware/i2c.h"
+#include "i2c_dma.h"
+
+#define SSD1306_PAGES 8
+#define SSD1306_COLUMNS 128
+#define SSD1306_ROWS 64
+
+i2c_inst_t i2c0_inst = {0};
+i2c_inst_t i2c1_inst = {1};
+
+// SSD1306 controller state that affects RAM writes or what is shown
+struct SimPanel {
+    bool connected;
+    uint8_t bus;
+    uint8_t channel;
+    uint8_t addr;
+    uint8_t ram[SSD1306_PAGES][SSD1306_COLUMNS];
+
+    uint8_t mode;            // 0 horizontal, 1 vertical, 2 page addressing
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+    uint8_t start_line;
+    bool display_on;
+    bool inverse;
+    bool entire_on;
+    bool seg_remap;          // 0xA1: column 127 at SEG0
+    bool com_reversed;       // 0xC8: scan from COM[N-1]
+    bool scrolling;
+
+    // Decoder state for the transaction in progress
+    bool expect_control;     // Next byte is a control byte
+    bool single;             // Co = 1: one byte, then another control byte
+    bool data;               // D/C# = 1: GDDRAM data, otherwise commands
+    uint8_t cmd[8];
+    uint8_t cmd_len;
+    uint8_t cmd_need;
+};
+
+struct SimMux {
+    bool present;
+    uint8_t addr;
+    uint8_t channels;        // Control register: bit n enables channel n
+};
+
+static SimPanel sim_panels[I2C_SIM_MAX_PANELS];
+static int sim_panel_count = 0;
+static SimMux sim_mux[I2C_SIM_BUSES];
+static I2cSimStats sim_stats[I2C_SIM_BUSES];
+
+// Panels addressed in the current transaction (broadcast when several mux
+// channels are open with a panel at the same address on each)
+static SimPanel* sim_targets[I2C_SIM_MAX_PANELS];
+static int sim_target_count = 0;
+static SimMux* sim_mux_target = nullptr;
+
+static void sim_panel_power_on(SimPanel* panel) {
+    memset(panel->ram, 0, sizeof(panel->ram));
+    panel->mode = 2; // Page addressing after reset
+    panel->col_start = 0;
+    panel->col_end = SSD1306_COLUMNS - 1;
+    panel->page_start = 0;
+    panel->page_end = SSD1306_PAGES - 1;
+    panel->col = 0;
+    panel->page = 0;
+    panel->start_line = 0;
+    panel->display_on = false;
+    panel->inverse = false;
+    panel->entire_on = false;
+    panel->seg_remap = false;
+    panel->com_reversed = false;
+    panel->scrolling = false;
+}
+
+// Arguments that follow each multi-byte command
+static uint8_t sim_command_args(uint8_t cmd) {
+    switch (cmd) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+        case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22: case 0xA3:
+            return 2;
+        case 0x29: case 0x2A:
+            return 5;
+        case 0x26: case 0x27:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+static void sim_panel_execute(SimPanel* panel) {
+    const uint8_t* c = panel->cmd;
+
+    switch (c[0]) {
+        case 0x20: panel->mode = c[1] & 0x03; break;
+        case 0x21:
+            panel->col_start = c[1] & 0x7F;
+            panel->col_end = c[2] & 0x7F;
+            panel->col = panel->col_start;
+            break;
+        case 0x22:
+            panel->page_start = c[1] & 0x07;
+            panel->page_end = c[2] & 0x07;
+            panel->page = panel->page_start;
+            break;
+        case 0x26: case 0x27: case 0x29: case 0x2A: break; // Scroll setup
+        case 0x2E: panel->scrolling = false; break;
+        case 0x2F: panel->scrolling = true; break;
+        case 0xA0: case 0xA1: panel->seg_remap = c[0] & 1; break;
+        case 0xA4: case 0xA5: panel->entire_on = c[0] & 1; break;
+        case 0xA6: case 0xA7: panel->inverse = c[0] & 1; break;
+        case 0xAE: case 0xAF: panel->display_on = c[0] & 1; break;
+        case 0xC0: case 0xC8: panel->com_reversed = c[0] == 0xC8; break;
+        default:
+            if (c[0] <= 0x0F) {
+                panel->col = (panel->col & 0xF0) | c[0];          // Page mode low nibble
+            } else if (c[0] <= 0x1F) {
+                panel->col = (uint8_t)(((c[0] & 0x07) << 4) | (panel->col & 0x0F));
+            } else if (c[0] >= 0x40 && c[0] <= 0x7F) {
+                panel->start_line = c[0] & 0x3F;
+            } else if (c[0] >= 0xB0 && c[0] <= 0xB7) {
+                panel->page = c[0] & 0x07;
+            }
+            break; // Everything else (timing, charge pump, contrast) leaves RAM alone
+    }
+}
+
+static void sim_panel_command(SimPanel* panel, uint8_t byte) {
+    if (panel->cmd_len == 0) {
+        panel->cmd_need = sim_command_args(byte);
+    }
+    panel->cmd[panel->cmd_len++] = byte;
+
+    if (panel->cmd_len > panel->cmd_need) {
+        sim_panel_execute(panel);
+        panel->cmd_len = 0;
+    }
+}
+
+static void sim_panel_data(SimPanel* panel, uint8_t byte) {
+    panel->ram[panel->page & 0x07][panel->col & 0x7F] = byte;
+
+    if (panel->mode == 0) {
+        if (panel->col++ >= panel->col_end) {
+            panel->col = panel->col_start;
+            panel->page = panel->page >= panel->page_end ? panel->page_start : panel->page + 1;
+        }
+    } else if (panel->mode == 1) {
+        if (panel->page++ >= panel->page_end) {
+            panel->page = panel->page_start;
+            panel->col = panel->col >= panel->col_end ? panel->col_start : panel->col + 1;
+        }
+    } else {
+        panel->col = (panel->col + 1) & 0x7F;
+    }
+}
+
+static void sim_panel_byte(SimPanel* panel, uint8_t byte) {
+    if (panel->expect_control) {
+        panel->single = byte & 0x80;
+        panel->data = byte & 0x40;
+        panel->expect_control = false;
+        return;
+    }
+
+    if (panel->data) {
+        sim_panel_data(panel, byte);
+    } else {
+        sim_panel_command(panel, byte);
+    }
+    if (panel->single) {
+        panel->expect_control = true;
+    }
+}
+
+// START (or repeated START) plus the address byte; false on NACK
+static bool sim_begin(uint8_t bus, uint8_t addr) {
+    I2cSimStats* stats = &sim_stats[bus];
+    stats->starts++;
+    stats->transactions++;
+    stats->bytes++;
+
+    sim_target_count = 0;
+    sim_mux_target = nullptr;
+
+    SimMux* mux = &sim_mux[bus];
+    if (mux->present && mux->addr == addr) {
+        sim_mux_target = mux;
+        return true;
+    }
+
+    for (int i = 0; i < sim_panel_count; i++) {
+        SimPanel* panel = &sim_panels[i];
+        if (!panel->connected || panel->bus != bus || panel->addr != addr) continue;
+
+        bool reachable = panel->channel == I2C_SIM_DIRECT ||
+                         (mux->present && (mux->channels & (1u << panel->channel)));
+        if (!reachable) continue;
+
+        panel->expect_control = true;
+        panel->cmd_len = 0;
+        sim_targets[sim_target_count++] = panel;
+    }
+
+    if (sim_target_count == 0) {
+        stats->nacks++;
+        return false;
+    }
+    return true;
+}
+
+static void sim_write_byte(uint8_t bus, uint8_t byte) {
+    sim_stats[bus].bytes++;
+
+    if (sim_mux_target) {
+        sim_stats[bus].mux_writes++;
+        if (sim_mux_target->channels != byte) {
+            sim_stats[bus].mux_switches++;
+        }
+        sim_mux_target->channels = byte;
+        return;
+    }
+
+    for (int i = 0; i < sim_target_count; i++) {
+        sim_panel_byte(sim_targets[i], byte);
+    }
+}
+
+static void sim_end(uint8_t bus, bool nostop) {
+    // Without a STOP the bus stays claimed and the next transfer opens with
+    // a repeated START, which sim_begin() counts like any other START
+    if (!nostop) {
+        sim_stats[bus].stops++;
+    }
+}
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate) {
+    (void)i2c;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop) {
+    uint8_t bus = i2c->index;
+
+    if (!sim_begin(bus, addr)) {
+        sim_end(bus, false); // The controller sends STOP after an address NACK
+        return PICO_ERROR_GENERIC;
+    }
+    for (size_t i = 0; i < len; i++) {
+        sim_write_byte(bus, src[i]);
+    }
+    sim_end(bus, nostop);
+    return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop) {
+    uint8_t bus = i2c->index;
+
+    // Only the mux control register can be read back; panels are write-only here
+    if (!sim_begin(bus, addr) || !sim_mux_target) {
+        sim_end(bus, false);
+        return PICO_ERROR_GENERIC;
+    }
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = sim_mux_target->channels;
+        sim_stats[bus].bytes++;
+    }
+    sim_end(bus, nostop);
+    return (int)len;
+}
+
+// The DMA path as the controller runs it: a STOP flag ends a transaction and
+// the next word starts another one; a NACK aborts the rest of the stream.
+// Read words return the mux control register, or an SSD1306 status byte.
+struct SimDmaTransfer {
+    bool pending;
+    uint8_t addr;
+    const uint16_t* words;
+    size_t count;
+    uint8_t* rx;
+    size_t rx_len;
+    i2c_dma_callback_t callback;
+    void* context;
+};
+
+static SimDmaTransfer sim_dma[I2C_SIM_BUSES];
+static bool sim_dma_deferred = false;
+
+static bool sim_dma_run(uint8_t bus, const SimDmaTransfer* t) {
+    bool open = false;
+    size_t received = 0;
+
+    for (size_t i = 0; i < t->count; i++) {
+        if (!open) {
+            open = true;
+            if (!sim_begin(bus, t->addr)) {
+                sim_end(bus, false);
+                return false;
+            }
+        }
+        if (t->words[i] & I2C_DMA_READ) {
+            uint8_t byte = sim_mux_target ? sim_mux_target->channels
+                                          : (sim_targets[0]->display_on ? 0x00 : 0x40);
+            sim_stats[bus].bytes++;
+            if (received < t->rx_len) t->rx[received++] = byte;
+        } else {
+            sim_write_byte(bus, (uint8_t)t->words[i]);
+        }
+        if (t->words[i] & I2C_DMA_STOP) {
+            sim_end(bus, false);
+            open = false;
+        }
+    }
+    if (open) {
+        sim_end(bus, false); // The controller stops once its FIFO runs dry
+    }
+    return true;
+}
+
+static void sim_dma_complete(uint8_t bus) {
+    SimDmaTransfer t = sim_dma[bus];
+    sim_dma[bus].pending = false;
+
+    bool success = sim_dma_run(bus, &t);
+    if (t.callback) {
+        t.callback(success, t.context);
+    }
+}
+
+void i2c_dma_init(i2c_inst_t* i2c) {
+    (void)i2c;
+}
+
+bool i2c_dma_transfer(i2c_inst_t* i2c, uint8_t addr, const uint16_t* words, size_t count,
+                      uint8_t* rx, size_t rx_len, i2c_dma_callback_t callback, void* context) {
+    uint8_t bus = i2c->index;
+    if (count == 0 || rx_len > I2C_DMA_RX_MAX || sim_dma[bus].pending) return false;
+
+    sim_dma[bus] = {true, addr, words, count, rx, rx_len, callback, context};
+    if (!sim_dma_deferred) {
+        sim_dma_complete(bus);
+    }
+    return true;
+}
+
+bool i2c_dma_write(i2c_inst_t* i2c, uint8_t addr, const uint16_t* words, size_t count,
+                   i2c_dma_callback_t callback, void* context) {
+    return i2c_dma_transfer(i2c, addr, words, count, nullptr, 0, callback, context);
+}
+
+// In deferred mode each poll is the point where the transfer finishes
+bool i2c_dma_busy(i2c_inst_t* i2c) {
+    uint8_t bus = i2c->index;
+    if (sim_dma[bus].pending) {
+        sim_dma_complete(bus);
+    }
+    return sim_dma[bus].pending;
+}
+
+bool i2c_dma_timed_out(i2c_inst_t* i2c) {
+    (void)i2c;
+    return false;
+}
+
+void i2c_dma_wait(i2c_inst_t* i2c) {
+    while (i2c_dma_busy(i2c)) {
+    }
+}
+
+void i2c_sim_set_dma_deferred(bool deferred) {
+    sim_dma_deferred = deferred;
+}
+
+bool i2c_sim_dma_pending(uint8_t bus) {
+    return bus < I2C_SIM_BUSES && sim_dma[bus].pending;
+}
+
+void i2c_sim_reset() {
+    memset(sim_panels, 0, sizeof(sim_panels));
+    memset(sim_mux, 0, sizeof(sim_mux));
+    memset(sim_dma, 0, sizeof(sim_dma));
+    sim_panel_count = 0;
+    i2c_sim_reset_stats();
+}
+
+int i2c_sim_add_panel(uint8_t bus, uint8_t channel, uint8_t addr) {
+    if (bus >= I2C_SIM_BUSES || sim_panel_count >= I2C_SIM_MAX_PANELS) return -1;
+
+    SimPanel* panel = &sim_panels[sim_panel_count];
+    panel->bus = bus;
+    panel->channel = channel;
+    panel->addr = addr;
+    panel->connected = true;
+    sim_panel_power_on(panel);
+    return sim_panel_count++;
+}
+
+void i2c_sim_set_connected(int panel, bool connected) {
+    if (panel < 0 || panel >= sim_panel_count) return;
+
+    SimPanel* p = &sim_panels[panel];
+    if (connected && !p->connected) {
+        sim_panel_power_on(p);
+    }
+    p->connected = connected;
+}
+
+void i2c_sim_add_mux(uint8_t bus, uint8_t addr) {
+    if (bus >= I2C_SIM_BUSES) return;
+
+    sim_mux[bus].present = true;
+    sim_mux[bus].addr = addr;
+    sim_mux[bus].channels = 0x00; // All channels off after power-up
+}
+
+const I2cSimStats* i2c_sim_get_stats(uint8_t bus) {
+    if (bus >= I2C_SIM_BUSES) return nullptr;
+    return &sim_stats[bus];
+}
+
+void i2c_sim_reset_stats() {
+    memset(sim_stats, 0, sizeof(sim_stats));
+}
+
+uint64_t i2c_sim_estimate_us(const I2cSimStats* stats, uint32_t baudrate) {
+    uint64_t bits = (uint64_t)stats->bytes * 9 + stats->starts + stats->stops;
+
+    // Bus free time between STOP and the next START (tBUF), in nanoseconds
+    uint32_t free_ns = baudrate <= 100000 ? 4700 : baudrate <= 400000 ? 1300 : 500;
+
+    return bits * 1000000 / baudrate + (uint64_t)stats->stops * free_ns / 1000;
+}
+
+void i2c_sim_print_stats(uint8_t bus, const char* label) {
+    const I2cSimStats* stats = i2c_sim_get_stats(bus);
+    if (!stats) return;
+
+    printf("%-24s %7u bytes %5u START %5u STOP %4u NACK %4u mux (%u writes) | "
+           "%7lluus @100k %6lluus @400k %6lluus @1M\n",
+           label, stats->bytes, stats->starts, stats->stops, stats->nacks,
+           stats->mux_switches, stats->mux_writes,
+           (unsigned long long)i2c_sim_estimate_us(stats, 100000),
+           (unsigned long long)i2c_sim_estimate_us(stats, 400000),
+           (unsigned long long)i2c_sim_estimate_us(stats, 1000000));
+}
+
+const uint8_t* i2c_sim_panel_ram(int panel) {
+    if (panel < 0 || panel >= sim_panel_count) return nullptr;
+    return &sim_panels[panel].ram[0][0];
+}
+
+uint8_t i2c_sim_panel_start_line(int panel) {
+    if (panel < 0 || panel >= sim_panel_count) return 0;
+    return sim_panels[panel].start_line;
+}
+
+bool i2c_sim_panel_scrolling(int panel) {
+    if (panel < 0 || panel >= sim_panel_count) return false;
+    return sim_panels[panel].scrolling;
+}
+
+// Pixel at screen position (x, y), upright for the remap/scan settings the
+// display drivers use (0xA1, 0xC8)
+static bool sim_panel_pixel(const SimPanel* panel, int x, int y) {
+    if (!panel->display_on) return false;
+    if (panel->entire_on) return true;
+
+    int column = panel->seg_remap ? x : SSD1306_COLUMNS - 1 - x;
+    int row = panel->com_reversed ? y : SSD1306_ROWS - 1 - y;
+    row = (row + panel->start_line) % SSD1306_ROWS;
+
+    bool on = panel->ram[row / 8][column] & (1u << (row % 8));
+    return on != panel->inverse;
+}
+
+bool i2c_sim_dump_pgm(int panel, const char* path, int scale) {
+    if (panel < 0 || panel >= sim_panel_count || scale < 1) return false;
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    const SimPanel* p = &sim_panels[panel];
+    int width = SSD1306_COLUMNS * scale;
+    fprintf(file, "P5\n%d %d\n255\n", width, SSD1306_ROWS * scale);
+
+    uint8_t line[SSD1306_COLUMNS * 8];
+    if (width > (int)sizeof(line)) {
+        fclose(file);
+        return false;
+    }
+
+    for (int y = 0; y < SSD1306_ROWS; y++) {
+        for (int x = 0; x < width; x++) {
+            line[x] = sim_panel_pixel(p, x / scale, y) ? 255 : 0;
+        }
+        for (int s = 0; s < scale; s++) {
+            fwrite(line, 1, width, file);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
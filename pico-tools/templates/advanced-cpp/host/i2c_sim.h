@@ -0,0 +1,57 @@
+#ifndef I2C_SIM_H
+#define I2C_SIM_H
+
+#include "pico/stdlib.h"
+
+// Host model of the display buses. i2c_write_blocking(), i2c_read_blocking()
+// and the i2c_dma transfers (I2C_DMA_READ words included) all land here:
+// SSD1306 panels decode their command and data streams into panel RAM, a
+// TCA9548A routes traffic to the panels on its selected channels, and every
+// condition and byte on the wire is counted. DMA transfers complete before
+// i2c_dma_transfer() returns, or in deferred mode at the next i2c_dma_busy().
+#define I2C_SIM_BUSES 2
+#define I2C_SIM_MAX_PANELS 9
+#define I2C_SIM_DIRECT 0xFF  // Panel channel: wired to the bus, not behind the mux
+
+// Wire-level counters for one bus
+struct I2cSimStats {
+    uint32_t transactions;  // Address phases (START or repeated START)
+    uint32_t starts;        // START and repeated START conditions
+    uint32_t stops;         // STOP conditions
+    uint32_t bytes;         // Bytes clocked, address bytes included
+    uint32_t nacks;         // Address phases nobody acknowledged
+    uint32_t mux_writes;    // Writes to the TCA9548A control register
+    uint32_t mux_switches;  // ... that changed the selected channels
+};
+
+// Setup: reset removes every device and zeroes the counters
+void i2c_sim_reset();
+int i2c_sim_add_panel(uint8_t bus, uint8_t channel, uint8_t addr);  // Returns the panel index
+void i2c_sim_add_mux(uint8_t bus, uint8_t addr);
+
+// Deferred DMA: a transfer stays on the "wire" until the next poll, so
+// other work can be queued behind it as on hardware
+void i2c_sim_set_dma_deferred(bool deferred);
+bool i2c_sim_dma_pending(uint8_t bus);
+
+// Hot-plug: an unplugged panel NACKs its address; plugging it back in
+// powers it up blank and unconfigured, as a real module would
+void i2c_sim_set_connected(int panel, bool connected);
+
+// Accounting. Wire time is 9 bit times per byte plus one per START and STOP,
+// plus the bus free time the spec requires after each STOP.
+const I2cSimStats* i2c_sim_get_stats(uint8_t bus);
+void i2c_sim_reset_stats();
+uint64_t i2c_sim_estimate_us(const I2cSimStats* stats, uint32_t baudrate);
+void i2c_sim_print_stats(uint8_t bus, const char* label);
+
+// Panel state: RAM is 8 pages x 128 columns, bit n of a byte = row n
+const uint8_t* i2c_sim_panel_ram(int panel);
+uint8_t i2c_sim_panel_start_line(int panel);
+bool i2c_sim_panel_scrolling(int panel);
+
+// Writes what the panel shows (start line, inversion, on/off applied) as a
+// binary PGM, each pixel scaled to scale x scale
+bool i2c_sim_dump_pgm(int panel, const char* path, int scale);
+
+#endif // I2C_SIM_H
@@ -0,0 +1,50 @@
+#ifndef HOST_ARM_ACLE_H
+#define HOST_ARM_ACLE_H
+
+#include <stdint.h>
+
+// Host stand-in for the Armv8-M DSP intrinsics dsp_filter.cpp uses, written
+// from the instruction pseudocode so the SIMD path can be checked against
+// the portable one off target. SSUB16 leaves the GE flags for SEL.
+static uint8_t host_acle_ge;
+
+static inline int16_t host_acle_lane(int32_t x, int lane) { return (int16_t)((uint32_t)x >> (16 * lane)); }
+
+static inline int32_t __ssub16(int32_t a, int32_t b) {
+    uint32_t result = 0;
+    host_acle_ge = 0;
+    for (int lane = 0; lane < 2; lane++) {
+        int32_t diff = host_acle_lane(a, lane) - host_acle_lane(b, lane);
+        if (diff >= 0) host_acle_ge |= (uint8_t)(1u << lane);
+        result |= (uint32_t)(uint16_t)diff << (16 * lane);
+    }
+    return (int32_t)result;
+}
+
+static inline uint32_t __sel(uint32_t a, uint32_t b) {
+    uint32_t result = 0;
+    for (int lane = 0; lane < 2; lane++) {
+        uint32_t mask = 0xFFFFu << (16 * lane);
+        result |= ((host_acle_ge >> lane) & 1 ? a : b) & mask;
+    }
+    return result;
+}
+
+// Products and sum wrap at 32 bits (the Q flag is not modelled)
+static inline int32_t __smlad(int32_t a, int32_t b, int32_t acc) {
+    uint32_t sum = (uint32_t)acc + (uint32_t)(host_acle_lane(a, 0) * host_acle_lane(b, 0)) +
+                   (uint32_t)(host_acle_lane(a, 1) * host_acle_lane(b, 1));
+    return (int32_t)sum;
+}
+
+static inline int32_t __smlabb(int32_t a, int32_t b, int32_t acc) {
+    return (int32_t)((uint32_t)acc + (uint32_t)(host_acle_lane(a, 0) * host_acle_lane(b, 0)));
+}
+
+static inline int32_t __ssat(int32_t x, int bits) {
+    int32_t max = (1 << (bits - 1)) - 1;
+    int32_t min = -max - 1;
+    return x > max ? max : x < min ? min : x;
+}
+
+#endif // HOST_ARM_ACLE_H
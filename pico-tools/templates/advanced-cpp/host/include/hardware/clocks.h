@@ -0,0 +1,11 @@
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+#include "pico/stdlib.h"
+
+// Benchmarks convert microseconds to cycles with this; 150 MHz like an RP2350
+enum clock_index { clk_sys = 5 };
+
+static inline uint32_t clock_get_hz(clock_index clk) { (void)clk; return 150000000; }
+
+#endif // HOST_HARDWARE_CLOCKS_H
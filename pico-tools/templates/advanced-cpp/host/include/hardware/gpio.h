@@ -0,0 +1,18 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include "pico/stdlib.h"
+
+// Pin setup is accepted and ignored on the host; inputs read high, as
+// released lines with pull-ups would
+enum gpio_function { GPIO_FUNC_I2C = 3, GPIO_FUNC_SIO = 5 };
+#define GPIO_IN false
+#define GPIO_OUT true
+
+static inline void gpio_set_function(uint pin, gpio_function fn) { (void)pin; (void)fn; }
+static inline void gpio_pull_up(uint pin) { (void)pin; }
+static inline void gpio_set_dir(uint pin, bool out) { (void)pin; (void)out; }
+static inline void gpio_put(uint pin, bool value) { (void)pin; (void)value; }
+static inline bool gpio_get(uint pin) { (void)pin; return true; }
+
+#endif // HOST_HARDWARE_GPIO_H
@@ -0,0 +1,36 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+// Both controllers lead to the bus model in i2c_sim.cpp
+struct i2c_inst_t {
+    uint8_t index;
+};
+
+extern i2c_inst_t i2c0_inst;
+extern i2c_inst_t i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+static inline i2c_inst_t* i2c_get_instance(uint num) { return num ? i2c1 : i2c0; }
+static inline uint i2c_get_index(i2c_inst_t* i2c) { return i2c->index; }
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate);
+static inline void i2c_deinit(i2c_inst_t* i2c) { (void)i2c; }
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop);
+
+// Transfers in the model never stall, so the timeout is never reached
+static inline int i2c_write_timeout_us(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len,
+                                       bool nostop, uint timeout_us) {
+    (void)timeout_us;
+    return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+static inline int i2c_read_timeout_us(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len,
+                                      bool nostop, uint timeout_us) {
+    (void)timeout_us;
+    return i2c_read_blocking(i2c, addr, dst, len, nostop);
+}
+
+#endif // HOST_HARDWARE_I2C_H
@@ -0,0 +1,16 @@
+#ifndef HOST_HARDWARE_SPI_H
+#define HOST_HARDWARE_SPI_H
+
+#include "pico/stdlib.h"
+
+// Only the handle is needed on the host; spi_loopback.cpp stands in for spi_dma
+struct spi_inst_t {
+    uint8_t index;
+};
+
+extern spi_inst_t spi0_inst;
+extern spi_inst_t spi1_inst;
+#define spi0 (&spi0_inst)
+#define spi1 (&spi1_inst)
+
+#endif // HOST_HARDWARE_SPI_H
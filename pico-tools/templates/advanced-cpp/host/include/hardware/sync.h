@@ -0,0 +1,10 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include "pico/stdlib.h"
+
+// The model has no interrupts: transfers complete inside the calls that poll them
+static inline uint32_t save_and_disable_interrupts() { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+#endif // HOST_HARDWARE_SYNC_H
@@ -0,0 +1,27 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// Host stand-in for the pico-sdk calls the display code uses; time comes
+// from the host's monotonic clock (see pico_shim.cpp)
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define PICO_OK 0
+#define PICO_ERROR_TIMEOUT -1
+#define PICO_ERROR_GENERIC -2
+
+uint64_t time_us_64();
+uint32_t time_us_32();
+absolute_time_t get_absolute_time();
+uint32_t to_ms_since_boot(absolute_time_t t);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+static inline void tight_loop_contents() {}
+
+#include "hardware/gpio.h"
+
+#endif // HOST_PICO_STDLIB_H
@@ -0,0 +1,40 @@
+#include "pico/stdlib.h"
+#include <time.h>
+
+static uint64_t shim_boot_us = 0;
+
+static uint64_t shim_monotonic_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+uint64_t time_us_64() {
+    if (shim_boot_us == 0) {
+        shim_boot_us = shim_monotonic_us();
+    }
+    return shim_monotonic_us() - shim_boot_us;
+}
+
+uint32_t time_us_32() {
+    return (uint32_t)time_us_64();
+}
+
+absolute_time_t get_absolute_time() {
+    return time_us_64();
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+void sleep_us(uint64_t us) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(us / 1000000);
+    ts.tv_nsec = (long)(us % 1000000) * 1000;
+    nanosleep(&ts, nullptr);
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000);
+}
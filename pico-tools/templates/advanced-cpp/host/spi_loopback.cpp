@@ -0,0 +1,82 @@
+#include "spi_loopback.h"
+#include "spi_dma.h"
+#include "hardware/clocks.h"
+
+spi_inst_t spi0_inst = {0};
+spi_inst_t spi1_inst = {1};
+
+static bool loop_running = false;
+static uint16_t* loop_samples = nullptr;
+static uint32_t* loop_timestamps = nullptr;
+static uint32_t loop_mask = 0;
+static uint32_t loop_rate_hz = 0;
+static uint32_t loop_frames = 0;       // Samples written
+static uint32_t loop_advance = 0;
+
+static uint32_t loop_timestamp(uint32_t frame) {
+    return frame * spi_loopback_period_us();
+}
+
+bool spi_dma_stream_start(spi_inst_t* spi, uint32_t rate_hz, uint16_t command,
+                          uint16_t* samples, uint32_t* timestamps, uint8_t order) {
+    (void)spi;
+    (void)command;
+    if (loop_running || rate_hz == 0) return false;
+
+    // Same rounding as the DMA timer on target
+    uint32_t divider = clock_get_hz(clk_sys) / rate_hz;
+    if (divider < 1) divider = 1;
+    if (divider > 0xFFFF) divider = 0xFFFF;
+    loop_rate_hz = clock_get_hz(clk_sys) / divider;
+
+    loop_samples = samples;
+    loop_timestamps = timestamps;
+    loop_mask = (1u << order) - 1;
+    loop_frames = 0;
+    loop_advance = 0;
+    loop_running = true;
+
+    // Timestamps for the frames already queued behind the first one
+    for (uint32_t f = 0; f < SPI_LOOPBACK_LEAD; f++) {
+        loop_timestamps[f & loop_mask] = loop_timestamp(f);
+    }
+    return true;
+}
+
+void spi_dma_stream_stop() {
+    loop_running = false;
+}
+
+void spi_loopback_run(uint32_t frames) {
+    if (!loop_running) return;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        uint32_t f = loop_frames;
+        loop_timestamps[(f + SPI_LOOPBACK_LEAD) & loop_mask] = loop_timestamp(f + SPI_LOOPBACK_LEAD);
+        loop_samples[f & loop_mask] = (uint16_t)f;
+        loop_frames++;
+    }
+}
+
+void spi_loopback_set_advance_per_poll(uint32_t frames) {
+    loop_advance = frames;
+}
+
+uint32_t spi_loopback_period_us() {
+    return loop_rate_hz ? 1000000 / loop_rate_hz : 0;
+}
+
+uint32_t spi_dma_stream_frames() {
+    if (!loop_running) return 0;
+
+    spi_loopback_run(loop_advance);
+    return loop_frames;
+}
+
+uint32_t spi_dma_stream_rate_hz() {
+    return loop_rate_hz;
+}
+
+uint32_t spi_dma_stream_restarts() {
+    return 0;
+}
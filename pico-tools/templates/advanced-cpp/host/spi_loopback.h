@@ -0,0 +1,23 @@
+#ifndef SPI_LOOPBACK_H
+#define SPI_LOOPBACK_H
+
+#include "pico/stdlib.h"
+
+// Host stand-in for spi_dma. Nothing runs by itself: spi_loopback_run()
+// plays the DMA for a number of frames. Each frame reads back its own frame
+// number (low 16 bits), as a counting test device on the loopback would, and
+// its timestamp is frame * period, so order, gaps and mismatched
+// sample/timestamp pairs all show in the data. Timestamps are written
+// SPI_LOOPBACK_LEAD frames ahead of the samples, as the timer-paced channel
+// runs ahead of RX on target.
+#define SPI_LOOPBACK_LEAD 9  // TX FIFO depth plus the frame on the wire
+
+void spi_loopback_run(uint32_t frames);
+
+// DMA progress between two polls of spi_dma_stream_frames(), e.g. while
+// the consumer copies a batch out
+void spi_loopback_set_advance_per_poll(uint32_t frames);
+
+uint32_t spi_loopback_period_us();
+
+#endif // SPI_LOOPBACK_H
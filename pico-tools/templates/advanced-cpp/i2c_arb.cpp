@@ -0,0 +1,375 @@
+#include "i2c_arb.h"
+#include <stdio.h>
+#include "hardware/sync.h"
+#include "i2c_dma.h"
+#include "i2c_health.h"
+
+#define ARB_MUX_UNKNOWN -1  // Control register state after a failure or a write we did not make
+
+struct ArbBus {
+    i2c_inst_t* i2c;
+    bool has_mux;
+    uint8_t mux_addr;
+    int mux_device;
+    volatile int16_t mux_mask;           // Control register as last written
+
+    // One FIFO per class; a transaction stays at the head until it completes
+    I2cTransaction* head[I2C_PRIO_CLASSES];
+    I2cTransaction* tail[I2C_PRIO_CLASSES];
+    I2cTransaction* volatile active;     // Owns the select or chunk on the wire
+    I2cTransaction* cut;                 // Stopped mid-stream at the last chunk boundary
+    size_t chunk_end;
+    uint16_t select_word;                // DMA source for a mux select
+    volatile uint8_t locks;
+    bool kicking;
+    bool kick_again;
+    I2cArbStats stats;
+};
+
+static ArbBus arb_buses[I2C_ARB_MAX_BUSES];
+
+static const char* const arb_class_names[I2C_PRIO_CLASSES] = {"sensor", "display", "background"};
+
+static ArbBus* arb_bus(i2c_inst_t* i2c) {
+    ArbBus* bus = &arb_buses[i2c_get_index(i2c)];
+    return bus->i2c ? bus : nullptr;
+}
+
+// Control register value needed for channel (-1: leave the mux alone).
+// False if the channel sits behind a mux that is offline.
+static bool arb_mux_target(ArbBus* bus, uint8_t addr, uint8_t channel, int* mask) {
+    *mask = -1;
+    if (!bus->has_mux || channel == I2C_ARB_ANY || addr == bus->mux_addr) return true;
+
+    if (bus->mux_device >= 0 && !i2c_health_online(bus->mux_device)) {
+        // Whatever it held is gone; with no mux answering, nothing behind it
+        // is on the bus, which is all a direct device needs
+        bus->mux_mask = ARB_MUX_UNKNOWN;
+        return channel == I2C_ARB_DIRECT;
+    }
+
+    *mask = channel == I2C_ARB_DIRECT ? 0x00 : (1 << (channel & 0x07));
+    return true;
+}
+
+static int arb_result(ArbBus* bus, bool success) {
+    if (success) return PICO_OK;
+    return i2c_dma_timed_out(bus->i2c) ? PICO_ERROR_TIMEOUT : PICO_ERROR_GENERIC;
+}
+
+static void arb_start(ArbBus* bus);
+
+// Starts the next transfer unless one is on the wire. A transfer that
+// completes inside arb_start() (and its callbacks) lands back here, so
+// the loop picks up where the nested call left off.
+static void arb_kick(ArbBus* bus) {
+    uint32_t interrupts = save_and_disable_interrupts();
+    if (bus->kicking) {
+        bus->kick_again = true;
+    } else {
+        bus->kicking = true;
+        do {
+            bus->kick_again = false;
+            arb_start(bus);
+        } while (bus->kick_again);
+        bus->kicking = false;
+    }
+    restore_interrupts(interrupts);
+}
+
+static void arb_finish(ArbBus* bus, int result) {
+    I2cTransaction* txn = bus->active;
+    I2cArbClassStats* cls = &bus->stats.classes[txn->priority];
+
+    bus->head[txn->priority] = txn->next;
+    if (!txn->next) bus->tail[txn->priority] = nullptr;
+    bus->active = nullptr;
+    if (bus->cut == txn) bus->cut = nullptr;
+
+    cls->depth--;
+    cls->transactions++;
+    if (result != PICO_OK) cls->failures++;
+
+    // Cleared first so the callback can queue the same transaction again
+    txn->queued = false;
+    if (txn->callback) {
+        txn->callback(txn, result, txn->context);
+    }
+    arb_kick(bus);
+}
+
+// Cut after the last STOP that fits in a chunk, or after the first one past
+// it when a single I2C transaction is longer; reads are never split
+static size_t arb_chunk_end(const I2cTransaction* txn) {
+    size_t limit = txn->offset + I2C_ARB_CHUNK_WORDS;
+    if (txn->rx_len > 0 || limit >= txn->count) return txn->count;
+
+    for (size_t i = limit; i > txn->offset; i--) {
+        if (txn->words[i - 1] & I2C_DMA_STOP) return i;
+    }
+    for (size_t i = limit; i < txn->count; i++) {
+        if (txn->words[i] & I2C_DMA_STOP) return i + 1;
+    }
+    return txn->count;
+}
+
+static void arb_chunk_complete(bool success, void* context) {
+    ArbBus* bus = (ArbBus*)context;
+    I2cTransaction* txn = bus->active;
+
+    // A write to the mux itself, or a transfer abandoned mid-byte, leaves
+    // the control register unknown
+    if ((bus->has_mux && txn->addr == bus->mux_addr) || (!success && i2c_dma_timed_out(bus->i2c))) {
+        bus->mux_mask = ARB_MUX_UNKNOWN;
+    }
+
+    if (!success) {
+        arb_finish(bus, arb_result(bus, false));
+        return;
+    }
+
+    txn->offset = bus->chunk_end;
+    if (txn->offset >= txn->count) {
+        arb_finish(bus, PICO_OK);
+        return;
+    }
+
+    bus->cut = txn;
+    bus->active = nullptr;
+    arb_kick(bus);
+}
+
+static void arb_send_chunk(ArbBus* bus) {
+    I2cTransaction* txn = bus->active;
+    size_t end = arb_chunk_end(txn);
+    bool last = end == txn->count;
+
+    bus->chunk_end = end;
+    bus->stats.classes[txn->priority].chunks++;
+
+    if (!i2c_dma_transfer(bus->i2c, txn->addr, txn->words + txn->offset, end - txn->offset,
+                          last ? txn->rx : nullptr, last ? txn->rx_len : 0, arb_chunk_complete, bus)) {
+        arb_finish(bus, PICO_ERROR_GENERIC);
+    }
+}
+
+static void arb_count_select(ArbBus* bus, int mask) {
+    bus->stats.mux_switches++;
+    if (mask != 0 && (mask & (mask - 1)) == 0) {
+        bus->stats.channel_selects[__builtin_ctz((uint)mask)]++;
+    }
+}
+
+static void arb_select_complete(bool success, void* context) {
+    ArbBus* bus = (ArbBus*)context;
+    int result = arb_result(bus, success);
+
+    if (bus->mux_device >= 0) {
+        i2c_health_report(bus->mux_device, result);
+    }
+    if (!success) {
+        bus->mux_mask = ARB_MUX_UNKNOWN;
+        arb_finish(bus, result);
+        return;
+    }
+
+    bus->mux_mask = (int16_t)(bus->select_word & 0xFF);
+    arb_count_select(bus, bus->mux_mask);
+    arb_send_chunk(bus);
+}
+
+static void arb_start(ArbBus* bus) {
+    if (bus->active || bus->locks) return;
+
+    I2cTransaction* txn = nullptr;
+    for (int p = 0; p < I2C_PRIO_CLASSES && !txn; p++) {
+        txn = bus->head[p];
+    }
+    if (!txn) return;
+
+    // A higher class arrived while a stream was between chunks
+    if (bus->cut && bus->cut != txn) {
+        bus->stats.classes[bus->cut->priority].preemptions++;
+        bus->cut = nullptr;
+    }
+
+    bus->active = txn;
+    if (!txn->started) {
+        txn->started = true;
+        I2cArbClassStats* cls = &bus->stats.classes[txn->priority];
+        cls->last_wait_us = time_us_32() - txn->submit_us;
+        if (cls->last_wait_us > cls->max_wait_us) {
+            cls->max_wait_us = cls->last_wait_us;
+        }
+    }
+
+    int mask;
+    if (!arb_mux_target(bus, txn->addr, txn->channel, &mask)) {
+        arb_finish(bus, PICO_ERROR_GENERIC);
+        return;
+    }
+
+    if (mask >= 0 && mask != bus->mux_mask) {
+        bus->select_word = (uint16_t)mask | I2C_DMA_STOP;
+        if (!i2c_dma_write(bus->i2c, bus->mux_addr, &bus->select_word, 1, arb_select_complete, bus)) {
+            arb_finish(bus, PICO_ERROR_GENERIC);
+        }
+        return;
+    }
+
+    arb_send_chunk(bus);
+}
+
+void i2c_arb_add_bus(i2c_inst_t* i2c) {
+    ArbBus* bus = &arb_buses[i2c_get_index(i2c)];
+    if (bus->i2c) return;
+
+    i2c_dma_init(i2c);
+    bus->mux_device = -1;
+    bus->mux_mask = ARB_MUX_UNKNOWN;
+    bus->i2c = i2c;
+}
+
+void i2c_arb_add_mux(i2c_inst_t* i2c, uint8_t addr, int device) {
+    i2c_arb_add_bus(i2c);
+
+    ArbBus* bus = arb_bus(i2c);
+    bus->has_mux = true;
+    bus->mux_addr = addr;
+    bus->mux_device = device;
+    bus->mux_mask = ARB_MUX_UNKNOWN;
+}
+
+bool i2c_arb_submit(I2cTransaction* txn) {
+    ArbBus* bus = arb_bus(txn->i2c);
+    if (!bus || txn->queued || txn->count == 0) return false;
+    if (txn->priority >= I2C_PRIO_CLASSES || txn->rx_len > I2C_ARB_MAX_READ) return false;
+
+    txn->next = nullptr;
+    txn->started = false;
+    txn->offset = 0;
+    txn->submit_us = time_us_32();
+
+    uint32_t interrupts = save_and_disable_interrupts();
+    I2cArbClassStats* cls = &bus->stats.classes[txn->priority];
+    if (bus->tail[txn->priority]) {
+        bus->tail[txn->priority]->next = txn;
+    } else {
+        bus->head[txn->priority] = txn;
+    }
+    bus->tail[txn->priority] = txn;
+    txn->queued = true;
+
+    if (++cls->depth > cls->max_depth) {
+        cls->max_depth = cls->depth;
+    }
+    restore_interrupts(interrupts);
+
+    arb_kick(bus);
+    return true;
+}
+
+bool i2c_arb_pending(const I2cTransaction* txn) {
+    if (!txn->queued) return false;
+
+    // A transfer past its deadline is abandoned (and completed) in here
+    i2c_dma_busy(txn->i2c);
+    return txn->queued;
+}
+
+void i2c_arb_wait(const I2cTransaction* txn) {
+    while (i2c_arb_pending(txn)) {
+        tight_loop_contents();
+    }
+}
+
+bool i2c_arb_lock(i2c_inst_t* i2c, uint8_t addr, uint8_t channel) {
+    ArbBus* bus = arb_bus(i2c);
+    if (!bus) return true;
+
+    uint32_t start = time_us_32();
+    uint32_t interrupts = save_and_disable_interrupts();
+    bus->locks++;
+    restore_interrupts(interrupts);
+
+    // The select or chunk on the wire finishes; nothing new starts after it
+    while (bus->active) {
+        i2c_dma_busy(i2c);
+        tight_loop_contents();
+    }
+
+    uint32_t waited = time_us_32() - start;
+    bus->stats.locks++;
+    if (waited > bus->stats.max_lock_wait_us) {
+        bus->stats.max_lock_wait_us = waited;
+    }
+
+    // The caller may write the control register itself
+    if (bus->has_mux && addr == bus->mux_addr) {
+        bus->mux_mask = ARB_MUX_UNKNOWN;
+    }
+
+    int mask;
+    bool reachable = arb_mux_target(bus, addr, channel, &mask);
+    if (reachable && mask >= 0 && mask != bus->mux_mask) {
+        uint8_t control = (uint8_t)mask;
+        int result = i2c_write_timeout_us(i2c, bus->mux_addr, &control, 1, false, I2C_HEALTH_TIMEOUT_US(1));
+        if (bus->mux_device >= 0) {
+            i2c_health_report(bus->mux_device, result);
+        }
+
+        reachable = result >= 0;
+        bus->mux_mask = reachable ? (int16_t)mask : ARB_MUX_UNKNOWN;
+        if (reachable) arb_count_select(bus, mask);
+    }
+
+    if (!reachable) {
+        i2c_arb_unlock(i2c);
+        return false;
+    }
+    return true;
+}
+
+void i2c_arb_unlock(i2c_inst_t* i2c) {
+    ArbBus* bus = arb_bus(i2c);
+    if (!bus) return;
+
+    uint32_t interrupts = save_and_disable_interrupts();
+    if (bus->locks > 0) bus->locks--;
+    restore_interrupts(interrupts);
+
+    arb_kick(bus);
+}
+
+void i2c_arb_service() {
+    for (int b = 0; b < I2C_ARB_MAX_BUSES; b++) {
+        ArbBus* bus = &arb_buses[b];
+        if (bus->i2c && bus->active) {
+            i2c_dma_busy(bus->i2c);
+        }
+    }
+}
+
+const I2cArbStats* i2c_arb_get_stats(i2c_inst_t* i2c) {
+    ArbBus* bus = arb_bus(i2c);
+    return bus ? &bus->stats : nullptr;
+}
+
+void i2c_arb_print_stats() {
+    for (int b = 0; b < I2C_ARB_MAX_BUSES; b++) {
+        const ArbBus* bus = &arb_buses[b];
+        if (!bus->i2c) continue;
+
+        printf("I2C arbiter i2c%d: %u mux switches, %u blocking sections (longest wait %uus)\n",
+               b, bus->stats.mux_switches, bus->stats.locks, bus->stats.max_lock_wait_us);
+        for (int p = 0; p < I2C_PRIO_CLASSES; p++) {
+            const I2cArbClassStats* cls = &bus->stats.classes[p];
+            if (cls->transactions == 0 && cls->depth == 0) continue;
+
+            printf("  %-10s %6u transactions (%u failed) in %u chunks, %u preempted, "
+                   "queue depth max %u, wait %uus (max %uus)\n",
+                   arb_class_names[p], cls->transactions, cls->failures, cls->chunks, cls->preemptions,
+                   cls->max_depth, cls->last_wait_us, cls->max_wait_us);
+        }
+    }
+}
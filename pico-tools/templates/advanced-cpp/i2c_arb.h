@@ -0,0 +1,108 @@
+#ifndef I2C_ARB_H
+#define I2C_ARB_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "i2c_dma.h"
+
+// Transaction arbiter for the DMA-driven I2C buses. Drivers queue
+// transactions (i2c_dma word streams) in a priority class instead of
+// starting DMA themselves. The highest class always goes next, and long
+// streams go out in chunks that end on a STOP, so a sensor read waits for
+// at most one chunk of a framebuffer write, not the whole frame. Each
+// transaction names the TCA9548A channel it needs; the arbiter switches the
+// mux in front of it. Blocking SDK transfers take the bus between chunks
+// with i2c_arb_lock().
+//
+// A stream may be interrupted at any STOP, so nothing else may move a
+// target's state between two of its transactions (true for the SSD1306
+// window streams: only their owner sets the panel's address pointers).
+#define I2C_ARB_MAX_BUSES 2
+#define I2C_ARB_CHUNK_WORDS 160  // Longest chunk that can hold off a higher class (one full-width window fits)
+#define I2C_ARB_MAX_READ I2C_DMA_RX_MAX  // Bytes a transaction can read back; never split
+#define I2C_ARB_MUX_CHANNELS 8  // TCA9548A
+
+// Mux channel a transaction needs: 0-7, or
+#define I2C_ARB_DIRECT 0xFF  // Device wired to the bus itself: every mux channel closed
+#define I2C_ARB_ANY 0xFE     // Leave the mux as it is
+
+enum I2cPriority : uint8_t {
+    I2C_PRIO_SENSOR,      // Short, latency-critical triggers and reads
+    I2C_PRIO_DISPLAY,     // Framebuffer streams, sent in chunks
+    I2C_PRIO_BACKGROUND,  // Bus scans
+    I2C_PRIO_CLASSES
+};
+
+struct I2cTransaction;
+
+// Called from IRQ context with PICO_OK, PICO_ERROR_TIMEOUT or
+// PICO_ERROR_GENERIC; the transaction can be submitted again from here
+typedef void (*i2c_arb_callback_t)(I2cTransaction* txn, int result, void* context);
+
+struct I2cTransaction {
+    // Filled in by the caller
+    i2c_inst_t* i2c;
+    uint8_t addr;
+    uint8_t channel;
+    I2cPriority priority;
+    const uint16_t* words;     // IC_DATA_CMD stream as for i2c_dma_write(); owned until the callback
+    size_t count;
+    uint8_t* rx;               // Bytes clocked in by I2C_DMA_READ words (nullptr: dropped)
+    uint8_t rx_len;
+    i2c_arb_callback_t callback;
+    void* context;
+
+    // Arbiter state
+    I2cTransaction* next;
+    volatile bool queued;      // Submitted, callback not run yet
+    bool started;              // Has had the bus at least once
+    size_t offset;             // Words already on the wire
+    uint32_t submit_us;
+};
+
+// Per priority class on one bus
+struct I2cArbClassStats {
+    uint32_t transactions;   // Completed, successfully or not
+    uint32_t failures;
+    uint32_t chunks;         // DMA transfers, mux selects not included
+    uint32_t preemptions;    // Times a partly sent transaction was set aside for a higher class
+    uint32_t depth;          // Queued now, the one on the wire included
+    uint32_t max_depth;
+    uint32_t last_wait_us;   // Submit to first byte on the wire
+    uint32_t max_wait_us;
+};
+
+struct I2cArbStats {
+    uint32_t mux_switches;       // Mux control writes made for a transaction or lock
+    uint32_t channel_selects[I2C_ARB_MUX_CHANNELS];  // ... that opened just this channel
+    uint32_t locks;              // Blocking sections
+    uint32_t max_lock_wait_us;   // ... longest wait for the chunk on the wire
+    I2cArbClassStats classes[I2C_PRIO_CLASSES];
+};
+
+// Setup: i2c_dma_init() is done here. device is the mux's i2c_health entry
+// (-1 if none); select results are reported to it.
+void i2c_arb_add_bus(i2c_inst_t* i2c);
+void i2c_arb_add_mux(i2c_inst_t* i2c, uint8_t addr, int device);
+
+// Queue a transaction; false if the bus has no arbiter or txn is still queued
+bool i2c_arb_submit(I2cTransaction* txn);
+
+// Polling enforces the DMA deadline, like i2c_dma_busy()
+bool i2c_arb_pending(const I2cTransaction* txn);
+void i2c_arb_wait(const I2cTransaction* txn);
+
+// Blocking SDK transfers to addr: waits for the chunk on the wire, holds
+// the queue and selects channel. False (and not locked) if the mux did not
+// answer. Locks nest; buses without an arbiter always succeed.
+bool i2c_arb_lock(i2c_inst_t* i2c, uint8_t addr, uint8_t channel);
+void i2c_arb_unlock(i2c_inst_t* i2c);
+
+// Call from the main loop: applies transfer deadlines
+void i2c_arb_service();
+
+// Statistics
+const I2cArbStats* i2c_arb_get_stats(i2c_inst_t* i2c);
+void i2c_arb_print_stats();
+
+#endif // I2C_ARB_H
@@ -0,0 +1,165 @@
+#include "i2c_dma.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+// Per-controller transfer state (index 0 = i2c0, 1 = i2c1)
+struct I2cDmaState {
+    i2c_inst_t* i2c;
+    int dma_channel;
+    volatile bool busy;
+    volatile bool timed_out;
+    uint32_t deadline_us;
+    uint8_t* rx;
+    size_t rx_len;
+    i2c_dma_callback_t callback;
+    void* context;
+};
+
+static I2cDmaState i2c_dma_state[2] = {
+    {nullptr, -1, false, false, 0, nullptr, 0, nullptr, nullptr},
+    {nullptr, -1, false, false, 0, nullptr, 0, nullptr, nullptr}
+};
+
+static void i2c_dma_finish(I2cDmaState* state, bool success) {
+    i2c_hw_t* hw = i2c_get_hw(state->i2c);
+    hw->intr_mask = 0;
+    state->busy = false;
+
+    // Bytes the stream read are still in the RX FIFO
+    if (success && state->rx) {
+        for (size_t i = 0; i < state->rx_len && hw->rxflr; i++) {
+            state->rx[i] = (uint8_t)hw->data_cmd;
+        }
+    }
+
+    if (state->callback) {
+        state->callback(success, state->context);
+    }
+}
+
+static void i2c_dma_handle_irq(I2cDmaState* state) {
+    i2c_hw_t* hw = i2c_get_hw(state->i2c);
+    uint32_t status = hw->intr_stat;
+
+    if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        // NACK or arbitration loss: the controller has flushed its FIFO,
+        // stop feeding it and release the abort state
+        dma_channel_abort(state->dma_channel);
+        (void)hw->clr_tx_abrt;
+        (void)hw->clr_stop_det;
+        i2c_dma_finish(state, false);
+        return;
+    }
+
+    if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        (void)hw->clr_stop_det;
+
+        // Every embedded STOP raises this; only the last one ends the transfer
+        if (!dma_channel_is_busy(state->dma_channel) &&
+            hw->txflr == 0 &&
+            !(hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS)) {
+            i2c_dma_finish(state, true);
+        }
+    }
+}
+
+// A target stretching SCL (or a bus held low) never lets the stream finish:
+// stop feeding the controller and disable it; the next write re-enables it
+static void i2c_dma_timeout(I2cDmaState* state) {
+    uint32_t interrupts = save_and_disable_interrupts();
+    if (state->busy) {
+        dma_channel_abort(state->dma_channel);
+        i2c_get_hw(state->i2c)->enable = 0;
+        state->timed_out = true;
+        i2c_dma_finish(state, false);
+    }
+    restore_interrupts(interrupts);
+}
+
+static void i2c0_dma_irq_handler() {
+    i2c_dma_handle_irq(&i2c_dma_state[0]);
+}
+
+static void i2c1_dma_irq_handler() {
+    i2c_dma_handle_irq(&i2c_dma_state[1]);
+}
+
+void i2c_dma_init(i2c_inst_t* i2c) {
+    uint index = i2c_get_index(i2c);
+    I2cDmaState* state = &i2c_dma_state[index];
+    if (state->dma_channel >= 0) return;
+
+    state->i2c = i2c;
+    state->dma_channel = dma_claim_unused_channel(true);
+
+    // 16-bit words: data byte plus the STOP flag, straight into IC_DATA_CMD
+    dma_channel_config config = dma_channel_get_default_config(state->dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, i2c_get_dreq(i2c, true));
+    dma_channel_configure(state->dma_channel, &config, &i2c_get_hw(i2c)->data_cmd,
+                          nullptr, 0, false);
+
+    uint irq = I2C0_IRQ + index;
+    irq_set_exclusive_handler(irq, index == 0 ? i2c0_dma_irq_handler : i2c1_dma_irq_handler);
+    irq_set_enabled(irq, true);
+}
+
+bool i2c_dma_write(i2c_inst_t* i2c, uint8_t addr, const uint16_t* words, size_t count,
+                   i2c_dma_callback_t callback, void* context) {
+    return i2c_dma_transfer(i2c, addr, words, count, nullptr, 0, callback, context);
+}
+
+bool i2c_dma_transfer(i2c_inst_t* i2c, uint8_t addr, const uint16_t* words, size_t count,
+                      uint8_t* rx, size_t rx_len, i2c_dma_callback_t callback, void* context) {
+    I2cDmaState* state = &i2c_dma_state[i2c_get_index(i2c)];
+    if (state->dma_channel < 0 || state->busy || count == 0 || rx_len > I2C_DMA_RX_MAX) return false;
+
+    i2c_hw_t* hw = i2c_get_hw(i2c);
+
+    // Target address can only change while the controller is disabled
+    hw->enable = 0;
+    hw->tar = addr;
+    hw->enable = 1;
+
+    (void)hw->clr_stop_det;
+    (void)hw->clr_tx_abrt;
+
+    // Bytes left from an earlier stream's I2C_DMA_READ words are not
+    // wanted; drop them before the RX FIFO fills and the controller holds the bus
+    while (hw->rxflr) {
+        (void)hw->data_cmd;
+    }
+
+    state->busy = true;
+    state->timed_out = false;
+    state->deadline_us = time_us_32() + I2C_DMA_TIMEOUT_US(count);
+    state->rx = rx;
+    state->rx_len = rx_len;
+    state->callback = callback;
+    state->context = context;
+
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    dma_channel_transfer_from_buffer_now(state->dma_channel, words, count);
+    return true;
+}
+
+bool i2c_dma_busy(i2c_inst_t* i2c) {
+    I2cDmaState* state = &i2c_dma_state[i2c_get_index(i2c)];
+    if (state->busy && (int32_t)(time_us_32() - state->deadline_us) > 0) {
+        i2c_dma_timeout(state);
+    }
+    return state->busy;
+}
+
+void i2c_dma_wait(i2c_inst_t* i2c) {
+    while (i2c_dma_busy(i2c)) {
+        tight_loop_contents();
+    }
+}
+
+bool i2c_dma_timed_out(i2c_inst_t* i2c) {
+    return i2c_dma_state[i2c_get_index(i2c)].timed_out;
+}
@@ -0,0 +1,36 @@
+#ifndef I2C_DMA_H
+#define I2C_DMA_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+// Non-blocking I2C transmit: DMA feeds the controller's TX FIFO with
+// 16-bit IC_DATA_CMD words, so STOP bits can be embedded in the stream
+// and several transactions go out back to back from one buffer.
+#define I2C_DMA_STOP 0x0200 // I2C_IC_DATA_CMD_STOP_BITS
+#define I2C_DMA_READ 0x0100 // I2C_IC_DATA_CMD_CMD_BITS: clock a byte in
+#define I2C_DMA_RX_MAX 16   // Bytes read back per transfer: they wait in the RX FIFO
+
+// A transfer still running after this long (well past 100kHz byte times)
+// is abandoned: i2c_dma_busy() stops the DMA, disables the controller and
+// completes it as failed, so waiting on a stuck bus is always bounded
+#define I2C_DMA_TIMEOUT_US(words) (2000u + (uint32_t)(words) * 100u)
+
+// Called from IRQ context once the last STOP has gone out (or on NACK or timeout)
+typedef void (*i2c_dma_callback_t)(bool success, void* context);
+
+// Setup (claims a DMA channel and the controller's IRQ)
+void i2c_dma_init(i2c_inst_t* i2c);
+
+// Transfer control
+bool i2c_dma_write(i2c_inst_t* i2c, uint8_t addr, const uint16_t* words, size_t count,
+                   i2c_dma_callback_t callback, void* context);
+// As i2c_dma_write(), and the first rx_len bytes clocked in by I2C_DMA_READ
+// words are copied to rx before the callback (only on success)
+bool i2c_dma_transfer(i2c_inst_t* i2c, uint8_t addr, const uint16_t* words, size_t count,
+                      uint8_t* rx, size_t rx_len, i2c_dma_callback_t callback, void* context);
+bool i2c_dma_busy(i2c_inst_t* i2c);
+void i2c_dma_wait(i2c_inst_t* i2c);
+bool i2c_dma_timed_out(i2c_inst_t* i2c);  // Last transfer ended by its deadline
+
+#endif // I2C_DMA_H
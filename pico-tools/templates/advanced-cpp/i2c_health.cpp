@@ -0,0 +1,329 @@
+#include "i2c_health.h"
+#include <stdio.h>
+#include "hardware/gpio.h"
+#include "i2c_arb.h"
+#include "i2c_dma.h"
+#include "i2c_scan.h"
+
+struct I2cHealthBus {
+    i2c_inst_t* i2c;
+    uint pin_sda;
+    uint pin_scl;
+    uint baudrate;
+    volatile bool recovery_pending;  // Set on a timeout, run from the service
+    I2cBusStats stats;
+};
+
+struct I2cHealthDevice {
+    i2c_inst_t* i2c;
+    uint8_t addr;
+    const char* name;
+    I2cProbe probe;
+    i2c_health_callback_t callback;
+    void* context;
+
+    // Written from IRQ context by i2c_health_report()
+    volatile bool online;
+    volatile bool notify_pending;   // Went offline; callback not run yet
+    volatile uint8_t failures;      // Consecutive failed transfers
+    volatile uint32_t offline_since_ms;
+
+    uint32_t next_probe_ms;
+    uint32_t probe_interval_ms;
+    I2cDeviceStats stats;
+};
+
+static I2cHealthBus health_buses[I2C_HEALTH_MAX_BUSES];
+static I2cHealthDevice health_devices[I2C_HEALTH_MAX_DEVICES];
+static int health_device_count = 0;
+static int health_next_probe = 0;   // Round-robin start for re-probes
+
+static uint32_t health_now_ms() {
+    return (uint32_t)(time_us_64() / 1000);
+}
+
+static I2cHealthBus* health_bus(i2c_inst_t* i2c) {
+    I2cHealthBus* bus = &health_buses[i2c_get_index(i2c)];
+    return bus->i2c ? bus : nullptr;
+}
+
+static bool health_valid(int device) {
+    return device >= 0 && device < health_device_count;
+}
+
+static void health_mark_offline(I2cHealthDevice* dev) {
+    uint32_t now = health_now_ms();
+    dev->online = false;
+    dev->offline_since_ms = now;
+    dev->probe_interval_ms = I2C_HEALTH_PROBE_MIN_MS;
+    dev->next_probe_ms = now + I2C_HEALTH_PROBE_MIN_MS;
+}
+
+// Registered devices sit on the bus itself; behind a mux, every channel is
+// closed first so a panel on a channel cannot answer for them
+static bool health_lock(I2cHealthDevice* dev) {
+    return i2c_arb_lock(dev->i2c, dev->addr, I2C_ARB_DIRECT);
+}
+
+static int health_send_probe(I2cHealthDevice* dev) {
+    if (!health_lock(dev)) return PICO_ERROR_GENERIC;
+
+    int result;
+    if (dev->probe == I2C_PROBE_READ) {
+        uint8_t data;
+        result = i2c_read_timeout_us(dev->i2c, dev->addr, &data, 1, false, I2C_HEALTH_TIMEOUT_US(1));
+    } else {
+        uint8_t control = 0x00; // Empty command stream
+        result = i2c_write_timeout_us(dev->i2c, dev->addr, &control, 1, false, I2C_HEALTH_TIMEOUT_US(1));
+    }
+
+    i2c_arb_unlock(dev->i2c);
+    return result;
+}
+
+void i2c_health_add_bus(i2c_inst_t* i2c, uint pin_sda, uint pin_scl, uint baudrate) {
+    I2cHealthBus* bus = &health_buses[i2c_get_index(i2c)];
+    bus->i2c = i2c;
+    bus->pin_sda = pin_sda;
+    bus->pin_scl = pin_scl;
+    bus->baudrate = baudrate;
+}
+
+int i2c_health_add_device(i2c_inst_t* i2c, uint8_t addr, const char* name, I2cProbe probe,
+                          i2c_health_callback_t callback, void* context) {
+    if (health_device_count >= I2C_HEALTH_MAX_DEVICES) return -1;
+
+    I2cHealthDevice* dev = &health_devices[health_device_count];
+    dev->i2c = i2c;
+    dev->addr = addr;
+    dev->name = name;
+    dev->probe = probe;
+    dev->callback = callback;
+    dev->context = context;
+    dev->online = true;
+    return health_device_count++;
+}
+
+bool i2c_health_probe(int device) {
+    if (!health_valid(device)) return false;
+
+    I2cHealthDevice* dev = &health_devices[device];
+    if (health_send_probe(dev) >= 0) {
+        dev->online = true;
+        dev->failures = 0;
+        return true;
+    }
+
+    // Absent at boot: probed in the background like any offline device
+    health_mark_offline(dev);
+    return false;
+}
+
+bool i2c_health_online(int device) {
+    return health_valid(device) && health_devices[device].online;
+}
+
+i2c_inst_t* i2c_health_get_bus(int device) {
+    return health_valid(device) ? health_devices[device].i2c : nullptr;
+}
+
+uint8_t i2c_health_get_address(int device) {
+    return health_valid(device) ? health_devices[device].addr : 0;
+}
+
+int i2c_health_write(int device, const uint8_t* src, size_t len, bool nostop) {
+    if (!i2c_health_online(device)) return PICO_ERROR_GENERIC;
+
+    I2cHealthDevice* dev = &health_devices[device];
+    int result = PICO_ERROR_GENERIC;
+    if (health_lock(dev)) {
+        result = i2c_write_timeout_us(dev->i2c, dev->addr, src, len, nostop, I2C_HEALTH_TIMEOUT_US(len));
+        i2c_arb_unlock(dev->i2c);
+    }
+    i2c_health_report(device, result);
+    return result;
+}
+
+int i2c_health_read(int device, uint8_t* dst, size_t len, bool nostop) {
+    if (!i2c_health_online(device)) return PICO_ERROR_GENERIC;
+
+    I2cHealthDevice* dev = &health_devices[device];
+    int result = PICO_ERROR_GENERIC;
+    if (health_lock(dev)) {
+        result = i2c_read_timeout_us(dev->i2c, dev->addr, dst, len, nostop, I2C_HEALTH_TIMEOUT_US(len));
+        i2c_arb_unlock(dev->i2c);
+    }
+    i2c_health_report(device, result);
+    return result;
+}
+
+void i2c_health_report(int device, int result) {
+    if (!health_valid(device)) return;
+
+    I2cHealthDevice* dev = &health_devices[device];
+    dev->stats.transfers++;
+
+    if (result >= 0) {
+        dev->failures = 0;
+        return;
+    }
+
+    if (result == PICO_ERROR_TIMEOUT) {
+        // The controller (or a device holding SDA) may be mid-byte; the
+        // service resets the bus before anything else uses it
+        dev->stats.timeouts++;
+        I2cHealthBus* bus = health_bus(dev->i2c);
+        if (bus) bus->recovery_pending = true;
+    } else {
+        dev->stats.errors++;
+    }
+
+    if (dev->online && ++dev->failures >= I2C_HEALTH_OFFLINE_AFTER) {
+        dev->stats.offline_events++;
+        health_mark_offline(dev);
+        dev->notify_pending = true;
+    }
+}
+
+bool i2c_health_recover_bus(i2c_inst_t* i2c) {
+    I2cHealthBus* bus = health_bus(i2c);
+    if (!bus || i2c_dma_busy(i2c)) return false;
+
+    // Nothing may be queued onto the controller while it is taken apart
+    i2c_arb_lock(i2c, 0x00, I2C_ARB_ANY);
+    uint32_t start = time_us_32();
+    uint sda = bus->pin_sda;
+    uint scl = bus->pin_scl;
+
+    // Drive the pins as open drain from SIO: output low to pull a line
+    // down, input to let the pull-up release it
+    i2c_deinit(i2c);
+    gpio_set_dir(sda, GPIO_IN);
+    gpio_set_dir(scl, GPIO_IN);
+    gpio_put(sda, 0);
+    gpio_put(scl, 0);
+    gpio_set_function(sda, GPIO_FUNC_SIO);
+    gpio_set_function(scl, GPIO_FUNC_SIO);
+    sleep_us(5);
+
+    // A device stuck mid-byte releases SDA within nine clocks
+    for (int i = 0; i < 9 && !gpio_get(sda); i++) {
+        gpio_set_dir(scl, GPIO_OUT);
+        sleep_us(5);
+        gpio_set_dir(scl, GPIO_IN);
+        sleep_us(5);
+    }
+
+    // STOP: SDA rises while SCL is high
+    gpio_set_dir(sda, GPIO_OUT);
+    sleep_us(5);
+    gpio_set_dir(sda, GPIO_IN);
+    sleep_us(5);
+    bool released = gpio_get(sda) && gpio_get(scl);
+
+    i2c_init(i2c, bus->baudrate);
+    gpio_set_function(sda, GPIO_FUNC_I2C);
+    gpio_set_function(scl, GPIO_FUNC_I2C);
+    i2c_arb_unlock(i2c);
+
+    bus->stats.recoveries++;
+    if (!released) bus->stats.failed_recoveries++;
+    bus->stats.last_recovery_us = time_us_32() - start;
+    return released;
+}
+
+static void health_reprobe(I2cHealthDevice* dev, int device) {
+    dev->stats.probes++;
+    int result = health_send_probe(dev);
+    uint32_t now = health_now_ms();
+
+    if (result < 0) {
+        if (result == PICO_ERROR_TIMEOUT) {
+            I2cHealthBus* bus = health_bus(dev->i2c);
+            if (bus) bus->recovery_pending = true;
+        }
+        dev->probe_interval_ms *= 2;
+        if (dev->probe_interval_ms > I2C_HEALTH_PROBE_MAX_MS) {
+            dev->probe_interval_ms = I2C_HEALTH_PROBE_MAX_MS;
+        }
+        dev->next_probe_ms = now + dev->probe_interval_ms;
+        return;
+    }
+
+    dev->failures = 0;
+    dev->online = true;
+    i2c_scan_invalidate(dev->i2c);
+    dev->stats.last_recovery_ms = now - dev->offline_since_ms;
+    if (dev->stats.last_recovery_ms > dev->stats.max_recovery_ms) {
+        dev->stats.max_recovery_ms = dev->stats.last_recovery_ms;
+    }
+
+    if (dev->callback) {
+        dev->callback(device, true, dev->context);
+    }
+}
+
+void i2c_health_service() {
+    for (int b = 0; b < I2C_HEALTH_MAX_BUSES; b++) {
+        I2cHealthBus* bus = &health_buses[b];
+        if (bus->i2c && bus->recovery_pending && !i2c_dma_busy(bus->i2c)) {
+            bus->recovery_pending = false;
+            i2c_health_recover_bus(bus->i2c);
+        }
+    }
+
+    for (int d = 0; d < health_device_count; d++) {
+        I2cHealthDevice* dev = &health_devices[d];
+        if (!dev->notify_pending) continue;
+
+        dev->notify_pending = false;
+        i2c_scan_invalidate(dev->i2c);
+        if (dev->callback) {
+            dev->callback(d, false, dev->context);
+        }
+    }
+
+    // One probe per call keeps the cost to a single short transaction
+    uint32_t now = health_now_ms();
+    for (int i = 0; i < health_device_count; i++) {
+        int d = (health_next_probe + i) % health_device_count;
+        I2cHealthDevice* dev = &health_devices[d];
+
+        if (dev->online || (int32_t)(now - dev->next_probe_ms) < 0) continue;
+        if (i2c_dma_busy(dev->i2c)) continue;
+
+        health_next_probe = (d + 1) % health_device_count;
+        health_reprobe(dev, d);
+        break;
+    }
+}
+
+const I2cDeviceStats* i2c_health_get_stats(int device) {
+    if (!health_valid(device)) return nullptr;
+    return &health_devices[device].stats;
+}
+
+const I2cBusStats* i2c_health_get_bus_stats(i2c_inst_t* i2c) {
+    I2cHealthBus* bus = health_bus(i2c);
+    return bus ? &bus->stats : nullptr;
+}
+
+void i2c_health_print_stats() {
+    printf("I2C health:\n");
+    for (int d = 0; d < health_device_count; d++) {
+        const I2cHealthDevice* dev = &health_devices[d];
+        printf("  %-8s i2c%u 0x%02X %-7s %u transfers, %u errors, %u timeouts, "
+               "%u times offline, %u probes, recovery %ums (max %ums)\n",
+               dev->name, i2c_get_index(dev->i2c), dev->addr, dev->online ? "online" : "OFFLINE",
+               dev->stats.transfers, dev->stats.errors, dev->stats.timeouts,
+               dev->stats.offline_events, dev->stats.probes,
+               dev->stats.last_recovery_ms, dev->stats.max_recovery_ms);
+    }
+    for (int b = 0; b < I2C_HEALTH_MAX_BUSES; b++) {
+        const I2cHealthBus* bus = &health_buses[b];
+        if (!bus->i2c || bus->stats.recoveries == 0) continue;
+
+        printf("  bus i2c%d: %u recoveries (%u left a line low), last took %uus\n",
+               b, bus->stats.recoveries, bus->stats.failed_recoveries, bus->stats.last_recovery_us);
+    }
+}
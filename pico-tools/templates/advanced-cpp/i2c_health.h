@@ -0,0 +1,81 @@
+#ifndef I2C_HEALTH_H
+#define I2C_HEALTH_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+// Device health on the I2C buses. Every blocking transfer gets a timeout
+// sized to its length and holds the bus's i2c_arb queue while it runs; a
+// device that fails I2C_HEALTH_OFFLINE_AFTER times in a row is marked
+// offline and its transfers return at once without touching the bus.
+// i2c_health_service() re-probes offline devices in the background with a
+// growing interval, and clocks a stuck bus free (up to nine SCL pulses,
+// then a STOP) after a timeout.
+#define I2C_HEALTH_MAX_BUSES 2
+#define I2C_HEALTH_MAX_DEVICES 8
+#define I2C_HEALTH_OFFLINE_AFTER 3
+#define I2C_HEALTH_PROBE_MIN_MS 100   // First re-probe after going offline
+#define I2C_HEALTH_PROBE_MAX_MS 2000  // Re-probe interval doubles up to this
+
+// Bounded wait for a blocking transfer of len bytes: a fixed allowance plus
+// one byte time at 100kHz (90us) with margin for each byte and the address
+#define I2C_HEALTH_TIMEOUT_US(len) (1000u + ((uint)(len) + 1) * 100u)
+
+// How a device is probed: SSD1306-style panels only accept writes, most
+// sensors answer a 1-byte read
+enum I2cProbe {
+    I2C_PROBE_WRITE,
+    I2C_PROBE_READ
+};
+
+// Called from i2c_health_service() (never from IRQ context) when a device
+// goes offline or answers a re-probe; re-initialise it here
+typedef void (*i2c_health_callback_t)(int device, bool online, void* context);
+
+struct I2cDeviceStats {
+    uint32_t transfers;          // Transfers attempted while online
+    uint32_t errors;             // NACKs and other failures
+    uint32_t timeouts;           // Transfers that ran out of time
+    uint32_t offline_events;     // Times the device was marked offline
+    uint32_t probes;             // Background re-probes sent
+    uint32_t last_recovery_ms;   // Offline to back online, most recent
+    uint32_t max_recovery_ms;    // ... and worst case
+};
+
+struct I2cBusStats {
+    uint32_t recoveries;         // SCL recovery sequences run
+    uint32_t failed_recoveries;  // ... after which SDA or SCL was still low
+    uint32_t last_recovery_us;   // Duration of the last sequence
+};
+
+// Setup: register each bus (pins are needed to clock it free) and device.
+// i2c_health_probe() does one bounded probe and sets the initial state.
+void i2c_health_add_bus(i2c_inst_t* i2c, uint pin_sda, uint pin_scl, uint baudrate);
+int i2c_health_add_device(i2c_inst_t* i2c, uint8_t addr, const char* name, I2cProbe probe,
+                          i2c_health_callback_t callback, void* context);
+bool i2c_health_probe(int device);
+bool i2c_health_online(int device);
+
+// Where a device is, for drivers that queue their own transfers (i2c_arb)
+i2c_inst_t* i2c_health_get_bus(int device);
+uint8_t i2c_health_get_address(int device);
+
+// Bounded transfers; return the SDK result (byte count or PICO_ERROR_*)
+int i2c_health_write(int device, const uint8_t* src, size_t len, bool nostop);
+int i2c_health_read(int device, uint8_t* dst, size_t len, bool nostop);
+
+// Outcome of a transfer made elsewhere (DMA, display driver): PICO_OK or a
+// byte count for success, PICO_ERROR_TIMEOUT or another error otherwise.
+// Safe to call from IRQ context.
+void i2c_health_report(int device, int result);
+
+// Background work: pending bus recovery, then at most one due re-probe
+void i2c_health_service();
+bool i2c_health_recover_bus(i2c_inst_t* i2c);
+
+// Statistics
+const I2cDeviceStats* i2c_health_get_stats(int device);
+const I2cBusStats* i2c_health_get_bus_stats(i2c_inst_t* i2c);
+void i2c_health_print_stats();
+
+#endif // I2C_HEALTH_H
@@ -0,0 +1,242 @@
+#include "i2c_scan.h"
+#include <stdio.h>
+#include <string.h>
+#include "i2c_arb.h"
+#include "i2c_health.h"
+
+// Pass 0 probes the bus itself (mux channels all off), pass n probes with
+// mux channel n-1 open
+#define SCAN_PASSES (1 + I2C_SCAN_MUX_CHANNELS)
+#define SCAN_MAP_WORDS 4  // 128 addresses
+
+struct ScanBus {
+    i2c_inst_t* i2c;
+    bool has_mux;
+
+    // Driven from the arbiter's completion IRQ while a burst is active
+    volatile bool stale;         // Map needs a (re)scan
+    volatile bool running;       // Scan in progress, between bursts too
+    volatile bool active;        // Burst in flight
+    volatile bool pass_done;
+    volatile bool recover;       // A probe timed out; clock the bus free first
+    volatile uint8_t pass;
+    volatile uint8_t addr;
+    volatile uint8_t burst_left;
+    uint16_t word;               // 1-byte read, then STOP
+    I2cTransaction txn;
+
+    uint32_t start_ms;
+    uint32_t found[SCAN_PASSES][SCAN_MAP_WORDS];  // Scan in progress
+    uint32_t map[SCAN_PASSES][SCAN_MAP_WORDS];    // Last completed scan
+    volatile uint32_t generation;
+    uint32_t reported;
+    I2cScanStats stats;
+};
+
+static ScanBus scan_buses[2];
+
+static uint32_t scan_now_ms() {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static uint8_t scan_passes(const ScanBus* bus) {
+    return bus->has_mux ? SCAN_PASSES : 1;
+}
+
+static bool scan_map_has(const uint32_t* map, uint8_t addr) {
+    return (map[addr >> 5] >> (addr & 31)) & 1;
+}
+
+static void scan_commit(ScanBus* bus) {
+    memcpy(bus->map, bus->found, sizeof(bus->map));
+    bus->running = false;
+    bus->stats.scans++;
+    bus->stats.last_scan_ms = scan_now_ms() - bus->start_ms;
+    bus->generation++;
+}
+
+static void scan_end_burst(ScanBus* bus) {
+    if (bus->pass_done) {
+        bus->pass_done = false;
+        bus->addr = I2C_SCAN_FIRST_ADDR;
+        if (++bus->pass >= scan_passes(bus)) {
+            scan_commit(bus);
+        }
+    }
+    bus->active = false;
+}
+
+// The pass's mux channel goes with each probe; the arbiter switches the mux
+// when it changes and every other transaction on the bus names its own
+static void scan_probe_next(ScanBus* bus) {
+    bus->txn.addr = bus->addr;
+    bus->txn.channel = bus->pass == 0 ? I2C_ARB_DIRECT : (uint8_t)(bus->pass - 1);
+    if (!i2c_arb_submit(&bus->txn)) {
+        scan_end_burst(bus);
+    }
+}
+
+// Completion IRQ: record the result and queue the next probe of the burst
+static void scan_complete(I2cTransaction* txn, int result, void* context) {
+    (void)txn;
+    ScanBus* bus = (ScanBus*)context;
+
+    bus->stats.probes++;
+    if (result == PICO_OK) {
+        bus->found[bus->pass][bus->addr >> 5] |= 1u << (bus->addr & 31);
+    } else if (result == PICO_ERROR_TIMEOUT) {
+        // Skip the address that hung; the bus is reset before the next burst
+        bus->stats.timeouts++;
+        bus->recover = true;
+    }
+
+    bus->burst_left--;
+    if (++bus->addr > I2C_SCAN_LAST_ADDR) {
+        bus->pass_done = true;
+    }
+
+    if (!bus->recover && !bus->pass_done && bus->burst_left > 0) {
+        scan_probe_next(bus);
+        return;
+    }
+    scan_end_burst(bus);
+}
+
+static void scan_begin(ScanBus* bus) {
+    memset(bus->found, 0, sizeof(bus->found));
+    bus->stale = false;
+    bus->running = true;
+    bus->pass = 0;
+    bus->pass_done = false;
+    bus->addr = I2C_SCAN_FIRST_ADDR;
+    bus->start_ms = scan_now_ms();
+}
+
+static void scan_start_burst(ScanBus* bus) {
+    bus->burst_left = I2C_SCAN_BURST;
+    bus->recover = false;
+    bus->active = true;
+    bus->stats.bursts++;
+    scan_probe_next(bus);
+}
+
+void i2c_scan_add_bus(i2c_inst_t* i2c) {
+    ScanBus* bus = &scan_buses[i2c_get_index(i2c)];
+    i2c_arb_add_bus(i2c);
+    bus->i2c = i2c;
+    bus->stale = true;
+
+    // Lowest class: sensor and display traffic goes ahead of every probe
+    bus->word = I2C_DMA_READ | I2C_DMA_STOP;
+    bus->txn.i2c = i2c;
+    bus->txn.priority = I2C_PRIO_BACKGROUND;
+    bus->txn.words = &bus->word;
+    bus->txn.count = 1;
+    bus->txn.callback = scan_complete;
+    bus->txn.context = bus;
+}
+
+void i2c_scan_add_mux(i2c_inst_t* i2c) {
+    ScanBus* bus = &scan_buses[i2c_get_index(i2c)];
+    bus->has_mux = true;
+    bus->stale = true;
+}
+
+void i2c_scan_service() {
+    for (int b = 0; b < 2; b++) {
+        ScanBus* bus = &scan_buses[b];
+        if (!bus->i2c) continue;
+
+        if (bus->active) {
+            // Polling enforces the probe deadline on a hung address
+            i2c_arb_pending(&bus->txn);
+            continue;
+        }
+
+        if (bus->recover) {
+            bus->recover = false;
+            i2c_health_recover_bus(bus->i2c);
+        }
+
+        if (bus->stale) {
+            scan_begin(bus);
+        } else if (!bus->running) {
+            continue;
+        }
+
+        scan_start_burst(bus);
+    }
+}
+
+void i2c_scan_invalidate(i2c_inst_t* i2c) {
+    ScanBus* bus = &scan_buses[i2c_get_index(i2c)];
+    if (bus->i2c) bus->stale = true;
+}
+
+bool i2c_scan_running(i2c_inst_t* i2c) {
+    const ScanBus* bus = &scan_buses[i2c_get_index(i2c)];
+    return bus->running || bus->stale;
+}
+
+uint32_t i2c_scan_generation(i2c_inst_t* i2c) {
+    return scan_buses[i2c_get_index(i2c)].generation;
+}
+
+bool i2c_scan_present(i2c_inst_t* i2c, uint8_t channel, uint8_t addr) {
+    const ScanBus* bus = &scan_buses[i2c_get_index(i2c)];
+    if (addr > 0x7F) return false;
+
+    if (channel == I2C_SCAN_DIRECT) {
+        return scan_map_has(bus->map[0], addr);
+    }
+
+    // Devices on the bus itself answer on every pass; only count the rest
+    if (!bus->has_mux || channel >= I2C_SCAN_MUX_CHANNELS) return false;
+    return scan_map_has(bus->map[channel + 1], addr) && !scan_map_has(bus->map[0], addr);
+}
+
+int i2c_scan_list(i2c_inst_t* i2c, uint8_t channel, uint8_t* addrs, int max) {
+    int count = 0;
+    for (uint8_t addr = I2C_SCAN_FIRST_ADDR; addr <= I2C_SCAN_LAST_ADDR && count < max; addr++) {
+        if (i2c_scan_present(i2c, channel, addr)) {
+            addrs[count++] = addr;
+        }
+    }
+    return count;
+}
+
+const I2cScanStats* i2c_scan_get_stats(i2c_inst_t* i2c) {
+    return &scan_buses[i2c_get_index(i2c)].stats;
+}
+
+static void scan_print_channel(i2c_inst_t* i2c, uint8_t channel, const char* label) {
+    uint8_t addrs[I2C_SCAN_LAST_ADDR - I2C_SCAN_FIRST_ADDR + 1];
+    int count = i2c_scan_list(i2c, channel, addrs, (int)sizeof(addrs));
+    if (count == 0 && channel != I2C_SCAN_DIRECT) return;
+
+    printf("  %s:", label);
+    for (int i = 0; i < count; i++) {
+        printf(" 0x%02X", addrs[i]);
+    }
+    printf(count ? "\n" : " none\n");
+}
+
+void i2c_scan_report() {
+    for (int b = 0; b < 2; b++) {
+        ScanBus* bus = &scan_buses[b];
+        if (!bus->i2c || bus->generation == bus->reported) continue;
+        bus->reported = bus->generation;
+
+        printf("I2C scan of i2c%d took %ums in the background (%u scans, %u probes in %u bursts, %u timeouts)\n",
+               b, bus->stats.last_scan_ms, bus->stats.scans, bus->stats.probes, bus->stats.bursts,
+               bus->stats.timeouts);
+        scan_print_channel(bus->i2c, I2C_SCAN_DIRECT, "bus");
+        if (!bus->has_mux) continue;
+
+        for (uint8_t ch = 0; ch < I2C_SCAN_MUX_CHANNELS; ch++) {
+            char label[16];
+            snprintf(label, sizeof(label), "mux CH%u", ch);
+            scan_print_channel(bus->i2c, ch, label);
+        }
+    }
+}
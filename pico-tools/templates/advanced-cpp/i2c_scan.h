@@ -0,0 +1,49 @@
+#ifndef I2C_SCAN_H
+#define I2C_SCAN_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+// Background bus enumeration. Each address is probed with a 1-byte read
+// queued on i2c_arb in the background class, and the next probe is queued
+// from the completion IRQ, so a scan never blocks the caller and every
+// sensor or display transaction goes first. Probes go out in bursts of
+// I2C_SCAN_BURST; i2c_scan_service() starts the next burst. A TCA9548A on
+// the bus adds one pass per channel. The map is cached and
+// only rescanned after i2c_scan_invalidate() (i2c_health calls it when a
+// device goes offline or comes back).
+#define I2C_SCAN_BURST 16
+#define I2C_SCAN_FIRST_ADDR 0x08
+#define I2C_SCAN_LAST_ADDR 0x77
+#define I2C_SCAN_MUX_CHANNELS 8
+#define I2C_SCAN_DIRECT 0xFF  // Channel: wired to the bus, not behind the mux
+
+struct I2cScanStats {
+    uint32_t scans;          // Completed scans
+    uint32_t probes;         // Addresses probed
+    uint32_t bursts;         // Bursts started by the service
+    uint32_t timeouts;       // Probes abandoned at their deadline
+    uint32_t last_scan_ms;   // Start to finish of the last scan, wall time
+};
+
+// Setup: the bus must already be initialised; i2c_arb_add_bus() is done
+// here. The mux itself is registered with i2c_arb_add_mux().
+void i2c_scan_add_bus(i2c_inst_t* i2c);
+void i2c_scan_add_mux(i2c_inst_t* i2c);
+
+// Background work: call from the main loop
+void i2c_scan_service();
+void i2c_scan_invalidate(i2c_inst_t* i2c);
+bool i2c_scan_running(i2c_inst_t* i2c);
+
+// Cached map: valid once i2c_scan_generation() is non-zero; it keeps the
+// previous result while a rescan runs. channel is I2C_SCAN_DIRECT or 0-7.
+uint32_t i2c_scan_generation(i2c_inst_t* i2c);
+bool i2c_scan_present(i2c_inst_t* i2c, uint8_t channel, uint8_t addr);
+int i2c_scan_list(i2c_inst_t* i2c, uint8_t channel, uint8_t* addrs, int max);
+
+// Statistics: prints the map of each bus once per completed scan
+const I2cScanStats* i2c_scan_get_stats(i2c_inst_t* i2c);
+void i2c_scan_report();
+
+#endif // I2C_SCAN_H
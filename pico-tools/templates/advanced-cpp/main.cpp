@@ -4,10 +4,27 @@
 #include "pico/unique_id.h"
 #include "hardware/gpio.h"
 #include "hardware/pwm.h"
-#include "hardware/adc.h"
 #include "hardware/watchdog.h"
 #include "sensor.h"
 #include "display.h"
+#include "display_mux.h"
+#include "display_bus.h"
+#include "text.h"
+#include "font_cjk.h"
+#include "gfx.h"
+#include "widget.h"
+#include "blit.h"
+#include "dsp_filter.h"
+#include "scroll_view.h"
+#include "anim.h"
+#include "i2c_arb.h"
+#include "i2c_health.h"
+#include "i2c_scan.h"
+#include "sensor_sched.h"
+#include "spi_stream.h"
+#include "adc_dma.h"
+#include "adc_stream.h"
+#include "mux_scan.h"
 
 // Pin definitions
 const uint LED_PIN = PICO_DEFAULT_LED_PIN;
@@ -15,6 +32,30 @@ const uint BUTTON_PIN = 2;
 const uint PWM_PIN = 15;
 const uint ADC_PIN = 26;  // ADC0
 
+// Display wiring: 0 = one panel on i2c1, optionally several behind a TCA9548A
+//                 1 = panels striped across several buses (display_bus.cpp)
+#define DISPLAY_MULTI_BUS 0
+
+// 1 = the main display shows a hardware-scrolled list instead of the Temp/Light demo
+#define DISPLAY_SCROLL_DEMO 0
+
+// 1 = stream 16-bit SPI samples (GPIO 16-19) into a DMA ring and drain it in batches
+#define SPI_STREAM_DEMO 0
+#define SPI_STREAM_DEMO_RATE_HZ 20000
+
+// Conversions per second shared by the light sensor (ADC0) and the
+// temperature sensor; 500000 is the ADC's maximum
+#define ADC_STREAM_RATE_HZ 500000
+
+// 1 = the ADC scans 16 pots behind a CD74HC4067 (S0-S3 on GPIO 12-15, mux
+// output on ADC2) with the light and temperature sensors in the same scan
+// table, instead of streaming light and temperature; the panels show the
+// pots. GPIO 15 is then a select line, not the PWM output.
+#define MUX_SCAN_DEMO 0
+#define MUX_SCAN_SELECT_PIN 12
+#define MUX_SCAN_POT_INPUT 2
+#define MUX_SCAN_POTS 16
+
 // Global state
 struct SystemState {
     float temperature;
@@ -23,6 +64,42 @@ struct SystemState {
     uint32_t uptime_ms;
 } system_state = {0};
 
+// Light: spikes removed, decimated 32x, then smoothed; temperature: a
+// 255-sample mean, then smoothed (it changes slowly and is noisy)
+static DspPipeline light_filter;
+static DspPipeline temp_filter;
+
+void init_adc_filters() {
+    dsp_pipeline_init(&light_filter);
+    dsp_add_median(&light_filter, 3);
+    dsp_add_cic(&light_filter, 32, 2);
+    dsp_add_ema(&light_filter, 3);
+    
+    dsp_pipeline_init(&temp_filter);
+    dsp_add_boxcar(&temp_filter, 255);
+    dsp_add_ema(&temp_filter, 4);
+}
+
+#if MUX_SCAN_DEMO
+// Pots settle for 2us after a select change (the previous pot's charge on
+// the mux output drains through the wiper) and average 4 conversions; the
+// sensors need no settling and are averaged over 8
+static uint16_t mux_scan_values[MUX_SCAN_POTS + 2];
+
+void init_mux_scan() {
+    MuxScanChannel table[MUX_SCAN_POTS + 2];
+    for (uint8_t pot = 0; pot < MUX_SCAN_POTS; pot++) {
+        table[pot] = {pot, MUX_SCAN_POT_INPUT, 2000, 4};
+    }
+    table[MUX_SCAN_POTS] = {0, (uint8_t)(ADC_PIN - 26), 0, 8};
+    table[MUX_SCAN_POTS + 1] = {0, ADC_DMA_TEMP_INPUT, 0, 8};
+    
+    if (!mux_scan_start(pio0, MUX_SCAN_SELECT_PIN, table, MUX_SCAN_POTS + 2)) {
+        printf("Mux scan: could not start\n");
+    }
+}
+#endif
+
 void setup_hardware() {
     stdio_init_all();
     
@@ -35,16 +112,20 @@ void setup_hardware() {
     gpio_set_dir(BUTTON_PIN, GPIO_IN);
     gpio_pull_up(BUTTON_PIN);
     
+#if MUX_SCAN_DEMO
+    // ADC: pots, light and temperature in one scan table, paced by the PIO
+    init_mux_scan();
+#else
     // PWM setup for LED brightness control
     gpio_set_function(PWM_PIN, GPIO_FUNC_PWM);
     uint slice_num = pwm_gpio_to_slice_num(PWM_PIN);
     pwm_set_wrap(slice_num, 255);
     pwm_set_enabled(slice_num, true);
     
-    // ADC setup
-    adc_init();
-    adc_gpio_init(ADC_PIN);
-    adc_select_input(0);
+    // ADC: ADC0 and the temperature sensor converted in turn into a DMA ring
+    init_adc_filters();
+    adc_stream_start((1u << (ADC_PIN - 26)) | (1u << ADC_DMA_TEMP_INPUT), ADC_STREAM_RATE_HZ);
+#endif
     
     // Watchdog setup (8 second timeout)
     watchdog_enable(8000, 1);
@@ -63,14 +144,31 @@ void setup_hardware() {
 }
 
 void update_sensors() {
-    // Read temperature (simulated from ADC noise + offset)
-    adc_select_input(4);  // Temperature sensor
-    uint16_t raw_temp = adc_read();
-    system_state.temperature = 27.0f - (raw_temp * 3.3f / 4096.0f - 0.706f) / 0.001721f;
+#if MUX_SCAN_DEMO
+    // Only the latest scan matters: the readings are already averaged
+    if (mux_scan_read(mux_scan_values) > 0) {
+        system_state.light_level = mux_scan_values[MUX_SCAN_POTS];
+        system_state.temperature = 27.0f - (mux_scan_values[MUX_SCAN_POTS + 1] * 3.3f / 4096.0f - 0.706f) / 0.001721f;
+    }
+#else
+    // Filter everything the ADC streamed since the last pass, in place in
+    // the block's rows (12-bit samples fit an int16_t)
+    static AdcBlock adc_block;
     
-    // Read light level from ADC
-    adc_select_input(0);
-    system_state.light_level = adc_read();
+    while (adc_stream_read(&adc_block) > 0) {
+        int16_t* light = (int16_t*)adc_block.samples[adc_stream_row(&adc_block, ADC_PIN - 26)];
+        int16_t* temp = (int16_t*)adc_block.samples[adc_stream_row(&adc_block, ADC_DMA_TEMP_INPUT)];
+        
+        size_t count = dsp_pipeline_run(&light_filter, light, adc_block.frames);
+        if (count > 0) {
+            system_state.light_level = (uint16_t)light[count - 1];
+        }
+        count = dsp_pipeline_run(&temp_filter, temp, adc_block.frames);
+        if (count > 0) {
+            system_state.temperature = 27.0f - (temp[count - 1] * 3.3f / 4096.0f - 0.706f) / 0.001721f;
+        }
+    }
+#endif
     
     // Read button state
     system_state.button_pressed = !gpio_get(BUTTON_PIN);
@@ -89,12 +187,159 @@ void update_outputs() {
         last_blink = system_state.uptime_ms;
     }
     
+#if !MUX_SCAN_DEMO
     // Set PWM brightness based on light level
     uint slice_num = pwm_gpio_to_slice_num(PWM_PIN);
     uint8_t brightness = (system_state.light_level >> 4) & 0xFF;
     pwm_set_gpio_level(PWM_PIN, brightness);
+#endif
+}
+
+#if DISPLAY_MULTI_BUS
+#define PANEL_COUNT DISPLAY_BUS_MAX_PANELS
+#else
+#define PANEL_COUNT DISPLAY_MUX_CHANNELS
+#endif
+
+// Pot name per panel, decoded from UTF-8 once and drawn once; the level
+// readout and meter are widgets, so a panel is only redrawn (and resent)
+// where its level moved
+static const char* const panel_label_names[] = {"カットオフ", "レゾナンス", "ボリューム", "アタック", "ディケイ"};
+static FontCjkText panel_labels[sizeof(panel_label_names) / sizeof(panel_label_names[0])];
+static WidgetTree panel_widgets[PANEL_COUNT];
+static volatile int32_t panel_levels[PANEL_COUNT];
+static int panel_frames[PANEL_COUNT];   // Frame governor ids
+
+// Panels aim for this rate; the governor lowers it per panel when the
+// bus budget runs out
+#define PANEL_TARGET_FPS 30
+#define PANEL_TWEEN_MS 120
+
+Framebuffer* panel_framebuffer(uint8_t panel) {
+#if DISPLAY_MULTI_BUS
+    return display_bus_get_framebuffer(panel);
+#else
+    return display_mux_get_framebuffer(panel);
+#endif
+}
+
+void init_panels() {
+    font_cjk_init();
+    
+    // One governor bus per I2C bus (all run at 400kHz)
+#if DISPLAY_MULTI_BUS
+    uint8_t bus_count = display_bus_count();
+#else
+    uint8_t bus_count = 1;
+#endif
+    for (uint8_t bus = 0; bus < bus_count; bus++) {
+        anim_add_bus(ANIM_I2C_BUDGET(400000));
+    }
+    
+    for (uint8_t panel = 0; panel < PANEL_COUNT; panel++) {
+        Framebuffer* fb = panel_framebuffer(panel);
+        uint8_t label = panel % (sizeof(panel_labels) / sizeof(panel_labels[0]));
+        font_cjk_text_set(&panel_labels[label], panel_label_names[label]);
+        font_cjk_draw(fb, 0, 0, &panel_labels[label]);
+        
+        WidgetTree* tree = &panel_widgets[panel];
+        widget_tree_init(tree, fb);
+        int value = widget_add_number(tree, 0, 2 * TEXT_LINE_HEIGHT, FB_WIDTH, "Level ", 0, "");
+        int bar = widget_add_bar(tree, 0, FB_HEIGHT - 12, FB_WIDTH, 12, 4095);
+        widget_bind(tree, value, &panel_levels[panel]);
+        widget_bind(tree, bar, &panel_levels[panel]);
+        
+        panel_frames[panel] = anim_add_display(panel % bus_count, PANEL_TARGET_FPS);
+    }
 }
 
+void update_multi_displays() {
+#if !DISPLAY_MULTI_BUS
+    if (!display_mux_available()) return;
+#endif
+    
+    anim_update();
+    
+    // Each panel shows its pot (without the mux scan, the light level
+    // offset by the panel's index as a placeholder); the shown level
+    // glides to the new value instead of jumping
+    for (uint8_t panel = 0; panel < PANEL_COUNT; panel++) {
+#if MUX_SCAN_DEMO
+        int32_t level = panel < MUX_SCAN_POTS ? mux_scan_values[panel] : 0;
+#else
+        int32_t level = (system_state.light_level + panel * 512u) & 0x0FFF;
+#endif
+        anim_tween_to(&panel_levels[panel], level, PANEL_TWEEN_MS, ANIM_EASE_OUT);
+        
+        if (!anim_frame_due(panel_frames[panel])) continue;
+        widget_tree_render(&panel_widgets[panel]);
+        anim_frame_done(panel_frames[panel], fb_dirty_bytes(panel_framebuffer(panel)));
+        
+#if DISPLAY_MULTI_BUS
+        display_bus_present(panel);
+#else
+        display_mux_present(panel);
+#endif
+    }
+    
+#if DISPLAY_MULTI_BUS
+    // Every idle bus starts its next transfer, so the buses flush in parallel
+    display_bus_service();
+#else
+    display_mux_service();
+#endif
+}
+
+void print_panel_widget_stats() {
+    printf("Panel widgets redrawn last frame:");
+    for (uint8_t panel = 0; panel < PANEL_COUNT; panel++) {
+        const WidgetStats* stats = widget_tree_get_stats(&panel_widgets[panel]);
+        printf(" %u (%u pages)", stats->last_redrawn, stats->last_dirty_pages);
+    }
+    printf("\n");
+}
+
+#if DISPLAY_SCROLL_DEMO
+static ScrollView scroll_demo;
+#define SCROLL_DEMO_LINES 32
+
+void scroll_demo_draw_line(Framebuffer* fb, int y, uint32_t line, void* context) {
+    (void)context;
+    char text[24];
+    snprintf(text, sizeof(text), "Item %02u", (unsigned)line);
+    text_draw(fb, 2, y + 1, text);
+}
+
+// One pixel every 50ms, bouncing between the ends of the list
+void update_scroll_demo() {
+    static uint32_t last_step = 0;
+    static int direction = 1;
+    
+    if (system_state.uptime_ms - last_step < 50) return;
+    last_step = system_state.uptime_ms;
+    
+    uint32_t before = scroll_demo.offset;
+    scroll_view_scroll_by(&scroll_demo, direction);
+    if (scroll_demo.offset == before) {
+        direction = -direction;
+    }
+}
+#endif
+
+#if SPI_STREAM_DEMO
+// Pull whatever arrived since the last pass. The ring keeps
+// SPI_STREAM_ENTRIES - SPI_STREAM_GUARD samples (about 200ms at 20kHz), so a
+// loop pass can run well past its 10ms sleep before any are dropped
+void drain_spi_stream() {
+    static SpiSample batch[256];
+    size_t count;
+    
+    while ((count = spi_stream_read(batch, 256)) > 0) {
+        // Process the batch here; batch[i].timestamp_us says when each was taken
+    }
+}
+#endif
+
 void print_status() {
     static uint32_t last_print = 0;
     
@@ -108,9 +353,34 @@ void print_status() {
         
         // I2C sensor demo
         sensor_read_demo();
+        sensor_sched_print_stats();
         
-        // Display demo
+#if DISPLAY_MULTI_BUS
+        display_bus_print_stats();
+#else
+#if DISPLAY_SCROLL_DEMO
+        printf("Scroll offset %u: last step sent %u bytes\n",
+               scroll_demo.offset, display_get_stats()->last_frame_bytes);
+#else
+        // Display demo (flush runs on DMA, so this returns without waiting for the bus)
         display_update_demo(system_state.temperature, system_state.light_level);
+#endif
+        printf("Last display flush: %uus on the bus\n", display_get_last_flush_us());
+        display_mux_print_stats();
+#endif
+        i2c_health_print_stats();
+        i2c_arb_print_stats();
+#if MUX_SCAN_DEMO
+        mux_scan_print_stats();
+#else
+        adc_stream_print_stats();
+#endif
+#if SPI_STREAM_DEMO
+        spi_stream_print_stats();
+#endif
+        font_cjk_print_stats();
+        print_panel_widget_stats();
+        anim_print_stats();
         
         last_print = system_state.uptime_ms;
     }
@@ -121,7 +391,25 @@ int main() {
     
     // Initialize peripheral modules
     sensor_init();
+#if DISPLAY_MULTI_BUS
+    display_bus_init();
+#else
     display_init();
+    display_mux_init();
+#endif
+    text_benchmark();
+    font_cjk_benchmark();
+    gfx_benchmark();
+    blit_benchmark();
+    dsp_benchmark();
+    init_panels();
+#if SPI_STREAM_DEMO
+    spi_sensor_init();
+    spi_sensor_stream_start(SPI_STREAM_DEMO_RATE_HZ);
+#endif
+#if DISPLAY_SCROLL_DEMO
+    scroll_view_init(&scroll_demo, TEXT_LINE_HEIGHT + 2, SCROLL_DEMO_LINES, scroll_demo_draw_line, nullptr);
+#endif
     
     printf("System initialized. Starting main loop...\n");
     
@@ -132,9 +420,34 @@ int main() {
         // Update outputs based on sensor data
         update_outputs();
         
+        // Abandon I2C transfers past their deadline; the queues themselves
+        // run from the completion IRQ
+        i2c_arb_service();
+        
+        // Re-probe offline I2C devices and clock stuck buses free (one
+        // short transaction at most per pass)
+        i2c_health_service();
+        
+        // Background bus enumeration: a burst of lowest-priority probes
+        i2c_scan_service();
+        
+        // Trigger due conversions and collect finished ones (never waits)
+        sensor_sched_service();
+        
         // Print periodic status
         print_status();
         
+        // Redraw the extra panels and let the scheduler send whatever changed
+        update_multi_displays();
+        
+#if DISPLAY_SCROLL_DEMO
+        update_scroll_demo();
+#endif
+        
+#if SPI_STREAM_DEMO
+        drain_spi_stream();
+#endif
+        
         // Feed the watchdog
         watchdog_update();
         
@@ -0,0 +1,309 @@
+#include "mux_scan.h"
+#include <stdio.h>
+#include <string.h>
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+#include "adc_dma.h"
+#include "mux_scan.pio.h"
+
+#define MUX_SCAN_MASK (MUX_SCAN_ENTRIES - 1)
+#define MUX_SCAN_PIO_OVERHEAD 9     // Cycles per conversion besides the settle and hold loops
+#define MUX_SCAN_SETTLE_OFFSET 6    // Cycles from the select change to the trigger push, loops excluded
+#define MUX_SCAN_HOLD_OFFSET 3      // Cycles from the trigger push to the next select change, loops excluded
+#define MUX_SCAN_MAX_SETTLE 0xFFFFu
+#define MUX_SCAN_MAX_HOLD 0xFFFu
+
+struct MuxScan {
+    bool running;
+    PIO pio;
+    uint sm;
+    int sample_channel;      // ADC FIFO -> sample ring, paced by the ADC DREQ
+    int trigger_channel;     // PIO RX FIFO -> ADC CS, paced by the PIO: starts each conversion
+    int table_channel;       // Scan table -> PIO TX FIFO
+    int reload_channel;      // Points the table channel back at the start of the table
+    uint8_t channels;
+    uint16_t conversions;    // Per scan, oversampling included
+    uint32_t period_cycles;  // clk_sys cycles per scan
+    volatile uint32_t runs;  // Completed sample channel runs, each re-armed
+};
+
+static MuxScan mux_scan = {false, nullptr, 0, -1, -1, -1, -1, 0, 0, 0, 0};
+static MuxScanChannel mux_scan_channels[MUX_SCAN_MAX_CHANNELS];
+
+// Two words per conversion; the reload channel reads the table's address
+static uint32_t mux_scan_table[2 * MUX_SCAN_MAX_CONVERSIONS];
+static const uint32_t* mux_scan_table_start = mux_scan_table;
+
+// DMA ring: ring wrapping needs the buffer aligned to its size in bytes
+static uint16_t mux_scan_samples[MUX_SCAN_ENTRIES] __attribute__((aligned(MUX_SCAN_ENTRIES * 2)));
+
+// Program offset per PIO block (the program is loaded once per block)
+static bool mux_scan_loaded[NUM_PIOS];
+static uint mux_scan_offsets[NUM_PIOS];
+
+static MuxScanStats mux_scan_stats;
+static uint32_t mux_scan_rate_scans = 0;
+static uint32_t mux_scan_rate_us = 0;
+
+// Runs end after ADC_DMA_RUN_SAMPLES transfers (minutes at full rate): the
+// sample and trigger channels start again where they left off
+static void mux_scan_irq_handler() {
+    MuxScan* s = &mux_scan;
+    if (dma_channel_get_irq1_status(s->sample_channel)) {
+        dma_channel_acknowledge_irq1(s->sample_channel);
+        s->runs++;
+        dma_channel_set_trans_count(s->sample_channel, ADC_DMA_RUN_SAMPLES, true);
+    }
+    if (dma_channel_get_irq1_status(s->trigger_channel)) {
+        dma_channel_acknowledge_irq1(s->trigger_channel);
+        dma_channel_set_trans_count(s->trigger_channel, ADC_DMA_RUN_SAMPLES, true);
+    }
+}
+
+static uint32_t mux_scan_ns_to_cycles(uint32_t ns, uint32_t clk_hz) {
+    return (uint32_t)(((uint64_t)ns * clk_hz + 999999999u) / 1000000000u);
+}
+
+// Expands the channels into timing/trigger word pairs. Settle loops are
+// raised where needed so triggers are never closer than one conversion.
+static bool mux_scan_build_table(uint32_t clk_hz) {
+    MuxScan* s = &mux_scan;
+    uint32_t convert = (ADC_DMA_MIN_CYCLES * (uint64_t)clk_hz + clock_get_hz(clk_adc) - 1) / clock_get_hz(clk_adc);
+    uint32_t gap = convert + MUX_SCAN_TRIGGER_MARGIN;
+    uint32_t hold = mux_scan_ns_to_cycles(MUX_SCAN_HOLD_NS, clk_hz);
+    hold = hold > MUX_SCAN_HOLD_OFFSET ? hold - MUX_SCAN_HOLD_OFFSET : 0;
+    if (hold > MUX_SCAN_MAX_HOLD) hold = MUX_SCAN_MAX_HOLD;
+
+    // The temperature sensor needs its bias on for every conversion, not just its own
+    uint32_t cs = ADC_CS_EN_BITS | ADC_CS_START_ONCE_BITS;
+    for (uint8_t i = 0; i < s->channels; i++) {
+        if (mux_scan_channels[i].input == ADC_DMA_TEMP_INPUT) cs |= ADC_CS_TS_EN_BITS;
+    }
+
+    s->conversions = 0;
+    s->period_cycles = 0;
+    for (uint8_t i = 0; i < s->channels; i++) {
+        const MuxScanChannel* ch = &mux_scan_channels[i];
+        uint32_t settle = mux_scan_ns_to_cycles(ch->settle_ns, clk_hz);
+        settle = settle > MUX_SCAN_SETTLE_OFFSET ? settle - MUX_SCAN_SETTLE_OFFSET : 0;
+
+        for (uint8_t n = 0; n < ch->oversample; n++) {
+            // Repeats of the same channel have nothing left to settle
+            uint32_t loops = n == 0 ? settle : 0;
+            if (loops + hold + MUX_SCAN_PIO_OVERHEAD < gap) loops = gap - hold - MUX_SCAN_PIO_OVERHEAD;
+            if (loops > MUX_SCAN_MAX_SETTLE) return false;
+
+            uint32_t* entry = &mux_scan_table[2 * s->conversions++];
+            entry[0] = (ch->select & 0xF) | (loops << 4) | (hold << 20);
+            entry[1] = cs | ((uint32_t)ch->input << ADC_CS_AINSEL_LSB);
+            s->period_cycles += loops + hold + MUX_SCAN_PIO_OVERHEAD;
+        }
+    }
+    return true;
+}
+
+bool mux_scan_start(PIO pio, uint pin_select, const MuxScanChannel* channels, uint8_t count) {
+    MuxScan* s = &mux_scan;
+    if (s->running || count == 0 || count > MUX_SCAN_MAX_CHANNELS) return false;
+
+    uint32_t conversions = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const MuxScanChannel* ch = &channels[i];
+        if (ch->select > 15 || ch->input > ADC_DMA_TEMP_INPUT) return false;
+        if (ch->oversample == 0 || ch->oversample > MUX_SCAN_MAX_OVERSAMPLE) return false;
+        conversions += ch->oversample;
+    }
+    if (conversions > MUX_SCAN_MAX_CONVERSIONS) return false;
+
+    memcpy(mux_scan_channels, channels, count * sizeof(MuxScanChannel));
+    s->channels = count;
+    if (!mux_scan_build_table(clock_get_hz(clk_sys))) return false;
+
+    uint index = pio_get_index(pio);
+    if (!mux_scan_loaded[index]) {
+        if (!pio_can_add_program(pio, &mux_scan_program)) return false;
+        mux_scan_offsets[index] = pio_add_program(pio, &mux_scan_program);
+        mux_scan_loaded[index] = true;
+    }
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0) return false;
+    s->pio = pio;
+    s->sm = (uint)sm;
+
+    // Single conversions on demand: the PIO's trigger words set START_ONCE
+    adc_init();
+    for (uint8_t i = 0; i < count; i++) {
+        if (channels[i].input < ADC_DMA_TEMP_INPUT) adc_gpio_init(26 + channels[i].input);
+    }
+    adc_set_temp_sensor_enabled(mux_scan_table[1] & ADC_CS_TS_EN_BITS);
+    adc_run(false);
+    adc_set_round_robin(0);
+    adc_fifo_setup(true, true, 1, false, false);  // DREQ per sample, 12-bit results
+    adc_fifo_drain();
+
+    mux_scan_program_init(pio, s->sm, mux_scan_offsets[index], pin_select);
+
+    s->sample_channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(s->sample_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, MUX_SCAN_ORDER + 1); // 2-byte entries
+    channel_config_set_dreq(&config, DREQ_ADC);
+    dma_channel_configure(s->sample_channel, &config, mux_scan_samples, &adc_hw->fifo, ADC_DMA_RUN_SAMPLES, true);
+
+    s->trigger_channel = dma_claim_unused_channel(true);
+    config = dma_channel_get_default_config(s->trigger_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(pio, s->sm, false));
+    dma_channel_configure(s->trigger_channel, &config, &adc_hw->cs, &pio->rxf[s->sm], ADC_DMA_RUN_SAMPLES, true);
+
+    // The table channel chains to the reload channel, which restarts it
+    // from the top by writing its read-address trigger alias
+    s->table_channel = dma_claim_unused_channel(true);
+    s->reload_channel = dma_claim_unused_channel(true);
+    config = dma_channel_get_default_config(s->table_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(pio, s->sm, true));
+    channel_config_set_chain_to(&config, s->reload_channel);
+    dma_channel_configure(s->table_channel, &config, &pio->txf[s->sm], mux_scan_table, 2 * s->conversions, false);
+
+    config = dma_channel_get_default_config(s->reload_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, false);
+    dma_channel_configure(s->reload_channel, &config, &dma_hw->ch[s->table_channel].al3_read_addr_trig,
+                          &mux_scan_table_start, 1, false);
+
+    s->runs = 0;
+    irq_add_shared_handler(DMA_IRQ_1, mux_scan_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+    dma_channel_set_irq1_enabled(s->sample_channel, true);
+    dma_channel_set_irq1_enabled(s->trigger_channel, true);
+
+    memset(&mux_scan_stats, 0, sizeof(mux_scan_stats));
+    mux_scan_rate_scans = 0;
+    mux_scan_rate_us = time_us_32();
+
+    // Sample n is conversion n % conversions of the table from here on
+    dma_channel_start(s->table_channel);
+    pio_sm_set_enabled(pio, s->sm, true);
+    s->running = true;
+    return true;
+}
+
+void mux_scan_stop() {
+    MuxScan* s = &mux_scan;
+    if (!s->running) return;
+
+    pio_sm_set_enabled(s->pio, s->sm, false);
+
+    // Abort the reload channel on both sides of the table channel so a
+    // chain in flight cannot restart it
+    dma_channel_abort(s->reload_channel);
+    dma_channel_abort(s->table_channel);
+    dma_channel_abort(s->reload_channel);
+    dma_channel_set_irq1_enabled(s->sample_channel, false);
+    dma_channel_set_irq1_enabled(s->trigger_channel, false);
+    dma_channel_abort(s->trigger_channel);
+    dma_channel_abort(s->sample_channel);
+    dma_channel_unclaim(s->reload_channel);
+    dma_channel_unclaim(s->table_channel);
+    dma_channel_unclaim(s->trigger_channel);
+    dma_channel_unclaim(s->sample_channel);
+    irq_remove_handler(DMA_IRQ_1, mux_scan_irq_handler);
+
+    pio_sm_clear_fifos(s->pio, s->sm);
+    pio_sm_unclaim(s->pio, s->sm);
+    sleep_us(2);  // Let a conversion already started finish
+    adc_fifo_setup(false, false, 0, false, false);
+    adc_fifo_drain();
+    s->running = false;
+}
+
+// Samples written into the ring since start
+static uint64_t mux_scan_samples_written() {
+    MuxScan* s = &mux_scan;
+
+    // Re-read if the IRQ re-armed the channel between the two reads
+    uint32_t runs;
+    uint32_t remaining;
+    do {
+        runs = s->runs;
+        remaining = dma_hw->ch[s->sample_channel].transfer_count & ADC_DMA_RUN_SAMPLES;
+    } while (runs != s->runs);
+
+    return (uint64_t)runs * ADC_DMA_RUN_SAMPLES + (ADC_DMA_RUN_SAMPLES - remaining);
+}
+
+static void mux_scan_update_rate(uint32_t scans) {
+    uint32_t now = time_us_32();
+    if (now - mux_scan_rate_us < 1000000) return;
+
+    mux_scan_stats.rate = scans - mux_scan_rate_scans;
+    mux_scan_rate_scans = scans;
+    mux_scan_rate_us = now;
+}
+
+static void mux_scan_poll() {
+    uint64_t written = mux_scan_samples_written();
+    mux_scan_stats.conversions = written;
+    mux_scan_stats.scans = (uint32_t)(written / mux_scan.conversions);
+    mux_scan_update_rate(mux_scan_stats.scans);
+}
+
+uint32_t mux_scan_read(uint16_t* values) {
+    MuxScan* s = &mux_scan;
+    if (!s->running) return 0;
+
+    while (true) {
+        mux_scan_poll();
+        uint32_t scan = mux_scan_stats.scans;
+        if (scan == 0) return 0;
+
+        uint64_t first = (uint64_t)(scan - 1) * s->conversions;
+        uint64_t sample = first;
+        for (uint8_t i = 0; i < s->channels; i++) {
+            uint8_t oversample = mux_scan_channels[i].oversample;
+            uint32_t sum = 0;
+            for (uint8_t n = 0; n < oversample; n++) {
+                sum += mux_scan_samples[sample++ & MUX_SCAN_MASK];
+            }
+            values[i] = (uint16_t)((sum + oversample / 2) / oversample);
+        }
+
+        // Taken again if the DMA came within the guard of the scan's start
+        if (mux_scan_samples_written() - first <= MUX_SCAN_ENTRIES - MUX_SCAN_GUARD) {
+            mux_scan_stats.reads++;
+            return scan;
+        }
+        mux_scan_stats.retries++;
+    }
+}
+
+uint32_t mux_scan_period_ns() {
+    if (!mux_scan.running) return 0;
+    return (uint32_t)((uint64_t)mux_scan.period_cycles * 1000000000u / clock_get_hz(clk_sys));
+}
+
+const MuxScanStats* mux_scan_get_stats() {
+    if (mux_scan.running) mux_scan_poll();
+    return &mux_scan_stats;
+}
+
+void mux_scan_print_stats() {
+    if (!mux_scan.running) return;
+
+    const MuxScanStats* stats = mux_scan_get_stats();
+    uint32_t period_ns = mux_scan_period_ns();
+    printf("Mux scan: %u channels, %u conversions per scan, %u.%02uus per scan programmed, "
+           "%u scans/s (%u conversions/s), %u reads, %u retried\n",
+           mux_scan.channels, mux_scan.conversions, period_ns / 1000, (period_ns % 1000) / 10,
+           stats->rate, stats->rate * mux_scan.conversions, stats->reads, stats->retries);
+}
@@ -0,0 +1,60 @@
+#ifndef MUX_SCAN_H
+#define MUX_SCAN_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+// Scan engine for pots (or other analog inputs) behind a CD74HC4067. A PIO
+// state machine drives the select lines S0-S3 and triggers each ADC
+// conversion itself. DMA feeds it the scan table, starts the conversions
+// and collects the results in a ring, so no CPU is involved. When a
+// conversion has sampled its input, the next channel is selected and
+// settles while the ADC is still converting.
+//
+// Entries may also name an ADC input with no mux in front of it (the select
+// lines are then don't-care), so light or temperature readings can share
+// the table. The engine has the ADC to itself: adc_stream cannot run at the
+// same time.
+#define MUX_SCAN_MAX_CHANNELS 24
+#define MUX_SCAN_MAX_CONVERSIONS 128    // Oversampled conversions per scan, all channels together
+#define MUX_SCAN_MAX_OVERSAMPLE 16
+#define MUX_SCAN_ORDER 10               // log2 ring entries: 8 scans at the maximum table size
+#define MUX_SCAN_ENTRIES (1u << MUX_SCAN_ORDER)
+#define MUX_SCAN_GUARD 16               // Entries kept clear of the DMA write position while copying
+#define MUX_SCAN_HOLD_NS 1000           // Conversion start to next select: the ADC is still sampling
+#define MUX_SCAN_TRIGGER_MARGIN 32      // clk_sys cycles added between triggers for DMA latency
+
+struct MuxScanChannel {
+    uint8_t select;        // Mux channel 0-15 put on S0-S3
+    uint8_t input;         // ADC input: 0-3 or ADC_DMA_TEMP_INPUT
+    uint16_t settle_ns;    // Select change to conversion start (at least the pipeline's minimum)
+    uint8_t oversample;    // Conversions averaged into one reading, 1-MUX_SCAN_MAX_OVERSAMPLE
+};
+
+struct MuxScanStats {
+    uint64_t conversions;   // Samples written by DMA
+    uint32_t scans;         // Complete passes over the table
+    uint32_t rate;          // Scans during the last second
+    uint32_t reads;         // mux_scan_read() calls that returned a new scan
+    uint32_t retries;       // Copies lapped by the DMA and taken again
+};
+
+// Setup: copies the table; select lines on pin_select..pin_select + 3.
+// False if a channel is out of range or the table needs more than
+// MUX_SCAN_MAX_CONVERSIONS conversions.
+bool mux_scan_start(PIO pio, uint pin_select, const MuxScanChannel* channels, uint8_t count);
+void mux_scan_stop();
+
+// Latest complete scan: one averaged reading per table channel, in table
+// order. Returns the scan number (1 upwards), 0 before the first scan.
+uint32_t mux_scan_read(uint16_t* values);
+
+// One pass over the table as programmed, after settle times were raised to
+// keep conversions apart
+uint32_t mux_scan_period_ns();
+
+// Statistics
+const MuxScanStats* mux_scan_get_stats();
+void mux_scan_print_stats();
+
+#endif // MUX_SCAN_H
@@ -0,0 +1,168 @@
+#ifndef OLED_H
+#define OLED_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "framebuffer.h"
+#include "i2c_dma.h"
+#include "i2c_health.h"
+
+// Compile-time specialised driver for SSD1306 and SH1106 panels. Bus,
+// address, geometry and controller are template parameters, so every
+// command stream is a constexpr byte array and each call compiles down to
+// the right writes with no runtime dispatch:
+//
+//   using MainPanel = OledPanel<1, 0x3C, 128, 64, OLED_SSD1306>;
+//   MainPanel::init();
+//
+// Both controllers run in page addressing mode. A window is addressed with
+// three one-byte commands (page, column low/high nibble), which is the
+// only form the SH1106 understands and half the bytes of 0x21/0x22.
+enum OledController {
+    OLED_SSD1306,
+    OLED_SH1106   // 132-column RAM, 128 visible from column 2; no scroll engine
+};
+
+#define OLED_MAX_COMMAND_BYTES 32
+
+// A command transaction: the 0x00 control byte, then every command byte
+struct OledCommands {
+    uint8_t bytes[OLED_MAX_COMMAND_BYTES];
+    uint8_t length;
+};
+
+constexpr OledCommands oled_build_init(uint8_t height, OledController controller) {
+    OledCommands c{};
+    auto add = [&c](uint8_t byte) { c.bytes[c.length++] = byte; };
+
+    add(0x00);                              // Command stream
+    add(0xAE);                              // Display off
+    add(0xD5); add(0x80);                   // Clock divide
+    add(0xA8); add((uint8_t)(height - 1));  // Multiplex ratio
+    add(0xD3); add(0x00);                   // Display offset
+    add(0x40);                              // Start line 0
+    if (controller == OLED_SSD1306) {
+        add(0x8D); add(0x14);               // Charge pump on
+        add(0x20); add(0x02);               // Page addressing mode
+    } else {
+        add(0xAD); add(0x8B);               // DC-DC converter on
+    }
+    add(0xA1);                              // Segment re-map
+    add(0xC8);                              // COM scan direction
+    add(0xDA); add(height > 32 ? 0x12 : 0x02); // COM pins
+    add(0x81); add(0xCF);                   // Contrast
+    add(0xD9); add(controller == OLED_SSD1306 ? 0xF1 : 0x22); // Pre-charge
+    add(0xDB); add(0x40);                   // VCOM detect
+    add(0xA4);                              // Follow RAM
+    add(0xA6);                              // Normal (not inverted)
+    add(0xAF);                              // Display on
+    return c;
+}
+
+// Window address commands, control byte included
+#define OLED_WINDOW_HEADER_BYTES 4
+
+template <uint8_t BusIndex, uint8_t Address, uint8_t Width, uint8_t Height, OledController Controller>
+struct OledPanel {
+    static_assert(Width <= FB_WIDTH && Height <= FB_HEIGHT, "Panel larger than the framebuffer");
+    static_assert(Height % 8 == 0, "Panel height must be whole pages");
+
+    static constexpr uint8_t address = Address;
+    static constexpr uint8_t width = Width;
+    static constexpr uint8_t height = Height;
+    static constexpr uint8_t pages = Height / 8;
+    static constexpr uint8_t column_offset = Controller == OLED_SH1106 ? 2 : 0;
+    static constexpr bool has_scroll = Controller == OLED_SSD1306;
+    static constexpr OledCommands init_commands = oled_build_init(Height, Controller);
+
+    static_assert(init_commands.length <= OLED_MAX_COMMAND_BYTES, "Init stream too long");
+
+    static i2c_inst_t* i2c() {
+        return i2c_get_instance(BusIndex);
+    }
+
+    // Blocking write with a timeout sized to the length; returns the SDK result
+    static int write(const uint8_t* data, size_t length) {
+        return i2c_write_timeout_us(i2c(), Address, data, length, false, I2C_HEALTH_TIMEOUT_US(length));
+    }
+
+    // An empty command stream (just the control byte) is acknowledged by any panel
+    static bool probe() {
+        uint8_t control = 0x00;
+        return write(&control, 1) >= 0;
+    }
+
+    // Whole init sequence as one transaction
+    static int init() {
+        return write(init_commands.bytes, init_commands.length);
+    }
+
+    static size_t encode_init(uint16_t* out) {
+        for (uint8_t i = 0; i < init_commands.length; i++) {
+            out[i] = init_commands.bytes[i];
+        }
+        out[init_commands.length - 1] |= I2C_DMA_STOP;
+        return init_commands.length;
+    }
+
+    static size_t window_header(uint8_t page, uint8_t start, uint8_t* out) {
+        uint8_t column = (uint8_t)(start + column_offset);
+        out[0] = 0x00;                        // Command stream
+        out[1] = (uint8_t)(0xB0 | page);      // Page
+        out[2] = (uint8_t)(column & 0x0F);    // Column low nibble
+        out[3] = (uint8_t)(0x10 | (column >> 4)); // Column high nibble
+        return OLED_WINDOW_HEADER_BYTES;
+    }
+
+    // Same two transactions as send_window(), as DMA stream words with a
+    // STOP flag on the last byte of each. Windows below the panel are dropped.
+    static size_t encode_window(const FramebufferWindow* window, uint16_t* out) {
+        if (window->page >= pages || window->start >= Width) return 0;
+
+        uint8_t header[OLED_WINDOW_HEADER_BYTES];
+        uint8_t length = visible_length(window);
+        size_t n = window_header(window->page, window->start, header);
+
+        for (size_t i = 0; i < n; i++) {
+            out[i] = header[i];
+        }
+        out[n - 1] |= I2C_DMA_STOP;
+
+        out[n++] = 0x40; // Data mode
+        for (uint8_t i = 0; i < length; i++) {
+            out[n++] = window->data[i];
+        }
+        out[n - 1] |= I2C_DMA_STOP;
+
+        return n;
+    }
+
+    // Blocking: address the window, then stream just its columns. Returns
+    // the bytes sent, or the SDK error of the write that failed.
+    static int send_window(const FramebufferWindow* window) {
+        if (window->page >= pages || window->start >= Width) return 0;
+
+        uint8_t header[OLED_WINDOW_HEADER_BYTES];
+        size_t header_bytes = window_header(window->page, window->start, header);
+        int result = write(header, header_bytes);
+        if (result < 0) return result;
+
+        uint8_t length = visible_length(window);
+        uint8_t data[1 + FB_WIDTH];
+        data[0] = 0x40; // Data mode
+        for (uint8_t i = 0; i < length; i++) {
+            data[1 + i] = window->data[i];
+        }
+        result = write(data, length + 1);
+        if (result < 0) return result;
+
+        return (int)(header_bytes + length + 1);
+    }
+
+    // Columns of the window that fall on the panel
+    static uint8_t visible_length(const FramebufferWindow* window) {
+        return window->end < Width ? window->length : (uint8_t)(Width - window->start);
+    }
+};
+
+#endif // OLED_H
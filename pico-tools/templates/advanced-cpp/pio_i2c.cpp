@@ -0,0 +1,153 @@
+#include "pio_i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pio_i2c.pio.h"
+
+#define PIO_I2C_MAX_BUSES 4
+
+static PioI2c* pio_i2c_buses[PIO_I2C_MAX_BUSES];
+static uint pio_i2c_bus_count = 0;
+
+// Program offset per PIO block (the program is loaded once per block)
+static bool pio_i2c_loaded[NUM_PIOS];
+static uint pio_i2c_offsets[NUM_PIOS];
+static bool pio_i2c_irq_installed[NUM_PIOS];
+
+static void pio_i2c_finish(PioI2c* bus, bool success) {
+    bus->busy = false;
+
+    if (bus->callback) {
+        bus->callback(success, bus->context);
+    }
+}
+
+// DMA stalled or the state machine is parked on an unanswered NACK: drop
+// the stream and jump to the STOP sequence (the program's first
+// instruction), which ends in the idle loop
+static void pio_i2c_timeout(PioI2c* bus) {
+    uint32_t interrupts = save_and_disable_interrupts();
+    if (bus->busy) {
+        dma_channel_abort(bus->dma_channel);
+        pio_sm_clear_fifos(bus->pio, bus->sm);
+        pio_sm_exec(bus->pio, bus->sm, pio_encode_jmp(bus->offset));
+        pio_interrupt_clear(bus->pio, bus->sm);
+        bus->timed_out = true;
+        pio_i2c_finish(bus, false);
+    }
+    restore_interrupts(interrupts);
+}
+
+// Each state machine raises its relative IRQ flag after every STOP, and
+// blocks on the same flag when a byte is not acknowledged
+static void pio_i2c_irq_handler() {
+    for (uint i = 0; i < pio_i2c_bus_count; i++) {
+        PioI2c* bus = pio_i2c_buses[i];
+        if (!pio_interrupt_get(bus->pio, bus->sm)) continue;
+
+        uint pc = pio_sm_get_pc(bus->pio, bus->sm);
+
+        if (pc == bus->offset + pio_i2c_tx_offset_nack) {
+            // Drop the rest of the stream; releasing the flag lets the
+            // state machine send STOP, which raises the flag again
+            dma_channel_abort(bus->dma_channel);
+            pio_sm_clear_fifos(bus->pio, bus->sm);
+            bus->failed = true;
+            pio_interrupt_clear(bus->pio, bus->sm);
+            continue;
+        }
+
+        pio_interrupt_clear(bus->pio, bus->sm);
+        if (!bus->busy) continue;
+
+        if (bus->failed) {
+            pio_i2c_finish(bus, false);
+            continue;
+        }
+
+        // Only the STOP that leaves the state machine idle with nothing
+        // left to send ends the transfer
+        bool idle = pc >= bus->offset + pio_i2c_tx_offset_idle &&
+                    pc < bus->offset + pio_i2c_tx_offset_start;
+        if (idle && !dma_channel_is_busy(bus->dma_channel) &&
+            pio_sm_is_tx_fifo_empty(bus->pio, bus->sm)) {
+            pio_i2c_finish(bus, true);
+        }
+    }
+}
+
+bool pio_i2c_init(PioI2c* bus, PIO pio, uint pin_sda, uint pin_scl, uint baudrate) {
+    if (pio_i2c_bus_count >= PIO_I2C_MAX_BUSES) return false;
+
+    uint index = pio_get_index(pio);
+    if (!pio_i2c_loaded[index]) {
+        if (!pio_can_add_program(pio, &pio_i2c_tx_program)) return false;
+        pio_i2c_offsets[index] = pio_add_program(pio, &pio_i2c_tx_program);
+        pio_i2c_loaded[index] = true;
+    }
+
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0) return false;
+
+    bus->pio = pio;
+    bus->sm = (uint)sm;
+    bus->offset = pio_i2c_offsets[index];
+    bus->busy = false;
+    bus->failed = false;
+    bus->timed_out = false;
+    bus->callback = nullptr;
+    bus->context = nullptr;
+
+    pio_i2c_tx_program_init(pio, bus->sm, bus->offset, pin_sda, pin_scl, baudrate);
+
+    // 16-bit writes are replicated across the FIFO word; the program reads the top half
+    bus->dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(bus->dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(pio, bus->sm, true));
+    dma_channel_configure(bus->dma_channel, &config, &pio->txf[bus->sm], nullptr, 0, false);
+
+    pio_i2c_buses[pio_i2c_bus_count++] = bus;
+
+    pio_set_irq0_source_enabled(pio, (pio_interrupt_source)(pis_interrupt0 + bus->sm), true);
+    if (!pio_i2c_irq_installed[index]) {
+        uint irq = pio_get_irq_num(pio, 0);
+        irq_add_shared_handler(irq, pio_i2c_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(irq, true);
+        pio_i2c_irq_installed[index] = true;
+    }
+
+    return true;
+}
+
+bool pio_i2c_write(PioI2c* bus, uint8_t addr, const uint16_t* words, size_t count,
+                   i2c_dma_callback_t callback, void* context) {
+    if (bus->busy || count == 0) return false;
+
+    // Load the address into Y while the state machine is parked in its idle
+    // loop; it must not see the FIFO word as the start of a transaction
+    pio_sm_set_enabled(bus->pio, bus->sm, false);
+    pio_sm_put(bus->pio, bus->sm, (uint32_t)addr << 17);
+    pio_sm_exec(bus->pio, bus->sm, pio_encode_pull(false, true));
+    pio_sm_exec(bus->pio, bus->sm, pio_encode_mov(pio_y, pio_osr));
+    pio_sm_set_enabled(bus->pio, bus->sm, true);
+
+    bus->busy = true;
+    bus->failed = false;
+    bus->timed_out = false;
+    bus->deadline_us = time_us_32() + I2C_DMA_TIMEOUT_US(count);
+    bus->callback = callback;
+    bus->context = context;
+
+    dma_channel_transfer_from_buffer_now(bus->dma_channel, words, count);
+    return true;
+}
+
+bool pio_i2c_busy(PioI2c* bus) {
+    if (bus->busy && (int32_t)(time_us_32() - bus->deadline_us) > 0) {
+        pio_i2c_timeout(bus);
+    }
+    return bus->busy;
+}
@@ -0,0 +1,33 @@
+#ifndef PIO_I2C_H
+#define PIO_I2C_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "i2c_dma.h"
+
+// Write-only PIO I2C master fed by DMA. Takes the same 16-bit stream words
+// as i2c_dma_write() (data byte, I2C_DMA_STOP flag), so display code can
+// target either kind of bus with one encoded buffer.
+struct PioI2c {
+    PIO pio;
+    uint sm;
+    uint offset;
+    int dma_channel;
+    volatile bool busy;
+    volatile bool failed;
+    volatile bool timed_out;
+    uint32_t deadline_us;
+    i2c_dma_callback_t callback;
+    void* context;
+};
+
+// Setup (claims a state machine, a DMA channel and the PIO's IRQ 0)
+bool pio_i2c_init(PioI2c* bus, PIO pio, uint pin_sda, uint pin_scl, uint baudrate);
+
+// Transfer control. Like i2c_dma, a transfer past I2C_DMA_TIMEOUT_US is
+// abandoned by pio_i2c_busy(), which sends STOP and completes it as failed.
+bool pio_i2c_write(PioI2c* bus, uint8_t addr, const uint16_t* words, size_t count,
+                   i2c_dma_callback_t callback, void* context);
+bool pio_i2c_busy(PioI2c* bus);
+
+#endif // PIO_I2C_H
@@ -0,0 +1,109 @@
+#include "scroll_view.h"
+#include "display.h"
+#include "gfx.h"
+#include <string.h>
+
+// Pixels and dirty state saved around a draw callback, so rows outside the
+// band being redrawn can be put back untouched
+static Framebuffer scroll_view_saved;
+
+static uint32_t scroll_view_max_offset(const ScrollView* view) {
+    uint32_t height = (uint32_t)view->line_height * view->line_count;
+    return height > FB_HEIGHT ? height - FB_HEIGHT : 0;
+}
+
+// Redraws content rows [y0, y1) that map onto RAM rows [ram_y, ram_y + y1 - y0)
+// without wrapping. Lines crossing the band edges are drawn whole, then
+// every row outside the band is restored, because those RAM rows still
+// show other content.
+static void scroll_view_draw_band(ScrollView* view, Framebuffer* fb, uint32_t y0, uint32_t y1, int ram_y) {
+    int band_h = (int)(y1 - y0);
+    memcpy(&scroll_view_saved, fb, sizeof(Framebuffer));
+
+    gfx_fill_rect(fb, 0, ram_y, FB_WIDTH, band_h, false);
+
+    uint32_t last_line = (y1 - 1) / view->line_height;
+    for (uint32_t line = y0 / view->line_height; line <= last_line && line < view->line_count; line++) {
+        int line_y = ram_y - (int)(y0 - line * view->line_height);
+        view->draw(fb, line_y, line, view->context);
+    }
+
+    // Keep the band from the new drawing and everything else from before
+    uint64_t band = ((band_h >= 64) ? ~0ull : ((1ull << band_h) - 1)) << ram_y;
+    uint8_t drawn[FB_PAGES][FB_WIDTH];
+    memcpy(drawn, fb->pixels, sizeof(drawn));
+    memcpy(fb, &scroll_view_saved, sizeof(Framebuffer));
+
+    for (uint8_t page = 0; page < FB_PAGES; page++) {
+        uint8_t mask = (uint8_t)(band >> (page * 8));
+        if (mask) {
+            fb_write_masked(fb, page, 0, drawn[page], mask, FB_WIDTH);
+        }
+    }
+}
+
+// Redraws content rows [y0, y1), splitting at the bottom of panel RAM
+static void scroll_view_draw_rows(ScrollView* view, uint32_t y0, uint32_t y1) {
+    Framebuffer* fb = display_get_framebuffer();
+
+    while (y0 < y1) {
+        int ram_y = (int)(y0 % FB_HEIGHT);
+        uint32_t run = y1 - y0;
+        if (run > (uint32_t)(FB_HEIGHT - ram_y)) run = FB_HEIGHT - ram_y;
+
+        scroll_view_draw_band(view, fb, y0, y0 + run, ram_y);
+        y0 += run;
+    }
+}
+
+void scroll_view_init(ScrollView* view, uint8_t line_height, uint32_t line_count,
+                      scroll_view_draw_t draw, void* context) {
+    view->line_height = line_height ? line_height : 1;
+    view->line_count = line_count;
+    view->offset = 0;
+    view->draw = draw;
+    view->context = context;
+
+    display_set_start_line(0);
+    scroll_view_draw_rows(view, 0, FB_HEIGHT);
+    display_flush_async();
+}
+
+void scroll_view_scroll_to(ScrollView* view, uint32_t offset) {
+    uint32_t max_offset = scroll_view_max_offset(view);
+    if (offset > max_offset) offset = max_offset;
+    if (offset == view->offset) return;
+
+    uint32_t old_offset = view->offset;
+    view->offset = offset;
+    display_set_start_line((uint8_t)(offset % FB_HEIGHT));
+
+    // Only the rows that came into view need drawing
+    if (offset > old_offset + FB_HEIGHT || old_offset > offset + FB_HEIGHT) {
+        scroll_view_draw_rows(view, offset, offset + FB_HEIGHT);
+    } else if (offset > old_offset) {
+        scroll_view_draw_rows(view, old_offset + FB_HEIGHT, offset + FB_HEIGHT);
+    } else {
+        scroll_view_draw_rows(view, offset, old_offset);
+    }
+
+    display_flush_async();
+}
+
+void scroll_view_scroll_by(ScrollView* view, int pixels) {
+    int64_t offset = (int64_t)view->offset + pixels;
+    scroll_view_scroll_to(view, offset < 0 ? 0 : (uint32_t)offset);
+}
+
+void scroll_view_redraw_line(ScrollView* view, uint32_t line) {
+    uint32_t y0 = line * view->line_height;
+    uint32_t y1 = y0 + view->line_height;
+
+    // Clip to the visible content rows
+    if (y0 < view->offset) y0 = view->offset;
+    if (y1 > view->offset + FB_HEIGHT) y1 = view->offset + FB_HEIGHT;
+    if (y0 >= y1) return;
+
+    scroll_view_draw_rows(view, y0, y1);
+    display_flush_async();
+}
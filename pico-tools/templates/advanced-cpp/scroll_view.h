@@ -0,0 +1,35 @@
+#ifndef SCROLL_VIEW_H
+#define SCROLL_VIEW_H
+
+#include "pico/stdlib.h"
+#include "framebuffer.h"
+
+// Vertically scrolling list on the main display, moved with the SSD1306
+// display start line instead of redrawing. Content row y always lives in
+// panel RAM row y % 64, so a scroll step sends the start line command plus
+// just the rows that scrolled into view.
+
+// Draws content line `line` with its top edge at framebuffer row y. The
+// view clears the rows first and keeps only the ones that are new.
+typedef void (*scroll_view_draw_t)(Framebuffer* fb, int y, uint32_t line, void* context);
+
+struct ScrollView {
+    uint8_t line_height;      // Pixels per content line
+    uint32_t line_count;
+    uint32_t offset;          // Content row shown at the top of the screen
+    scroll_view_draw_t draw;
+    void* context;
+};
+
+// Setup: draws the first screen and resets the start line
+void scroll_view_init(ScrollView* view, uint8_t line_height, uint32_t line_count,
+                      scroll_view_draw_t draw, void* context);
+
+// Scrolling (clamped to the content); flushes asynchronously
+void scroll_view_scroll_to(ScrollView* view, uint32_t offset);
+void scroll_view_scroll_by(ScrollView* view, int pixels);
+
+// Redraws lines whose content changed (only their visible rows)
+void scroll_view_redraw_line(ScrollView* view, uint32_t line);
+
+#endif // SCROLL_VIEW_H
@@ -3,12 +3,42 @@
 #include "hardware/i2c.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "i2c_health.h"
+#include "i2c_scan.h"
+#include "sensor_sched.h"
+#include "spi_dma.h"
+#include "spi_stream.h"
 
 // I2C configuration
 #define I2C_PORT i2c0
 #define I2C_SDA 4
 #define I2C_SCL 5
 #define I2C_FREQ 100000
+#define SENSOR_ADDR 0x40
+
+// HTU21D-style no-hold measurements: trigger, wait out the conversion, read 2 bytes
+#define SENSOR_TEMP_CMD 0xF3
+#define SENSOR_TEMP_CONVERSION_US 50000      // 14-bit temperature, max
+#define SENSOR_HUMIDITY_CMD 0xF5
+#define SENSOR_HUMIDITY_CONVERSION_US 16000  // 12-bit humidity, max
+
+static int sensor_device = -1;  // Health registry entry
+static int sensor_temp_id = -1;
+static int sensor_humidity_id = -1;
+
+static uint16_t sensor_raw(const uint8_t* data) {
+    return (uint16_t)(((data[0] << 8) | data[1]) & ~0x0003); // Low bits are status
+}
+
+static float sensor_decode_temperature(const uint8_t* data, void* context) {
+    (void)context;
+    return (sensor_raw(data) * 175.72f / 65536.0f) - 46.85f;
+}
+
+static float sensor_decode_humidity(const uint8_t* data, void* context) {
+    (void)context;
+    return sensor_raw(data) * 125.0f / 65536.0f - 6.0f;
+}
 
 // SPI configuration
 #define SPI_PORT spi0
@@ -16,6 +46,7 @@
 #define SPI_MOSI 19
 #define SPI_SCK 18
 #define SPI_CS 17
+#define SPI_MAX_BAUD 10000000  // Fastest SCK the sensor accepts; streaming raises the clock up to this
 
 void sensor_init() {
     // Initialize I2C
@@ -25,60 +56,52 @@ void sensor_init() {
     gpio_pull_up(I2C_SDA);
     gpio_pull_up(I2C_SCL);
     
+    // A missing or unplugged sensor costs nothing per read: it is marked
+    // offline and re-probed in the background
+    i2c_health_add_bus(I2C_PORT, I2C_SDA, I2C_SCL, I2C_FREQ);
+    sensor_device = i2c_health_add_device(I2C_PORT, SENSOR_ADDR, "sensor", I2C_PROBE_READ, nullptr, nullptr);
+    i2c_health_probe(sensor_device);
+    
+    // Both measurements are sampled by sensor_sched_service() without
+    // waiting on the conversions; the reads below return the latest result
+    uint8_t temp_cmd = SENSOR_TEMP_CMD;
+    uint8_t humidity_cmd = SENSOR_HUMIDITY_CMD;
+    sensor_temp_id = sensor_sched_add(sensor_device, "temperature", &temp_cmd, 1, 2,
+                                      SENSOR_TEMP_CONVERSION_US, sensor_decode_temperature, nullptr);
+    sensor_humidity_id = sensor_sched_add(sensor_device, "humidity", &humidity_cmd, 1, 2,
+                                          SENSOR_HUMIDITY_CONVERSION_US, sensor_decode_humidity, nullptr);
+    
+    // Enumerated in the background by i2c_scan_service()
+    i2c_scan_add_bus(I2C_PORT);
+    
     printf("I2C sensor interface initialized\n");
 }
 
 void sensor_read_demo() {
-    // Demo I2C device scan
-    static bool scan_done = false;
-    if (!scan_done) {
+    // Demo I2C device scan: the map is built in the background and cached,
+    // so this only prints it once per completed scan
+    if (i2c_scan_running(I2C_PORT) && i2c_scan_generation(I2C_PORT) == 0) {
         printf("Scanning I2C bus...\n");
-        
-        for (int addr = 0x08; addr < 0x78; addr++) {
-            uint8_t rxdata;
-            int ret = i2c_read_blocking(I2C_PORT, addr, &rxdata, 1, false);
-            if (ret >= 0) {
-                printf("Found I2C device at 0x%02X\n", addr);
-            }
-        }
-        scan_done = true;
     }
+    i2c_scan_report();
 }
 
 float sensor_read_temperature() {
-    // Example for a temperature sensor (like BME280 or similar)
-    // This is a placeholder - replace with actual sensor communication
-    
-    uint8_t cmd = 0xF3; // Example command
-    uint8_t data[2];
-    
-    // Write command to sensor
-    i2c_write_blocking(I2C_PORT, 0x40, &cmd, 1, true);
-    
-    // Read response
-    int result = i2c_read_blocking(I2C_PORT, 0x40, data, 2, false);
-    
-    if (result == 2) {
-        uint16_t raw = (data[0] << 8) | data[1];
-        // Convert raw value to temperature (example formula)
-        return (raw * 175.72f / 65536.0f) - 46.85f;
+    // Example for a temperature sensor (HTU21D/SHT21 style); the
+    // conversion runs in the scheduler, this never touches the bus
+    float value;
+    if (sensor_sched_value(sensor_temp_id, &value)) {
+        return value;
     }
     
     return -999.0f; // Error value
 }
 
 uint16_t sensor_read_humidity() {
-    // Example humidity reading
-    // Replace with actual sensor implementation
-    uint8_t cmd = 0xF5;
-    uint8_t data[2];
-    
-    i2c_write_blocking(I2C_PORT, 0x40, &cmd, 1, true);
-    int result = i2c_read_blocking(I2C_PORT, 0x40, data, 2, false);
-    
-    if (result == 2) {
-        uint16_t raw = (data[0] << 8) | data[1];
-        return (uint16_t)(raw * 125.0f / 65536.0f - 6.0f);
+    // Example humidity reading, latest scheduled sample
+    float value;
+    if (sensor_sched_value(sensor_humidity_id, &value)) {
+        return (uint16_t)value;
     }
     
     return 0;
@@ -115,4 +138,30 @@ uint32_t spi_sensor_read() {
     
     // Combine bytes into 32-bit value
     return (rx_data[0] << 24) | (rx_data[1] << 16) | (rx_data[2] << 8) | rx_data[3];
+}
+
+bool spi_sensor_stream_start(uint32_t rate_hz) {
+    // 16-bit frames with CS on the SPI function: the controller raises CS
+    // between frames itself, so no CPU is needed per sample
+    spi_set_format(SPI_PORT, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    
+    // The pacing timer sets the sample rate, but SCK must be fast enough to
+    // clock each frame out before the next one is queued
+    if (spi_dma_stream_max_rate_hz(SPI_PORT) < rate_hz) {
+        spi_set_baudrate(SPI_PORT, SPI_MAX_BAUD);
+    }
+    if (spi_dma_stream_max_rate_hz(SPI_PORT) < rate_hz) {
+        printf("SPI stream: %luHz needs a faster SCK than %uHz\n", (unsigned long)rate_hz,
+               spi_get_baudrate(SPI_PORT));
+        return false;
+    }
+    gpio_set_function(SPI_CS, GPIO_FUNC_SPI);
+    
+    if (!spi_stream_start(SPI_PORT, rate_hz, 0x0000)) {
+        printf("SPI stream failed to start\n");
+        return false;
+    }
+    
+    printf("SPI stream running at %luHz\n", (unsigned long)rate_hz);
+    return true;
 }
\ No newline at end of file
@@ -3,7 +3,8 @@
 
 #include "pico/stdlib.h"
 
-// I2C sensor interface
+// I2C sensor interface: temperature and humidity are sampled in the
+// background by sensor_sched_service(); the reads return the latest sample
 void sensor_init();
 void sensor_read_demo();
 float sensor_read_temperature();
@@ -13,4 +14,8 @@ uint16_t sensor_read_humidity();
 void spi_sensor_init();
 uint32_t spi_sensor_read();
 
+// Continuous 16-bit sampling into a DMA ring (after spi_sensor_init());
+// pull batches with spi_stream_read(). spi_sensor_read() no longer applies.
+bool spi_sensor_stream_start(uint32_t rate_hz);
+
 #endif // SENSOR_H
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "sensor_sched.h"
+#include <stdio.h>
+#include <string.h>
+#include "i2c_arb.h"
+#include "i2c_health.h"
+
+// Where a measurement is in the current cycle. The completion IRQ moves it
+// out of the two queued phases, the service moves it everywhere else.
+enum SchedPhase : uint8_t {
+    SCHED_IDLE,
+    SCHED_DUE,          // Trigger still to be sent this cycle
+    SCHED_TRIGGERING,   // Trigger queued on the arbiter
+    SCHED_CONVERTING,   // Triggered; result readable at ready_us
+    SCHED_COLLECTING,   // Read queued on the arbiter
+    SCHED_COLLECTED     // Read finished with result; decoded by the service
+};
+
+struct SchedSensor {
+    int device;
+    const char* name;
+    uint16_t trigger[4];     // IC_DATA_CMD words, STOP on the last
+    uint8_t trigger_len;
+    uint16_t read[SENSOR_SCHED_MAX_RESULT];
+    uint8_t result_len;
+    uint32_t conversion_us;
+    sensor_decode_t decode;
+    void* context;
+
+    I2cTransaction txn;      // Trigger, then read; never both at once
+    uint8_t data[SENSOR_SCHED_MAX_RESULT];
+    volatile SchedPhase phase;
+    volatile int result;
+    volatile uint32_t ready_us;
+    bool valid;
+    float value;
+    SensorSchedStats stats;
+    uint32_t samples_at_last_sample;
+};
+
+static SchedSensor sched_sensors[SENSOR_SCHED_MAX_SENSORS];
+static int sched_sensor_count = 0;
+static uint32_t sched_period_us = SENSOR_SCHED_PERIOD_MS * 1000;
+static uint32_t sched_next_cycle_us = 0;
+static uint32_t sched_last_rate_sample_us = 0;
+
+// Cycle accounting: open from the first trigger until every result is in
+static bool sched_cycle_open = false;
+static uint32_t sched_cycle_start_us = 0;
+static uint32_t sched_cycle_service_us = 0;
+static SensorSchedCycleStats sched_cycle_stats;
+
+static bool sched_valid(int sensor) {
+    return sensor >= 0 && sensor < sched_sensor_count;
+}
+
+// Another measurement on the same device is between trigger and result
+static bool sched_device_busy(int device) {
+    for (int i = 0; i < sched_sensor_count; i++) {
+        SchedPhase phase = sched_sensors[i].phase;
+        if (sched_sensors[i].device == device && phase != SCHED_IDLE && phase != SCHED_DUE) return true;
+    }
+    return false;
+}
+
+// Completion IRQ for both transactions
+static void sched_transfer_complete(I2cTransaction* txn, int result, void* context) {
+    (void)txn;
+    SchedSensor* sensor = (SchedSensor*)context;
+    i2c_health_report(sensor->device, result);
+
+    if (sensor->phase == SCHED_COLLECTING) {
+        sensor->result = result;
+        sensor->phase = SCHED_COLLECTED;
+        return;
+    }
+
+    // The conversion starts when the trigger's STOP goes out, which may be
+    // a display chunk later than the service queued it
+    if (result != PICO_OK) {
+        sensor->stats.errors++;
+        sensor->phase = SCHED_IDLE;
+        return;
+    }
+    sensor->ready_us = time_us_32() + sensor->conversion_us;
+    sensor->phase = SCHED_CONVERTING;
+}
+
+int sensor_sched_add(int device, const char* name, const uint8_t* trigger, uint8_t trigger_len,
+                     uint8_t result_len, uint32_t conversion_us, sensor_decode_t decode, void* context) {
+    if (sched_sensor_count >= SENSOR_SCHED_MAX_SENSORS) return -1;
+    if (trigger_len > sizeof(sched_sensors[0].trigger) || result_len > SENSOR_SCHED_MAX_RESULT) return -1;
+
+    i2c_inst_t* i2c = i2c_health_get_bus(device);
+    if (!i2c || trigger_len == 0 || result_len == 0) return -1;
+
+    SchedSensor* sensor = &sched_sensors[sched_sensor_count];
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->device = device;
+    sensor->name = name;
+    for (uint8_t i = 0; i < trigger_len; i++) {
+        sensor->trigger[i] = trigger[i];
+    }
+    sensor->trigger[trigger_len - 1] |= I2C_DMA_STOP;
+    sensor->trigger_len = trigger_len;
+    for (uint8_t i = 0; i < result_len; i++) {
+        sensor->read[i] = I2C_DMA_READ;
+    }
+    sensor->read[result_len - 1] |= I2C_DMA_STOP;
+    sensor->result_len = result_len;
+    sensor->conversion_us = conversion_us;
+    sensor->decode = decode;
+    sensor->context = context;
+
+    // Highest class: at most one display chunk ahead of each transfer
+    i2c_arb_add_bus(i2c);
+    sensor->txn.i2c = i2c;
+    sensor->txn.addr = i2c_health_get_address(device);
+    sensor->txn.channel = I2C_ARB_DIRECT;
+    sensor->txn.priority = I2C_PRIO_SENSOR;
+    sensor->txn.callback = sched_transfer_complete;
+    sensor->txn.context = sensor;
+    return sched_sensor_count++;
+}
+
+void sensor_sched_set_period(uint32_t period_ms) {
+    sched_period_us = period_ms * 1000;
+}
+
+static void sched_start_cycle(uint32_t now) {
+    if ((int32_t)(now - sched_next_cycle_us) > (int32_t)sched_period_us) {
+        // More than a whole period behind (or the first cycle): resync
+        // rather than run a burst of late cycles
+        if (sched_cycle_stats.cycles > 0) sched_cycle_stats.overruns++;
+        sched_next_cycle_us = now;
+    }
+    sched_next_cycle_us += sched_period_us;
+    sched_cycle_stats.cycles++;
+
+    for (int i = 0; i < sched_sensor_count; i++) {
+        SchedSensor* sensor = &sched_sensors[i];
+        if (sensor->phase != SCHED_IDLE) {
+            // Still busy from the last cycle; this cycle's sample is lost
+            sensor->stats.skipped++;
+            continue;
+        }
+        sensor->phase = SCHED_DUE;
+    }
+
+    sched_cycle_open = true;
+    sched_cycle_start_us = now;
+    sched_cycle_service_us = 0;
+}
+
+// Both transfers are queued on the arbiter and finish in its completion IRQ
+static void sched_submit(SchedSensor* sensor, SchedPhase phase, const uint16_t* words, uint8_t count) {
+    sensor->txn.words = words;
+    sensor->txn.count = count;
+    sensor->txn.rx = phase == SCHED_COLLECTING ? sensor->data : nullptr;
+    sensor->txn.rx_len = phase == SCHED_COLLECTING ? sensor->result_len : 0;
+    sensor->phase = phase;
+
+    if (!i2c_arb_submit(&sensor->txn)) {
+        sensor->stats.errors++;
+        sensor->phase = SCHED_IDLE;
+    }
+}
+
+static void sched_collect(SchedSensor* sensor) {
+    sched_submit(sensor, SCHED_COLLECTING, sensor->read, sensor->result_len);
+}
+
+static void sched_decode(SchedSensor* sensor, uint32_t now) {
+    sensor->phase = SCHED_IDLE;
+    if (sensor->result != PICO_OK) {
+        sensor->stats.errors++;
+        return;
+    }
+
+    sensor->value = sensor->decode(sensor->data, sensor->context);
+    sensor->valid = true;
+    sensor->stats.samples++;
+    sensor->stats.last_sample_us = now;
+}
+
+static void sched_trigger(SchedSensor* sensor) {
+    // An offline device is re-probed by i2c_health; no bus time spent here
+    if (!i2c_health_online(sensor->device)) {
+        sensor->phase = SCHED_IDLE;
+        sensor->stats.skipped++;
+        return;
+    }
+
+    sched_submit(sensor, SCHED_TRIGGERING, sensor->trigger, sensor->trigger_len);
+}
+
+void sensor_sched_service() {
+    if (sched_sensor_count == 0) return;
+
+    uint32_t start = time_us_32();
+    uint32_t now = start;
+
+    if ((int32_t)(now - sched_next_cycle_us) >= 0) {
+        sched_start_cycle(now);
+    }
+
+    // Results first, so a measurement queued behind another one on the
+    // same device can be triggered in the same call
+    bool pending = false;
+    for (int i = 0; i < sched_sensor_count; i++) {
+        SchedSensor* sensor = &sched_sensors[i];
+        if (sensor->phase == SCHED_COLLECTED) {
+            sched_decode(sensor, now);
+        } else if (sensor->phase == SCHED_CONVERTING && (int32_t)(now - sensor->ready_us) >= 0) {
+            sched_collect(sensor);
+        }
+    }
+
+    for (int i = 0; i < sched_sensor_count; i++) {
+        SchedSensor* sensor = &sched_sensors[i];
+        if (sensor->phase == SCHED_DUE && !sched_device_busy(sensor->device)) {
+            sched_trigger(sensor);
+        }
+        pending |= sensor->phase != SCHED_IDLE;
+    }
+    now = time_us_32();
+
+    if (now - sched_last_rate_sample_us >= 1000000) {
+        for (int i = 0; i < sched_sensor_count; i++) {
+            SchedSensor* sensor = &sched_sensors[i];
+            sensor->stats.rate = sensor->stats.samples - sensor->samples_at_last_sample;
+            sensor->samples_at_last_sample = sensor->stats.samples;
+        }
+        sched_last_rate_sample_us = now;
+    }
+
+    if (sched_cycle_open) {
+        sched_cycle_service_us += now - start;
+        if (!pending) {
+            sched_cycle_open = false;
+            sched_cycle_stats.last_cycle_us = now - sched_cycle_start_us;
+            sched_cycle_stats.service_us = sched_cycle_service_us;
+        }
+    }
+}
+
+bool sensor_sched_value(int sensor, float* value) {
+    if (!sched_valid(sensor) || !sched_sensors[sensor].valid) return false;
+    *value = sched_sensors[sensor].value;
+    return true;
+}
+
+uint32_t sensor_sched_age_ms(int sensor) {
+    if (!sched_valid(sensor) || !sched_sensors[sensor].valid) return UINT32_MAX;
+    return (time_us_32() - sched_sensors[sensor].stats.last_sample_us) / 1000;
+}
+
+const SensorSchedStats* sensor_sched_get_stats(int sensor) {
+    if (!sched_valid(sensor)) return nullptr;
+    return &sched_sensors[sensor].stats;
+}
+
+const SensorSchedCycleStats* sensor_sched_get_cycle_stats() {
+    return &sched_cycle_stats;
+}
+
+void sensor_sched_print_stats() {
+    if (sched_sensor_count == 0) return;
+
+    printf("Sensor cycle: every %ums, last took %uus (%uus of CPU), %u cycles, %u overruns\n",
+           sched_period_us / 1000, sched_cycle_stats.last_cycle_us, sched_cycle_stats.service_us,
+           sched_cycle_stats.cycles, sched_cycle_stats.overruns);
+
+    for (int i = 0; i < sched_sensor_count; i++) {
+        const SchedSensor* sensor = &sched_sensors[i];
+        if (sensor->valid) {
+            printf("  %-12s %8.2f, %ums old, %u samples/s (%u samples, %u errors, %u skipped)\n",
+                   sensor->name, sensor->value, sensor_sched_age_ms(i), sensor->stats.rate,
+                   sensor->stats.samples, sensor->stats.errors, sensor->stats.skipped);
+        } else {
+            printf("  %-12s no sample yet (%u errors, %u skipped)\n",
+                   sensor->name, sensor->stats.errors, sensor->stats.skipped);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef SENSOR_SCHED_H
+#define SENSOR_SCHED_H
+
+#include "pico/stdlib.h"
+
+// Split-phase measurement scheduler. Each cycle it sends the trigger
+// command to every registered sensor, returns, and reads each result once
+// that sensor's conversion time has passed, so all sensors convert at the
+// same time and a cycle costs the longest conversion, not the sum of them.
+// Measurements on the same device (e.g. temperature and humidity on an
+// HTU21D) run one after the other within the cycle. Triggers and reads are
+// queued on i2c_arb in the sensor class, ahead of display and scan traffic,
+// and finish in its completion IRQ; the service never waits on the bus.
+#define SENSOR_SCHED_MAX_SENSORS 8
+#define SENSOR_SCHED_MAX_RESULT 6      // Bytes read back per measurement
+#define SENSOR_SCHED_PERIOD_MS 100     // Default sample cycle
+
+// Converts the bytes read back into a value
+typedef float (*sensor_decode_t)(const uint8_t* data, void* context);
+
+struct SensorSchedStats {
+    uint32_t samples;        // Results read and decoded
+    uint32_t errors;         // Trigger or read transfers that failed
+    uint32_t skipped;        // Cycles missed while the device was offline
+    uint32_t rate;           // Samples during the last second
+    uint32_t last_sample_us; // When the latest result was read
+};
+
+struct SensorSchedCycleStats {
+    uint32_t cycles;         // Cycles started
+    uint32_t overruns;       // Cycles started late because the last one ran long
+    uint32_t last_cycle_us;  // First trigger to last result of the last full cycle
+    uint32_t service_us;     // CPU time in sensor_sched_service() during that cycle
+};
+
+// Setup: device is an i2c_health device; trigger is written each cycle and
+// result_len bytes are read conversion_us later. Returns the sensor index.
+int sensor_sched_add(int device, const char* name, const uint8_t* trigger, uint8_t trigger_len,
+                     uint8_t result_len, uint32_t conversion_us, sensor_decode_t decode, void* context);
+void sensor_sched_set_period(uint32_t period_ms);
+
+// Call from the main loop; only does the transfers that are due
+void sensor_sched_service();
+
+// Latest result; false until the first sample
+bool sensor_sched_value(int sensor, float* value);
+uint32_t sensor_sched_age_ms(int sensor);
+
+// Statistics
+const SensorSchedStats* sensor_sched_get_stats(int sensor);
+const SensorSchedCycleStats* sensor_sched_get_cycle_stats();
+void sensor_sched_print_stats();
+
+#endif // SENSOR_SCHED_H
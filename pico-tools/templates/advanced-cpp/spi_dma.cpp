@@ -0,0 +1,143 @@
+#include "spi_dma.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+#include "hardware/timer.h"
+
+// One stream at a time: the pacing timer and three channels
+struct SpiDmaStream {
+    bool running;
+    int timer;
+    int tx_channel;          // Command word -> SPI DR, paced by the timer
+    int timestamp_channel;   // TIMERAWL -> timestamp ring, paced by the timer
+    int rx_channel;          // SPI DR -> sample ring, paced by RX DREQ
+    uint16_t command;        // DMA source for every TX frame
+    uint32_t rate_hz;
+    volatile uint32_t rx_runs;  // Completed RX runs, each re-armed
+};
+
+static SpiDmaStream spi_dma_stream = {false, -1, -1, -1, -1, 0, 0, 0};
+
+// A run ends after SPI_DMA_RUN_FRAMES frames (hours at typical rates):
+// start each channel again where it left off
+static void spi_dma_irq_handler() {
+    SpiDmaStream* s = &spi_dma_stream;
+    int channels[] = {s->tx_channel, s->timestamp_channel, s->rx_channel};
+
+    for (int i = 0; i < 3; i++) {
+        if (!dma_channel_get_irq1_status(channels[i])) continue;
+
+        dma_channel_acknowledge_irq1(channels[i]);
+        if (channels[i] == s->rx_channel) {
+            s->rx_runs++;
+        }
+        dma_channel_set_trans_count(channels[i], SPI_DMA_RUN_FRAMES, true);
+    }
+}
+
+static int spi_dma_claim(dma_channel_config* config, uint dreq, enum dma_channel_transfer_size size) {
+    int channel = dma_claim_unused_channel(true);
+    *config = dma_channel_get_default_config(channel);
+    channel_config_set_transfer_data_size(config, size);
+    channel_config_set_dreq(config, dreq);
+    return channel;
+}
+
+bool spi_dma_stream_start(spi_inst_t* spi, uint32_t rate_hz, uint16_t command,
+                          uint16_t* samples, uint32_t* timestamps, uint8_t order) {
+    SpiDmaStream* s = &spi_dma_stream;
+    if (s->running || rate_hz == 0) return false;
+
+    // Pacing: clk_sys * 1 / divider, divider up to 16 bits. The divider
+    // rounds down, so check the rate it actually gives.
+    uint32_t divider = clock_get_hz(clk_sys) / rate_hz;
+    if (divider < 1) divider = 1;
+    if (divider > 0xFFFF) divider = 0xFFFF;
+    uint32_t paced_hz = clock_get_hz(clk_sys) / divider;
+    if (paced_hz > spi_dma_stream_max_rate_hz(spi)) return false;
+    s->rate_hz = paced_hz;
+
+    if (s->timer < 0) {
+        s->timer = dma_claim_unused_timer(true);
+    }
+    dma_timer_set_fraction((uint)s->timer, 1, (uint16_t)divider);
+    uint timer_dreq = dma_get_timer_dreq((uint)s->timer);
+    s->command = command;
+
+    dma_channel_config config;
+    s->tx_channel = spi_dma_claim(&config, timer_dreq, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, false);
+    dma_channel_configure(s->tx_channel, &config, &spi_get_hw(spi)->dr, &s->command,
+                          SPI_DMA_RUN_FRAMES, false);
+
+    s->timestamp_channel = spi_dma_claim(&config, timer_dreq, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, order + 2); // 4-byte entries
+    dma_channel_configure(s->timestamp_channel, &config, timestamps, &timer_hw->timerawl,
+                          SPI_DMA_RUN_FRAMES, false);
+
+    s->rx_channel = spi_dma_claim(&config, spi_get_dreq(spi, false), DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, order + 1); // 2-byte entries
+    dma_channel_configure(s->rx_channel, &config, samples, &spi_get_hw(spi)->dr,
+                          SPI_DMA_RUN_FRAMES, false);
+
+    s->rx_runs = 0;
+    irq_add_shared_handler(DMA_IRQ_1, spi_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+    dma_channel_set_irq1_enabled(s->tx_channel, true);
+    dma_channel_set_irq1_enabled(s->timestamp_channel, true);
+    dma_channel_set_irq1_enabled(s->rx_channel, true);
+
+    // RX first so it is listening before the first frame goes out; the two
+    // timer-paced channels start together so every frame has its timestamp
+    dma_channel_start(s->rx_channel);
+    dma_start_channel_mask((1u << s->tx_channel) | (1u << s->timestamp_channel));
+    s->running = true;
+    return true;
+}
+
+void spi_dma_stream_stop() {
+    SpiDmaStream* s = &spi_dma_stream;
+    if (!s->running) return;
+
+    int channels[] = {s->tx_channel, s->timestamp_channel, s->rx_channel};
+    for (int i = 0; i < 3; i++) {
+        dma_channel_set_irq1_enabled(channels[i], false);
+        dma_channel_abort(channels[i]);
+        dma_channel_unclaim(channels[i]);
+    }
+    irq_remove_handler(DMA_IRQ_1, spi_dma_irq_handler);
+    s->running = false;
+}
+
+uint32_t spi_dma_stream_max_rate_hz(spi_inst_t* spi) {
+    uint bits = ((spi_get_hw(spi)->cr0 & SPI_SSPCR0_DSS_BITS) >> SPI_SSPCR0_DSS_LSB) + 1;
+    return spi_get_baudrate(spi) / (bits + 1);
+}
+
+uint32_t spi_dma_stream_frames() {
+    SpiDmaStream* s = &spi_dma_stream;
+    if (!s->running) return 0;
+
+    // Re-read if the IRQ re-armed the channel between the two reads
+    uint32_t runs;
+    uint32_t remaining;
+    do {
+        runs = s->rx_runs;
+        remaining = dma_hw->ch[s->rx_channel].transfer_count & SPI_DMA_RUN_FRAMES;
+    } while (runs != s->rx_runs);
+
+    return runs * SPI_DMA_RUN_FRAMES + (SPI_DMA_RUN_FRAMES - remaining);
+}
+
+uint32_t spi_dma_stream_rate_hz() {
+    return spi_dma_stream.rate_hz;
+}
+
+uint32_t spi_dma_stream_restarts() {
+    return spi_dma_stream.rx_runs;
+}
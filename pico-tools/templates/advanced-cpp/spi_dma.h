@@ -0,0 +1,37 @@
+#ifndef SPI_DMA_H
+#define SPI_DMA_H
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+
+// Continuous SPI reads with no CPU involvement. A DMA pacing timer pushes
+// one command frame into the TX FIFO per sample period; a second channel on
+// the same timer records the timestamp of each frame, and a third drains
+// the RX FIFO. Samples and timestamps land in two DMA rings (2^order
+// entries each, aligned to their size in bytes) at matching indices.
+//
+// The SPI must already be set up for 16-bit frames with its CSn pin on the
+// SPI function, so the controller pulses CS between frames by itself.
+#define SPI_DMA_RUN_FRAMES 0x0FFFFFFFu  // Frames per DMA run (28-bit counts on RP2350); re-armed by IRQ
+
+// Fails if rate_hz is above spi_dma_stream_max_rate_hz(): a faster timer
+// would push commands into a full TX FIFO, the SPI would drop them, and the
+// timestamp ring would drift away from the sample ring
+bool spi_dma_stream_start(spi_inst_t* spi, uint32_t rate_hz, uint16_t command,
+                          uint16_t* samples, uint32_t* timestamps, uint8_t order);
+void spi_dma_stream_stop();
+
+// Most frames per second the SPI's current baud rate and frame size carry:
+// each frame takes its data bits plus one SCK period with CS high
+uint32_t spi_dma_stream_max_rate_hz(spi_inst_t* spi);
+
+// Frames written into the rings since start (wraps at 2^32)
+uint32_t spi_dma_stream_frames();
+
+// Pacing actually programmed, after rounding to the timer's fraction
+uint32_t spi_dma_stream_rate_hz();
+
+// Times a finished DMA run was re-armed
+uint32_t spi_dma_stream_restarts();
+
+#endif // SPI_DMA_H
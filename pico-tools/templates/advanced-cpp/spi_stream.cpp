@@ -0,0 +1,110 @@
+#include "spi_stream.h"
+#include <stdio.h>
+#include <string.h>
+#include "spi_dma.h"
+
+#define SPI_STREAM_MASK (SPI_STREAM_ENTRIES - 1)
+
+// DMA rings: ring wrapping needs each buffer aligned to its size in bytes
+static uint16_t spi_stream_samples[SPI_STREAM_ENTRIES] __attribute__((aligned(SPI_STREAM_ENTRIES * 2)));
+static uint32_t spi_stream_timestamps[SPI_STREAM_ENTRIES] __attribute__((aligned(SPI_STREAM_ENTRIES * 4)));
+
+static bool spi_stream_running = false;
+static uint32_t spi_stream_consumed = 0;  // Frame number of the next sample to read
+static SpiStreamStats spi_stream_stats;
+static uint32_t spi_stream_rate_frames = 0;
+static uint32_t spi_stream_rate_us = 0;
+
+bool spi_stream_start(spi_inst_t* spi, uint32_t rate_hz, uint16_t command) {
+    if (spi_stream_running) return false;
+
+    memset(&spi_stream_stats, 0, sizeof(spi_stream_stats));
+    spi_stream_consumed = 0;
+    spi_stream_rate_frames = 0;
+    spi_stream_rate_us = time_us_32();
+
+    spi_stream_running = spi_dma_stream_start(spi, rate_hz, command, spi_stream_samples,
+                                              spi_stream_timestamps, SPI_STREAM_ORDER);
+    return spi_stream_running;
+}
+
+void spi_stream_stop() {
+    if (!spi_stream_running) return;
+
+    spi_dma_stream_stop();
+    spi_stream_running = false;
+}
+
+uint32_t spi_stream_available() {
+    if (!spi_stream_running) return 0;
+
+    uint32_t backlog = spi_dma_stream_frames() - spi_stream_consumed;
+    return backlog < SPI_STREAM_ENTRIES - SPI_STREAM_GUARD ? backlog : SPI_STREAM_ENTRIES - SPI_STREAM_GUARD;
+}
+
+static void spi_stream_update_rate(uint32_t produced) {
+    uint32_t now = time_us_32();
+    if (now - spi_stream_rate_us < 1000000) return;
+
+    spi_stream_stats.rate = produced - spi_stream_rate_frames;
+    spi_stream_rate_frames = produced;
+    spi_stream_rate_us = now;
+}
+
+size_t spi_stream_read(SpiSample* out, size_t max) {
+    if (!spi_stream_running) return 0;
+
+    uint32_t produced = spi_dma_stream_frames();
+    spi_stream_stats.received = produced;
+    spi_stream_update_rate(produced);
+
+    uint32_t backlog = produced - spi_stream_consumed;
+    if (backlog > spi_stream_stats.max_backlog) {
+        spi_stream_stats.max_backlog = backlog;
+    }
+
+    // The timestamp channel runs up to a FIFO's worth of frames ahead of the
+    // samples, so anything within the guard of a full lap may be overwritten
+    const uint32_t keep = SPI_STREAM_ENTRIES - SPI_STREAM_GUARD;
+    if (backlog > keep) {
+        spi_stream_stats.dropped += backlog - keep;
+        spi_stream_consumed = produced - keep;
+        backlog = keep;
+    }
+
+    size_t count = backlog < max ? backlog : max;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t index = (spi_stream_consumed + i) & SPI_STREAM_MASK;
+        out[i].timestamp_us = spi_stream_timestamps[index];
+        out[i].value = spi_stream_samples[index];
+    }
+
+    // DMA kept going during the copy: drop the oldest entries if it has
+    // since come within the guard of them
+    uint32_t oldest_safe = spi_dma_stream_frames() - keep;
+    uint32_t torn = 0;
+    if ((int32_t)(oldest_safe - spi_stream_consumed) > 0) {
+        torn = oldest_safe - spi_stream_consumed;
+        if (torn > count) torn = (uint32_t)count;
+        memmove(out, out + torn, (count - torn) * sizeof(SpiSample));
+        spi_stream_stats.dropped += torn;
+    }
+
+    spi_stream_consumed += (uint32_t)count;
+    spi_stream_stats.delivered += (uint32_t)count - torn;
+    return count - torn;
+}
+
+const SpiStreamStats* spi_stream_get_stats() {
+    return &spi_stream_stats;
+}
+
+void spi_stream_print_stats() {
+    if (!spi_stream_running) return;
+
+    const SpiStreamStats* stats = &spi_stream_stats;
+    printf("SPI stream: paced at %uHz, %u frames/s received, %u delivered, %u dropped, "
+           "backlog max %u of %u, %u DMA re-arms\n",
+           spi_dma_stream_rate_hz(), stats->rate, stats->delivered, stats->dropped,
+           stats->max_backlog, SPI_STREAM_ENTRIES, spi_dma_stream_restarts());
+}
@@ -0,0 +1,41 @@
+#ifndef SPI_STREAM_H
+#define SPI_STREAM_H
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+
+// Streaming SPI sampling on top of spi_dma: the rings fill continuously at
+// the programmed rate and the application pulls timestamped batches when it
+// gets round to it. A consumer that falls more than a ring behind loses the
+// oldest samples; they are counted, never returned torn or out of order.
+#define SPI_STREAM_ORDER 12                         // log2 ring entries: 200ms at 20kHz
+#define SPI_STREAM_ENTRIES (1u << SPI_STREAM_ORDER)
+#define SPI_STREAM_GUARD 16  // Entries kept clear of the DMA write position while copying
+
+struct SpiSample {
+    uint32_t timestamp_us;   // When the frame was queued (low 32 bits of the timer)
+    uint16_t value;
+};
+
+struct SpiStreamStats {
+    uint32_t received;       // Frames written by DMA
+    uint32_t delivered;      // Samples returned by spi_stream_read()
+    uint32_t dropped;        // Overwritten before they were read
+    uint32_t max_backlog;    // Most samples waiting at a read
+    uint32_t rate;           // Frames received during the last second
+};
+
+// Setup: the SPI must be in 16-bit mode with hardware CS (see spi_dma.h);
+// command is sent as every frame
+bool spi_stream_start(spi_inst_t* spi, uint32_t rate_hz, uint16_t command);
+void spi_stream_stop();
+
+// Consumer
+uint32_t spi_stream_available();
+size_t spi_stream_read(SpiSample* out, size_t max);
+
+// Statistics
+const SpiStreamStats* spi_stream_get_stats();
+void spi_stream_print_stats();
+
+#endif // SPI_STREAM_H
@@ -0,0 +1,129 @@
+#include "text.h"
+#include <stdio.h>
+#include "blit.h"
+
+// Built at compile time and kept in flash; no glyph work happens at runtime
+static constexpr FontAtlas text_atlas = font_build_atlas();
+
+static_assert(text_atlas.columns['A' - FONT_FIRST_CHAR][0] == 0x7E, "atlas columns are bit n = row n");
+static_assert(text_atlas.columns['A' - FONT_FIRST_CHAR][FONT_GLYPH_WIDTH] == 0x00, "spacing column is blank");
+
+#define TEXT_UNKNOWN_GLYPH ('?' - FONT_FIRST_CHAR)
+
+// A line can show partial glyphs at both edges
+#define TEXT_MAX_VISIBLE_GLYPHS (FB_WIDTH / FONT_GLYPH_ADVANCE + 2)
+
+// Decodes one character and advances the string; anything outside the
+// font (control bytes, multi-byte sequences other than the degree sign)
+// is drawn as '?'
+static uint8_t text_next_glyph(const char** text) {
+    const uint8_t* s = (const uint8_t*)*text;
+    uint8_t c = *s++;
+    uint8_t glyph = TEXT_UNKNOWN_GLYPH;
+
+    if (c < 0x80) {
+        if (c >= FONT_FIRST_CHAR) glyph = c - FONT_FIRST_CHAR;
+    } else if (c == 0xC2 && *s == 0xB0) {
+        glyph = FONT_DEGREE_CHAR - FONT_FIRST_CHAR; // U+00B0
+        s++;
+    } else {
+        while ((*s & 0xC0) == 0x80) s++;
+    }
+
+    *text = (const char*)s;
+    return glyph;
+}
+
+int text_draw(Framebuffer* fb, int x, int y, const char* text) {
+    if (y <= -TEXT_LINE_HEIGHT || y >= FB_HEIGHT) {
+        return x + text_width(text);
+    }
+
+    // Atlas offsets of the glyphs that reach the screen, gathered into one
+    // column buffer for the whole line and written in one go
+    uint16_t offsets[TEXT_MAX_VISIBLE_GLYPHS];
+    size_t glyphs = 0;
+    int first = x < 0 ? 0 : x;
+    int skip = 0; // Columns of the first glyph that are left of the screen
+
+    while (*text && *text != '\n' && x < FB_WIDTH) {
+        uint8_t glyph = text_next_glyph(&text);
+        if (x + FONT_GLYPH_ADVANCE > 0) {
+            if (glyphs == 0 && x < 0) skip = -x;
+            offsets[glyphs++] = (uint16_t)(glyph * FONT_GLYPH_ADVANCE);
+        }
+        x += FONT_GLYPH_ADVANCE;
+    }
+
+    if (glyphs == 0) return x;
+
+    uint8_t gathered[TEXT_MAX_VISIBLE_GLYPHS * FONT_GLYPH_ADVANCE];
+    blit_lut_gather(&text_atlas.columns[0][0], offsets, glyphs, FONT_GLYPH_ADVANCE, gathered);
+
+    const uint8_t* columns = &gathered[skip];
+    size_t count = glyphs * FONT_GLYPH_ADVANCE - skip;
+    if (first + count > FB_WIDTH) count = FB_WIDTH - first;
+
+    int shift = y & 7;
+    int page = (y - shift) / 8;
+
+    if (shift == 0) {
+        fb_write(fb, (uint8_t)page, (uint8_t)first, columns, count);
+        return x;
+    }
+
+    // Off a page boundary each column becomes a 16-bit word shifted down by
+    // y % 8; its low byte lands in this page and its high byte in the next
+    uint8_t upper[FB_WIDTH];
+    uint8_t lower[FB_WIDTH];
+    blit_shift_split(columns, count, shift, upper, lower);
+
+    uint16_t mask = (uint16_t)(0xFF << shift);
+    if (page >= 0) {
+        fb_write_masked(fb, (uint8_t)page, (uint8_t)first, upper, (uint8_t)mask, count);
+    }
+    if (page + 1 < FB_PAGES) {
+        fb_write_masked(fb, (uint8_t)(page + 1), (uint8_t)first, lower, (uint8_t)(mask >> 8), count);
+    }
+    return x;
+}
+
+int text_width(const char* text) {
+    int width = 0;
+    while (*text && *text != '\n') {
+        text_next_glyph(&text);
+        width += FONT_GLYPH_ADVANCE;
+    }
+    return width;
+}
+
+// Alternates two strings so every pass changes pixels and takes the full
+// write path, as a changing readout would
+static uint32_t text_benchmark_run(Framebuffer* fb, int y, uint32_t passes, uint32_t* glyphs) {
+    static const char* const lines[] = {"Temp: 23.4\xC2\xB0" "C Light", "Temp: 25.1\xC2\xB0" "C Level"};
+    uint32_t per_pass = (uint32_t)(text_width(lines[0]) / FONT_GLYPH_ADVANCE);
+    *glyphs = 0;
+
+    uint64_t start = time_us_64();
+    for (uint32_t i = 0; i < passes; i++) {
+        text_draw(fb, 0, y, lines[i & 1]);
+        *glyphs += per_pass;
+    }
+    return (uint32_t)(time_us_64() - start);
+}
+
+void text_benchmark() {
+    static Framebuffer scratch;
+    fb_init(&scratch);
+
+    const uint32_t passes = 1000;
+    uint32_t glyphs = 0;
+
+    uint32_t aligned_us = text_benchmark_run(&scratch, 16, passes, &glyphs);
+    printf("Text: %u glyphs/s page-aligned (%uus for %u glyphs)\n",
+           (unsigned)((uint64_t)glyphs * 1000000 / (aligned_us ? aligned_us : 1)), aligned_us, glyphs);
+
+    uint32_t shifted_us = text_benchmark_run(&scratch, 21, passes, &glyphs);
+    printf("Text: %u glyphs/s unaligned (%uus for %u glyphs)\n",
+           (unsigned)((uint64_t)glyphs * 1000000 / (shifted_us ? shifted_us : 1)), shifted_us, glyphs);
+}
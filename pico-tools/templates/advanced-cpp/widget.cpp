@@ -0,0 +1,194 @@
+#include "widget.h"
+#include "text.h"
+#include "gfx.h"
+#include <stdio.h>
+#include <string.h>
+
+void widget_tree_init(WidgetTree* tree, Framebuffer* fb) {
+    memset(tree, 0, sizeof(WidgetTree));
+    tree->fb = fb;
+}
+
+static Widget* widget_add(WidgetTree* tree, WidgetType type, int x, int y, int w, int h) {
+    if (tree->count >= WIDGET_MAX) return nullptr;
+
+    Widget* widget = &tree->widgets[tree->count++];
+    memset(widget, 0, sizeof(Widget));
+    widget->type = type;
+    widget->x = (int16_t)x;
+    widget->y = (int16_t)y;
+    widget->w = (uint8_t)w;
+    widget->h = (uint8_t)h;
+    return widget;
+}
+
+static int widget_id(const WidgetTree* tree, const Widget* widget) {
+    return widget ? (int)(widget - tree->widgets) : -1;
+}
+
+static Widget* widget_get(WidgetTree* tree, int id) {
+    if (id < 0 || id >= tree->count) return nullptr;
+    return &tree->widgets[id];
+}
+
+int widget_add_label(WidgetTree* tree, int x, int y, int w, const char* text) {
+    Widget* widget = widget_add(tree, WIDGET_LABEL, x, y, w, TEXT_LINE_HEIGHT);
+    if (widget) widget_set_text(tree, widget_id(tree, widget), text);
+    return widget_id(tree, widget);
+}
+
+int widget_add_number(WidgetTree* tree, int x, int y, int w, const char* prefix,
+                      uint8_t decimals, const char* suffix) {
+    Widget* widget = widget_add(tree, WIDGET_NUMBER, x, y, w, TEXT_LINE_HEIGHT);
+    if (widget) {
+        widget->prefix = prefix ? prefix : "";
+        widget->suffix = suffix ? suffix : "";
+        widget->decimals = decimals > WIDGET_MAX_DECIMALS ? WIDGET_MAX_DECIMALS : decimals;
+    }
+    return widget_id(tree, widget);
+}
+
+int widget_add_bar(WidgetTree* tree, int x, int y, int w, int h, int32_t max) {
+    Widget* widget = widget_add(tree, WIDGET_BAR, x, y, w, h);
+    if (widget) widget->max = max;
+    return widget_id(tree, widget);
+}
+
+int widget_add_list_row(WidgetTree* tree, int x, int y, int w, const char* text) {
+    Widget* widget = widget_add(tree, WIDGET_LIST_ROW, x, y, w, TEXT_LINE_HEIGHT);
+    if (widget) widget_set_text(tree, widget_id(tree, widget), text);
+    return widget_id(tree, widget);
+}
+
+void widget_set_text(WidgetTree* tree, int id, const char* text) {
+    Widget* widget = widget_get(tree, id);
+    if (!widget || strncmp(widget->text, text, WIDGET_TEXT_MAX - 1) == 0) return;
+
+    strncpy(widget->text, text, WIDGET_TEXT_MAX - 1);
+    widget->text[WIDGET_TEXT_MAX - 1] = '\0';
+    widget->text_changed = true;
+}
+
+void widget_set_value(WidgetTree* tree, int id, int32_t value) {
+    Widget* widget = widget_get(tree, id);
+    if (widget) widget->value = value;
+}
+
+void widget_set_selected(WidgetTree* tree, int id, bool selected) {
+    Widget* widget = widget_get(tree, id);
+    if (widget) widget->selected = selected;
+}
+
+void widget_bind(WidgetTree* tree, int id, const volatile int32_t* source) {
+    Widget* widget = widget_get(tree, id);
+    if (widget) widget->source = source;
+}
+
+static bool widget_changed(const Widget* widget) {
+    if (!widget->drawn) return true;
+
+    switch (widget->type) {
+        case WIDGET_LABEL:
+            return widget->text_changed;
+        case WIDGET_LIST_ROW:
+            return widget->text_changed || widget->selected != widget->drawn_selected;
+        case WIDGET_NUMBER:
+        case WIDGET_BAR:
+            return widget->value != widget->drawn_value;
+    }
+    return false;
+}
+
+// Cuts text after the last whole glyph that fits in the widget, so a long
+// value cannot draw over its neighbours
+static void widget_clip_text(const Widget* widget, char* text) {
+    int glyphs = widget->w / FONT_GLYPH_ADVANCE;
+    for (char* s = text; *s; s++) {
+        if ((*s & 0xC0) == 0x80) continue; // UTF-8 continuation byte
+        if (glyphs-- == 0) {
+            *s = '\0';
+            return;
+        }
+    }
+}
+
+// Text cells replace what is under them, so only the part of the box past
+// the end of the text needs clearing; unchanged glyphs stay clean
+static void widget_draw_text(Framebuffer* fb, const Widget* widget, char* text) {
+    widget_clip_text(widget, text);
+    int end = text_draw(fb, widget->x, widget->y, text);
+    int box_end = widget->x + widget->w;
+    if (end < box_end) {
+        gfx_fill_rect(fb, end, widget->y, box_end - end, widget->h, false);
+    }
+}
+
+static void widget_format_number(const Widget* widget, char* out, size_t size) {
+    int32_t value = widget->value;
+    const char* sign = value < 0 ? "-" : "";
+    uint32_t magnitude = value < 0 ? (uint32_t)-(int64_t)value : (uint32_t)value;
+
+    if (widget->decimals == 0) {
+        snprintf(out, size, "%s%s%u%s", widget->prefix, sign, (unsigned)magnitude, widget->suffix);
+        return;
+    }
+
+    // Prefix and suffix are the caller's; anything past the buffer is cut,
+    // as it would be clipped at the widget's edge anyway
+    int decimals = widget->decimals > WIDGET_MAX_DECIMALS ? WIDGET_MAX_DECIMALS : widget->decimals;
+    uint32_t scale = 1;
+    for (int i = 0; i < decimals; i++) scale *= 10;
+    snprintf(out, size, "%s%s%u.%0*u%s", widget->prefix, sign, (unsigned)(magnitude / scale),
+             decimals, (unsigned)(magnitude % scale), widget->suffix);
+}
+
+static void widget_draw(Framebuffer* fb, const Widget* widget) {
+    // Room for a full-width line plus the list row's "> " marker
+    char text[WIDGET_TEXT_MAX + 2];
+
+    switch (widget->type) {
+        case WIDGET_LABEL:
+            memcpy(text, widget->text, WIDGET_TEXT_MAX);
+            widget_draw_text(fb, widget, text);
+            break;
+        case WIDGET_LIST_ROW:
+            snprintf(text, sizeof(text), "%c %s", widget->selected ? '>' : ' ', widget->text);
+            widget_draw_text(fb, widget, text);
+            break;
+        case WIDGET_NUMBER:
+            widget_format_number(widget, text, sizeof(text));
+            widget_draw_text(fb, widget, text);
+            break;
+        case WIDGET_BAR:
+            gfx_bar(fb, widget->x, widget->y, widget->w, widget->h,
+                    widget->value < 0 ? 0 : (uint32_t)widget->value, (uint32_t)widget->max);
+            break;
+    }
+}
+
+uint32_t widget_tree_render(WidgetTree* tree) {
+    uint32_t redrawn = 0;
+
+    for (uint8_t i = 0; i < tree->count; i++) {
+        Widget* widget = &tree->widgets[i];
+        if (widget->source) widget->value = *widget->source;
+        if (!widget_changed(widget)) continue;
+
+        widget_draw(tree->fb, widget);
+        widget->drawn = true;
+        widget->text_changed = false;
+        widget->drawn_value = widget->value;
+        widget->drawn_selected = widget->selected;
+        redrawn++;
+    }
+
+    tree->stats.last_redrawn = redrawn;
+    tree->stats.last_dirty_pages = (uint32_t)__builtin_popcount(tree->fb->dirty_pages);
+    tree->stats.total_redrawn += redrawn;
+    if (redrawn) tree->stats.frames++;
+    return redrawn;
+}
+
+const WidgetStats* widget_tree_get_stats(const WidgetTree* tree) {
+    return &tree->stats;
+}
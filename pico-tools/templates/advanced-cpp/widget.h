@@ -0,0 +1,78 @@
+#ifndef WIDGET_H
+#define WIDGET_H
+
+#include "pico/stdlib.h"
+#include "framebuffer.h"
+
+// Retained widgets: each widget remembers what it last drew and redraws
+// (and dirties) only its own box when its value changes.
+#define WIDGET_MAX 16
+#define WIDGET_TEXT_MAX 22
+#define WIDGET_MAX_DECIMALS 9   // 10^9 is the largest power of ten in a uint32_t
+
+enum WidgetType {
+    WIDGET_LABEL,     // Text
+    WIDGET_NUMBER,    // prefix + fixed-point value + suffix
+    WIDGET_BAR,       // Level meter, value out of max
+    WIDGET_LIST_ROW   // Text with a selection marker
+};
+
+struct Widget {
+    WidgetType type;
+    int16_t x;
+    int16_t y;
+    uint8_t w;
+    uint8_t h;
+
+    // Content
+    char text[WIDGET_TEXT_MAX];   // Label and list row text
+    const char* prefix;           // Number: text before and after the value
+    const char* suffix;
+    uint8_t decimals;             // Number: value is scaled by 10^decimals
+    int32_t value;
+    int32_t max;                  // Bar: full-scale value
+    bool selected;                // List row
+    const volatile int32_t* source; // Optional binding, read on every render
+
+    // Last drawn state
+    bool drawn;
+    bool text_changed;
+    int32_t drawn_value;
+    bool drawn_selected;
+};
+
+struct WidgetStats {
+    uint32_t frames;            // Renders that redrew at least one widget
+    uint32_t last_redrawn;      // Widgets redrawn by the last render
+    uint32_t last_dirty_pages;  // Pages dirty after the last render
+    uint32_t total_redrawn;
+};
+
+struct WidgetTree {
+    Framebuffer* fb;
+    Widget widgets[WIDGET_MAX];
+    uint8_t count;
+    WidgetStats stats;
+};
+
+// Setup (add functions return the widget id, or -1 when the tree is full).
+// Text is clipped to the widget's width; decimals are capped at
+// WIDGET_MAX_DECIMALS.
+void widget_tree_init(WidgetTree* tree, Framebuffer* fb);
+int widget_add_label(WidgetTree* tree, int x, int y, int w, const char* text);
+int widget_add_number(WidgetTree* tree, int x, int y, int w, const char* prefix,
+                      uint8_t decimals, const char* suffix);
+int widget_add_bar(WidgetTree* tree, int x, int y, int w, int h, int32_t max);
+int widget_add_list_row(WidgetTree* tree, int x, int y, int w, const char* text);
+
+// Values (cheap; nothing is drawn until widget_tree_render())
+void widget_set_text(WidgetTree* tree, int id, const char* text);
+void widget_set_value(WidgetTree* tree, int id, int32_t value);
+void widget_set_selected(WidgetTree* tree, int id, bool selected);
+void widget_bind(WidgetTree* tree, int id, const volatile int32_t* source);
+
+// Redraws changed widgets into the framebuffer; returns how many
+uint32_t widget_tree_render(WidgetTree* tree);
+const WidgetStats* widget_tree_get_stats(const WidgetTree* tree);
+
+#endif // WIDGET_H
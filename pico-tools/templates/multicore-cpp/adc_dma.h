@@ -0,0 +1,32 @@
+#ifndef ADC_DMA_H
+#define ADC_DMA_H
+
+#include "pico/stdlib.h"
+
+// Free-running ADC sampling with no CPU involvement. The ADC converts the
+// inputs in input_mask in round-robin order (lowest first) at its own clock
+// divider and one DMA channel drains the FIFO into a sample ring (2^order
+// 16-bit entries, aligned to its size in bytes). Conversions are clocked
+// from clk_adc, so sample n was taken at a fixed offset from the start and
+// needs no timestamp of its own.
+#define ADC_DMA_RUN_SAMPLES 0x0FFFFFFFu  // Samples per DMA run (28-bit counts on RP2350); re-armed by IRQ
+#define ADC_DMA_MIN_CYCLES 96            // clk_adc cycles per conversion: 500ksps at 48MHz
+#define ADC_DMA_TEMP_INPUT 4             // Internal temperature sensor
+
+// rate_hz counts conversions, so each input gets rate_hz / inputs
+bool adc_dma_stream_start(uint16_t input_mask, uint32_t rate_hz, uint16_t* samples, uint8_t order);
+void adc_dma_stream_stop();
+
+// Samples written into the ring since start
+uint64_t adc_dma_stream_samples();
+
+// When conversion n started (low 32 bits of the timer)
+uint32_t adc_dma_stream_sample_us(uint64_t n);
+
+// Conversion rate actually programmed, after rounding to the divider's 1/256 steps
+uint32_t adc_dma_stream_rate_hz();
+
+// Times a finished DMA run was re-armed
+uint32_t adc_dma_stream_restarts();
+
+#endif // ADC_DMA_H
@@ -0,0 +1,174 @@
+#include "blit.h"
+#include <stdio.h>
+#include <string.h>
+#include "hardware/clocks.h"
+#if BLIT_USE_INTERP
+#include "hardware/interp.h"
+#endif
+
+static bool blit_use_interp = BLIT_USE_INTERP;
+
+void blit_set_interp_enabled(bool enabled) {
+    blit_use_interp = enabled && BLIT_USE_INTERP;
+}
+
+bool blit_interp_enabled() {
+    return blit_use_interp;
+}
+
+static void blit_shift_split_soft(const uint8_t* src, size_t count, int shift, uint8_t* upper, uint8_t* lower) {
+    for (size_t i = 0; i < count; i++) {
+        uint16_t word = (uint16_t)(src[i] << shift);
+        upper[i] = (uint8_t)word;
+        lower[i] = (uint8_t)(word >> 8);
+    }
+}
+
+static void blit_lut_gather_soft(const uint8_t* table, const uint16_t* offsets, size_t count,
+                                 size_t entry_bytes, uint8_t* out) {
+    for (size_t i = 0; i < count; i++) {
+        memcpy(out, table + offsets[i], entry_bytes);
+        out += entry_bytes;
+    }
+}
+
+#if BLIT_USE_INTERP
+// The interpolators only shift right, so the column byte goes in at bit 8:
+// lane 0 shifts it back by 8 - shift (upper page), lane 1 reads the same
+// accumulator and shifts by 16 - shift (lower page); both mask to 8 bits
+static void blit_shift_split_interp(const uint8_t* src, size_t count, int shift, uint8_t* upper, uint8_t* lower) {
+    interp_hw_save_t saved;
+    interp_save(interp0, &saved);
+
+    interp_config lane0 = interp_default_config();
+    interp_config_set_shift(&lane0, 8 - shift);
+    interp_config_set_mask(&lane0, 0, 7);
+    interp_set_config(interp0, 0, &lane0);
+
+    interp_config lane1 = interp_default_config();
+    interp_config_set_shift(&lane1, 16 - shift);
+    interp_config_set_mask(&lane1, 0, 7);
+    interp_config_set_cross_input(&lane1, true);
+    interp_set_config(interp0, 1, &lane1);
+
+    interp0->base[0] = 0;
+    interp0->base[1] = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        interp0->accum[0] = (uint32_t)src[i] << 8;
+        upper[i] = (uint8_t)interp0->peek[0];
+        lower[i] = (uint8_t)interp0->peek[1];
+    }
+
+    interp_restore(interp0, &saved);
+}
+
+// Lane 0 adds the table base to each offset, so the entry address comes
+// straight out of PEEK0
+static void blit_lut_gather_interp(const uint8_t* table, const uint16_t* offsets, size_t count,
+                                   size_t entry_bytes, uint8_t* out) {
+    interp_hw_save_t saved;
+    interp_save(interp0, &saved);
+
+    interp_config lane0 = interp_default_config();
+    interp_config_set_mask(&lane0, 0, 15);
+    interp_set_config(interp0, 0, &lane0);
+    interp0->base[0] = (uint32_t)(uintptr_t)table;
+
+    for (size_t i = 0; i < count; i++) {
+        interp0->accum[0] = offsets[i];
+        const uint8_t* entry = (const uint8_t*)(uintptr_t)interp0->peek[0];
+        for (size_t b = 0; b < entry_bytes; b++) {
+            *out++ = entry[b];
+        }
+    }
+
+    interp_restore(interp0, &saved);
+}
+#endif
+
+void blit_shift_split(const uint8_t* src, size_t count, int shift, uint8_t* upper, uint8_t* lower) {
+#if BLIT_USE_INTERP
+    if (blit_use_interp) {
+        blit_shift_split_interp(src, count, shift, upper, lower);
+        return;
+    }
+#endif
+    blit_shift_split_soft(src, count, shift, upper, lower);
+}
+
+void blit_lut_gather(const uint8_t* table, const uint16_t* offsets, size_t count,
+                     size_t entry_bytes, uint8_t* out) {
+#if BLIT_USE_INTERP
+    if (blit_use_interp) {
+        blit_lut_gather_interp(table, offsets, count, entry_bytes, out);
+        return;
+    }
+#endif
+    blit_lut_gather_soft(table, offsets, count, entry_bytes, out);
+}
+
+// Cycles per call, from elapsed time and the system clock
+static uint32_t blit_cycles(uint64_t elapsed_us, uint32_t calls) {
+    return (uint32_t)(elapsed_us * (clock_get_hz(clk_sys) / 1000000) / calls);
+}
+
+static void blit_benchmark_mode(bool interp, const uint8_t* src, const uint16_t* offsets,
+                                uint8_t* upper, uint8_t* lower, uint8_t* gathered) {
+    const uint32_t calls = 1000;
+    blit_set_interp_enabled(interp);
+
+    uint64_t start = time_us_64();
+    for (uint32_t i = 0; i < calls; i++) {
+        blit_shift_split(src, 128, 1 + (i % 7), upper, lower);
+    }
+    uint32_t shift_cycles = blit_cycles(time_us_64() - start, calls);
+
+    start = time_us_64();
+    for (uint32_t i = 0; i < calls; i++) {
+        blit_lut_gather(src, offsets, 21, 6, gathered);
+    }
+    uint32_t lut_cycles = blit_cycles(time_us_64() - start, calls);
+
+    printf("Blit (%s): %u cycles per 128-column shifted copy, %u cycles per 21-glyph lookup\n",
+           interp ? "interp" : "software", shift_cycles, lut_cycles);
+}
+
+void blit_benchmark() {
+    static uint8_t src[128];
+    static uint16_t offsets[21];
+    static uint8_t upper[2][128];
+    static uint8_t lower[2][128];
+    static uint8_t gathered[2][21 * 6];
+
+    for (int i = 0; i < 128; i++) src[i] = (uint8_t)(i * 73 + 11);
+    for (int i = 0; i < 21; i++) offsets[i] = (uint16_t)((i * 5) % 20 * 6);
+
+    bool was_enabled = blit_interp_enabled();
+
+    blit_benchmark_mode(false, src, offsets, upper[0], lower[0], gathered[0]);
+#if BLIT_USE_INTERP
+    blit_benchmark_mode(true, src, offsets, upper[1], lower[1], gathered[1]);
+#endif
+
+#if BLIT_USE_INTERP
+    // Both versions must match byte for byte, for every shift
+    bool identical = true;
+    for (int shift = 1; shift < 8; shift++) {
+        blit_set_interp_enabled(false);
+        blit_shift_split(src, 128, shift, upper[0], lower[0]);
+        blit_lut_gather(src, offsets, 21, 6, gathered[0]);
+        blit_set_interp_enabled(true);
+        blit_shift_split(src, 128, shift, upper[1], lower[1]);
+        blit_lut_gather(src, offsets, 21, 6, gathered[1]);
+
+        identical = identical &&
+                    memcmp(upper[0], upper[1], sizeof(upper[0])) == 0 &&
+                    memcmp(lower[0], lower[1], sizeof(lower[0])) == 0 &&
+                    memcmp(gathered[0], gathered[1], sizeof(gathered[0])) == 0;
+    }
+    printf("Blit: interp and software output %s\n", identical ? "identical" : "DIFFERENT");
+#endif
+
+    blit_set_interp_enabled(was_enabled);
+}
@@ -0,0 +1,32 @@
+#ifndef BLIT_H
+#define BLIT_H
+
+#include "pico/stdlib.h"
+
+// Inner loops shared by the text renderer and gfx_blit(). Each kernel has an
+// interpolator version (interp0 of the calling core) and a plain C version
+// that produces identical output; the C version is always built, so the
+// kernels also run where no interpolator exists.
+#ifndef BLIT_USE_INTERP
+#define BLIT_USE_INTERP 1
+#endif
+
+// Runtime switch, mainly for benchmarking; on by default when built with
+// BLIT_USE_INTERP
+void blit_set_interp_enabled(bool enabled);
+bool blit_interp_enabled();
+
+// Shifted copy: each column byte moved down by shift (1-7) rows and split
+// across two pages: upper[i] = src[i] << shift, lower[i] = src[i] >> (8 - shift)
+void blit_shift_split(const uint8_t* src, size_t count, int shift, uint8_t* upper, uint8_t* lower);
+
+// Table lookup: copies entry_bytes bytes from table + offsets[i] for each i
+// into out, back to back
+void blit_lut_gather(const uint8_t* table, const uint16_t* offsets, size_t count,
+                     size_t entry_bytes, uint8_t* out);
+
+// Prints cycles per kernel call with and without the interpolator, and
+// checks that both versions agree
+void blit_benchmark();
+
+#endif // BLIT_H
@@ -1,21 +1,41 @@
 #include "core1_tasks.h"
 #include "shared_data.h"
+#include "render_pipeline.h"
 #include <stdio.h>
-#include "hardware/adc.h"
+#include "adc_dma.h"
+#include "adc_stream.h"
+#include "input_events.h"
 #include "hardware/gpio.h"
 #include "pico/time.h"
 
 // Core1 pin definitions
-const uint TEMP_ADC_PIN = 26;  // ADC0
 const uint LIGHT_ADC_PIN = 27; // ADC1
 
+// Conversions per second shared by the light and temperature sensors; the
+// ring (ADC_STREAM_ENTRIES) must hold the slowest loop's worth (500ms)
+#define CORE1_ADC_RATE_HZ 10000
+
+// Change thresholds: light in ADC counts, temperature in 1/100 degC. A
+// channel with no change for CORE1_IDLE_AFTER_MS is averaged and checked
+// less often; the ADC keeps converting it at the full rate regardless.
+#define CORE1_LIGHT_DEADBAND 24
+#define CORE1_TEMP_DEADBAND_CDEG 30
+#define CORE1_IDLE_AFTER_MS 3000
+
+static int core1_light_input = -1;
+static int core1_temp_input = -1;
+static uint32_t core1_sample_count = 0;   // Frames averaged so far
+static uint32_t core1_sample_rate_ms = 0; // Loop period, changed by CORE1_CMD_SAMPLE_RATE
+
 void core1_main() {
     printf("Core1: Starting up...\n");
     
-    // Initialize ADC for sensor reading
-    adc_init();
-    adc_gpio_init(TEMP_ADC_PIN);
-    adc_gpio_init(LIGHT_ADC_PIN);
+    // Light sensor and temperature sensor converted in turn into a DMA ring
+    adc_stream_start((1u << (LIGHT_ADC_PIN - 26)) | (1u << ADC_DMA_TEMP_INPUT), CORE1_ADC_RATE_HZ);
+    core1_light_input = input_add_channel("light", CORE1_LIGHT_DEADBAND, CORE1_IDLE_AFTER_MS);
+    core1_temp_input = input_add_channel("temp", CORE1_TEMP_DEADBAND_CDEG, CORE1_IDLE_AFTER_MS);
+    
+    get_control_data(nullptr, nullptr, &core1_sample_rate_ms);
     
     // Mark core1 as running
     g_shared_data.core1_running = true;
@@ -28,11 +48,17 @@ void core1_main() {
     while (core1_should_continue()) {
         loop_start = get_absolute_time();
         
+        // Requests from core0 first, so a new rate applies to this loop
+        core1_command_task();
+        
         // Execute core1 tasks
         core1_sensor_task();
         core1_processing_task();
         core1_communication_task();
         
+        // Rasterise and flush the newest scene from core0
+        render_pipeline_service();
+        
         // Update heartbeat
         core1_heartbeat_update();
         
@@ -46,41 +72,81 @@ void core1_main() {
         
         loop_count++;
         
-        // Get current sample rate from core0
-        uint32_t sample_rate_ms;
-        get_control_data(nullptr, nullptr, &sample_rate_ms);
-        
-        // Sleep for the configured sample rate
-        sleep_ms(sample_rate_ms);
+        // Sleep for the sample rate core0 last asked for
+        sleep_ms(core1_sample_rate_ms);
     }
     
     printf("Core1: Shutting down after %u loops\n", loop_count);
     g_shared_data.core1_running = false;
 }
 
+void core1_command_task() {
+    Core1Command command;
+    while (g_command_queue.pop(&command)) {
+        if (command.type == CORE1_CMD_SAMPLE_RATE) {
+            core1_sample_rate_ms = command.value;
+        }
+    }
+}
+
 void core1_sensor_task() {
-    static uint32_t sample_count = 0;
-    
-    // Read temperature from ADC (using internal temperature sensor)
-    adc_select_input(4); // Internal temperature sensor
-    uint16_t raw_temp = adc_read();
-    float temperature = 27.0f - (raw_temp * 3.3f / 4096.0f - 0.706f) / 0.001721f;
-    
-    // Read light level from external ADC
-    adc_select_input(1); // LIGHT_ADC_PIN (ADC1)
-    uint16_t light_level = adc_read();
+    static AdcBlock block;
+    uint32_t temp_sum = 0;
+    uint32_t light_sum = 0;
+    uint32_t frames = 0;
+    
+    input_scan_begin();
+    bool scan_temp = input_channel_due(core1_temp_input);
+    bool scan_light = input_channel_due(core1_light_input);
+    
+    // Average everything the ADC streamed since the last pass. Every input
+    // stays in the ADC's round robin, so an idle channel's samples are
+    // still converted and drained with the block, just not summed
+    while (adc_stream_read(&block) > 0) {
+        int temp = adc_stream_row(&block, ADC_DMA_TEMP_INPUT);
+        int light = adc_stream_row(&block, LIGHT_ADC_PIN - 26);
+        for (uint16_t f = 0; scan_temp && f < block.frames; f++) {
+            temp_sum += block.samples[temp][f];
+        }
+        for (uint16_t f = 0; scan_light && f < block.frames; f++) {
+            light_sum += block.samples[light][f];
+        }
+        frames += block.frames;
+    }
     
-    // Update shared data with new sensor readings
-    sample_count++;
-    set_sensor_data(temperature, light_level, sample_count);
+    if (frames > 0) {
+        core1_sample_count += frames;
+        if (scan_temp) {
+            float raw_temp = (float)temp_sum / frames;
+            float temperature = 27.0f - (raw_temp * 3.3f / 4096.0f - 0.706f) / 0.001721f;
+            input_update(core1_temp_input, (int32_t)(temperature * 100.0f));
+        }
+        if (scan_light) {
+            input_update(core1_light_input, (int32_t)(light_sum / frames));
+        }
+    }
+    input_scan_end();
 }
 
 void core1_processing_task() {
-    // Get current sensor data for processing
+    // Only changes reach core0: the shared data (and with it the display)
+    // is updated when an input moved past its deadband
     float temperature;
     uint16_t light_level;
-    uint32_t sample_count;
-    get_sensor_data(&temperature, &light_level, &sample_count);
+    get_sensor_data(&temperature, &light_level, nullptr);
+    
+    InputEvent event;
+    bool changed = false;
+    while (input_next_event(&event)) {
+        if (event.channel == core1_temp_input) {
+            temperature = event.value / 100.0f;
+        } else if (event.channel == core1_light_input) {
+            light_level = (uint16_t)event.value;
+        }
+        changed = true;
+    }
+    if (!changed) return;
+    set_sensor_data(temperature, light_level, core1_sample_count);
     
     // Example processing: Adaptive brightness based on light and temperature
     uint8_t calculated_brightness = 255;
@@ -101,10 +167,13 @@ void core1_processing_task() {
     
     // Update control data with processed values
     bool led_enable = true;
+    uint8_t current_brightness;
     uint32_t current_rate_ms;
-    get_control_data(&led_enable, nullptr, &current_rate_ms);
+    get_control_data(&led_enable, &current_brightness, &current_rate_ms);
     
-    set_control_data(led_enable, calculated_brightness, current_rate_ms);
+    if (calculated_brightness != current_brightness) {
+        set_control_data(led_enable, calculated_brightness, current_rate_ms);
+    }
 }
 
 void core1_communication_task() {
@@ -116,17 +185,15 @@ void core1_communication_task() {
     if (current_time - last_report > 5000) {
         float temperature;
         uint16_t light_level;
-        uint32_t sample_count;
-        get_sensor_data(&temperature, &light_level, &sample_count);
+        get_sensor_data(&temperature, &light_level, nullptr);
         
         printf("Core1 Report: Temp=%.1f°C, Light=%d, Samples=%u\n", 
-               temperature, light_level, sample_count);
+               temperature, light_level, core1_sample_count);
+        adc_stream_print_stats();
+        input_print_stats();
         
         last_report = current_time;
     }
-    
-    // Signal that data is ready for core0 to process
-    sem_release(&g_sync.data_ready_sem);
 }
 
 void core1_heartbeat_update() {
@@ -7,6 +7,7 @@
 void core1_main();
 
 // Core1 task functions
+void core1_command_task();
 void core1_sensor_task();
 void core1_processing_task();
 void core1_communication_task();
@@ -0,0 +1,270 @@
+#include "debounce.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+
+#define DEBOUNCE_QUEUE_MASK (DEBOUNCE_QUEUE_SIZE - 1)
+#define DEBOUNCE_EDGES (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)
+
+struct DebounceBank {
+    uint32_t state;          // Debounced, 1 = pressed
+    uint32_t cnt0;           // Vertical counter, low bit of every lane
+    uint32_t cnt1;           // ... high bit
+    uint32_t invert;         // Lanes that read low when pressed
+    uint32_t mask;           // Lanes in use
+    uint32_t pending;        // Lanes with a first edge recorded for the current run
+    uint32_t edge_us[32];
+};
+
+static DebounceBank debounce_banks[DEBOUNCE_MAX_BANKS];
+static uint8_t debounce_bank_count = 0;
+static int debounce_gpio_bank = -1;
+static bool debounce_started = false;
+
+static repeating_timer_t debounce_timer;
+static volatile bool debounce_ticking = false;
+static uint32_t debounce_idle_ticks = 0;
+
+static DebounceEvent debounce_queue[DEBOUNCE_QUEUE_SIZE];
+static volatile uint32_t debounce_queue_head = 0;   // Next slot to write
+static volatile uint32_t debounce_queue_tail = 0;   // Next slot to read
+
+static DebounceStats debounce_stats = {0, 0, 0, 0, UINT32_MAX, 0, 0};
+
+// The whole debouncer: each lane's 2-bit counter advances on every tick the
+// raw level disagrees with the state and clears on any tick it agrees. The
+// fourth disagreeing tick wraps it to zero and flips the state.
+static inline uint32_t debounce_tick_bank(DebounceBank* b, uint32_t sample) {
+    uint32_t delta = (sample ^ b->invert ^ b->state) & b->mask;
+    b->cnt1 = (b->cnt1 ^ b->cnt0) & delta;
+    b->cnt0 = ~b->cnt0 & delta;
+    uint32_t toggle = delta & ~(b->cnt0 | b->cnt1);
+    b->state ^= toggle;
+    return toggle;
+}
+
+static void debounce_emit(uint8_t bank, uint32_t toggle, uint32_t now) {
+    const DebounceBank* b = &debounce_banks[bank];
+
+    while (toggle) {
+        uint bit = __builtin_ctz(toggle);
+        toggle &= toggle - 1;
+
+        uint32_t latency = now - b->edge_us[bit];
+        debounce_stats.events++;
+        debounce_stats.total_latency_us += latency;
+        if (latency < debounce_stats.min_latency_us) debounce_stats.min_latency_us = latency;
+        if (latency > debounce_stats.max_latency_us) debounce_stats.max_latency_us = latency;
+
+        if (debounce_queue_head - debounce_queue_tail >= DEBOUNCE_QUEUE_SIZE) {
+            debounce_stats.dropped++;
+            continue;
+        }
+        DebounceEvent* event = &debounce_queue[debounce_queue_head & DEBOUNCE_QUEUE_MASK];
+        event->edge_us = b->edge_us[bit];
+        event->timestamp_us = now;
+        event->input = (uint8_t)(bank * 32 + bit);
+        event->pressed = (b->state >> bit) & 1;
+        debounce_queue_head++;
+    }
+}
+
+// One tick plus edge bookkeeping: the common case (nothing moving) costs
+// the counter update and two tests
+static void debounce_process(uint8_t bank, uint32_t sample, uint32_t now) {
+    DebounceBank* b = &debounce_banks[bank];
+    uint32_t toggle = debounce_tick_bank(b, sample);
+    uint32_t counting = b->cnt0 | b->cnt1;
+    debounce_stats.ticks++;
+
+    // First disagreeing tick of a run is its edge, unless an interrupt saw it earlier
+    uint32_t started = (counting | toggle) & ~b->pending;
+    while (started) {
+        uint bit = __builtin_ctz(started);
+        started &= started - 1;
+        b->edge_us[bit] = now;
+        b->pending |= 1u << bit;
+    }
+    if (toggle) debounce_emit(bank, toggle, now);
+
+    // Accepted, or bounced back: the next run records a new edge
+    b->pending &= counting;
+}
+
+static bool debounce_timer_callback(repeating_timer_t* timer) {
+    DebounceBank* b = &debounce_banks[debounce_gpio_bank];
+    debounce_process((uint8_t)debounce_gpio_bank, gpio_get_all(), time_us_32());
+
+    // Settled for a while: stop until the next edge interrupt
+    if ((b->pending | b->cnt0 | b->cnt1) == 0) {
+        if (++debounce_idle_ticks >= DEBOUNCE_IDLE_TICKS) {
+            debounce_ticking = false;
+            return false;
+        }
+    } else {
+        debounce_idle_ticks = 0;
+    }
+    return true;
+}
+
+static void debounce_start_timer() {
+    debounce_ticking = true;
+    debounce_idle_ticks = 0;
+    add_repeating_timer_us(-DEBOUNCE_TICK_US, debounce_timer_callback, nullptr, &debounce_timer);
+}
+
+// Records when a pin first moved and wakes the timer; the timer and this
+// handler share a priority, so neither interrupts the other
+static void debounce_gpio_irq_handler() {
+    DebounceBank* b = &debounce_banks[debounce_gpio_bank];
+    uint32_t now = time_us_32();
+
+    uint32_t pins = b->mask;
+    while (pins) {
+        uint pin = __builtin_ctz(pins);
+        pins &= pins - 1;
+
+        uint32_t events = gpio_get_irq_event_mask(pin) & DEBOUNCE_EDGES;
+        if (!events) continue;
+        gpio_acknowledge_irq(pin, events);
+        if (!(b->pending & (1u << pin))) {
+            b->edge_us[pin] = now;
+            b->pending |= 1u << pin;
+        }
+    }
+
+    if (!debounce_ticking) {
+        debounce_stats.wakeups++;
+        debounce_start_timer();
+    }
+}
+
+static int debounce_new_bank(uint32_t mask, uint32_t invert) {
+    if (debounce_started || debounce_bank_count >= DEBOUNCE_MAX_BANKS) return -1;
+
+    DebounceBank* b = &debounce_banks[debounce_bank_count];
+    memset(b, 0, sizeof(*b));
+    b->mask = mask;
+    b->invert = invert & mask;
+    return debounce_bank_count++;
+}
+
+int debounce_add_gpio(uint pin, bool active_low) {
+    if (pin >= 32) return -1;
+    if (debounce_gpio_bank < 0) {
+        debounce_gpio_bank = debounce_new_bank(0, 0);
+        if (debounce_gpio_bank < 0) return -1;
+    }
+    if (debounce_started) return -1;
+
+    DebounceBank* b = &debounce_banks[debounce_gpio_bank];
+    b->mask |= 1u << pin;
+    if (active_low) b->invert |= 1u << pin;
+    return debounce_gpio_bank * 32 + pin;
+}
+
+int debounce_add_bank(uint32_t active_low_mask) {
+    return debounce_new_bank(0xFFFFFFFFu, active_low_mask);
+}
+
+bool debounce_start() {
+    if (debounce_started) return false;
+    debounce_started = true;
+    if (debounce_gpio_bank < 0) return true;
+
+    // Pins start out at their current level: no events for switches already held
+    DebounceBank* b = &debounce_banks[debounce_gpio_bank];
+    b->state = (gpio_get_all() ^ b->invert) & b->mask;
+
+    gpio_add_raw_irq_handler_masked(b->mask, debounce_gpio_irq_handler);
+    for (uint pin = 0; pin < 32; pin++) {
+        if (b->mask & (1u << pin)) gpio_set_irq_enabled(pin, DEBOUNCE_EDGES, true);
+    }
+    irq_set_enabled(IO_IRQ_BANK0, true);
+    debounce_start_timer();
+    return true;
+}
+
+void debounce_feed(int bank, uint32_t sample) {
+    if (bank < 0 || bank >= debounce_bank_count || bank == debounce_gpio_bank) return;
+
+    // The GPIO timer also writes the queue
+    uint32_t irq = save_and_disable_interrupts();
+    debounce_process((uint8_t)bank, sample, time_us_32());
+    restore_interrupts(irq);
+}
+
+bool debounce_next_event(DebounceEvent* event) {
+    if (debounce_queue_tail == debounce_queue_head) return false;
+
+    *event = debounce_queue[debounce_queue_tail & DEBOUNCE_QUEUE_MASK];
+    debounce_queue_tail++;
+    return true;
+}
+
+bool debounce_pressed(uint input) {
+    if (input / 32 >= debounce_bank_count) return false;
+    return (debounce_banks[input / 32].state >> (input % 32)) & 1;
+}
+
+uint32_t debounce_bank_state(int bank) {
+    if (bank < 0 || bank >= debounce_bank_count) return 0;
+    return debounce_banks[bank].state;
+}
+
+const DebounceStats* debounce_get_stats() {
+    return &debounce_stats;
+}
+
+void debounce_print_stats() {
+    const DebounceStats* stats = &debounce_stats;
+    uint32_t avg = stats->events ? (uint32_t)(stats->total_latency_us / stats->events) : 0;
+
+    printf("  Debounce: %u events (%u dropped), edge to event min %uus avg %uus max %uus, "
+           "%u ticks, %u timer wakeups\n",
+           stats->events, stats->dropped, stats->events ? stats->min_latency_us : 0, avg,
+           stats->max_latency_us, stats->ticks, stats->wakeups);
+}
+
+void debounce_benchmark() {
+    static DebounceBank banks[DEBOUNCE_MAX_BANKS];
+    const uint32_t ticks = 10000;
+    uint32_t toggled = 0;
+
+    for (int i = 0; i < DEBOUNCE_MAX_BANKS; i++) {
+        memset(&banks[i], 0, sizeof(banks[i]));
+        banks[i].mask = 0xFFFFFFFFu;
+    }
+
+    // Noisy samples so lanes keep counting and toggling; the noise generator
+    // alone is timed separately and subtracted
+    uint32_t noise = 1;
+    uint64_t start = time_us_64();
+    for (uint32_t t = 0; t < ticks; t++) {
+        noise = noise * 1664525u + 1013904223u;
+        for (int i = 0; i < DEBOUNCE_MAX_BANKS; i++) {
+            toggled += __builtin_popcount(debounce_tick_bank(&banks[i], noise & (noise >> (i + 1))));
+        }
+    }
+    uint64_t with_ticks = time_us_64() - start;
+
+    volatile uint32_t sink = 0;
+    noise = 1;
+    start = time_us_64();
+    for (uint32_t t = 0; t < ticks; t++) {
+        noise = noise * 1664525u + 1013904223u;
+        for (int i = 0; i < DEBOUNCE_MAX_BANKS; i++) {
+            sink = sink + (noise & (noise >> (i + 1)));
+        }
+    }
+    uint64_t baseline = time_us_64() - start;
+
+    uint64_t elapsed = with_ticks > baseline ? with_ticks - baseline : 0;
+    uint32_t cycles = (uint32_t)(elapsed * (clock_get_hz(clk_sys) / 1000000) / (ticks * DEBOUNCE_MAX_BANKS));
+    printf("Debounce: %u cycles per 32-input bank tick, %u inputs in %u cycles (%u toggles)\n",
+           cycles, DEBOUNCE_MAX_BANKS * 32, cycles * DEBOUNCE_MAX_BANKS, toggled);
+}
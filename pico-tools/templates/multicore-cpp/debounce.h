@@ -0,0 +1,65 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include "pico/stdlib.h"
+
+// Switch debouncing with vertical counters: each bank holds 32 inputs as
+// bit lanes, and one tick updates a 2-bit counter per input with a few
+// word-wide logic operations. An input changes state after
+// DEBOUNCE_TICKS consecutive samples that disagree with it; a bounce back
+// resets its counter.
+//
+// The GPIO bank samples all its pins at once from a repeating timer. The
+// timer stops when every pin is settled, and an edge interrupt on any pin
+// restarts it and records when the input first moved. Other banks (a key
+// matrix, a mux scan) are fed one sample per tick with debounce_feed().
+// Events carry both the first edge and the time the change was accepted,
+// so press-to-event latency is measured for every event.
+//
+// All banks must be ticked on the core that called debounce_start().
+#define DEBOUNCE_MAX_BANKS 4
+#define DEBOUNCE_TICKS 4              // Fixed by the 2-bit counters
+#define DEBOUNCE_TICK_US 1000         // GPIO bank: 4ms to accept a change
+#define DEBOUNCE_IDLE_TICKS 16        // Settled ticks before the GPIO timer stops
+#define DEBOUNCE_QUEUE_SIZE 64        // Events waiting for the consumer (power of two)
+
+// input = bank * 32 + bit; for the GPIO bank the bit is the pin number
+struct DebounceEvent {
+    uint32_t edge_us;        // First sample (or edge interrupt) of the accepted change
+    uint32_t timestamp_us;   // Change accepted
+    uint8_t input;
+    bool pressed;
+};
+
+struct DebounceStats {
+    uint32_t ticks;          // Bank ticks, all banks
+    uint32_t wakeups;        // GPIO timer restarts from an edge interrupt
+    uint32_t events;
+    uint32_t dropped;        // Events lost to a full queue
+    uint32_t min_latency_us; // Edge to accepted change
+    uint32_t max_latency_us;
+    uint64_t total_latency_us;
+};
+
+// Setup: returns the input number, or -1. active_low inputs read as
+// pressed when low (pull-up and a switch to ground).
+int debounce_add_gpio(uint pin, bool active_low);
+int debounce_add_bank(uint32_t active_low_mask);  // Returns the bank for debounce_feed()
+bool debounce_start();
+
+// One tick of a fed bank: bit n of sample is the raw level of input n
+void debounce_feed(int bank, uint32_t sample);
+
+// Consumer: false when no event is waiting
+bool debounce_next_event(DebounceEvent* event);
+bool debounce_pressed(uint input);
+uint32_t debounce_bank_state(int bank);   // Debounced, 1 = pressed
+
+// Statistics
+const DebounceStats* debounce_get_stats();
+void debounce_print_stats();
+
+// Prints cycles per bank tick over all DEBOUNCE_MAX_BANKS banks
+void debounce_benchmark();
+
+#endif // DEBOUNCE_H
@@ -0,0 +1,183 @@
+#include "display.h"
+#include <stdio.h>
+#include <string.h>
+#include "hardware/i2c.h"
+#include "hardware/gpio.h"
+
+// Display configuration (example for SSD1306 OLED)
+#define DISPLAY_I2C i2c1
+#define DISPLAY_ADDR 0x3C
+#define DISPLAY_SDA 6
+#define DISPLAY_SCL 7
+
+// A panel that fails this many writes in a row is taken offline and
+// re-probed from display_flush() with a doubling interval
+#define DISPLAY_OFFLINE_AFTER 3
+#define DISPLAY_PROBE_MIN_MS 100   // First re-probe after going offline
+#define DISPLAY_PROBE_MAX_MS 2000  // Re-probe interval doubles up to this
+
+// Bounded wait for a write of len bytes: a fixed allowance plus one byte
+// time at 100kHz (90us) with margin for each byte and the address
+#define DISPLAY_TIMEOUT_US(len) (1000u + ((uint)(len) + 1) * 100u)
+
+static bool display_present = false;   // Online: answering writes
+static uint8_t display_failures = 0;   // Consecutive failed writes
+static uint32_t display_next_probe_ms = 0;
+static uint32_t display_probe_interval_ms = 0;
+
+// Back buffer: local copy of panel RAM; only changed column windows are sent
+static Framebuffer display_fb;
+
+// SSD1306 init sequence, sent as one command stream (0x00 control byte)
+static const uint8_t display_init_commands[] = {
+    0x00,       // Command stream
+    0xAE,       // Display off
+    0xD5, 0x80, // Set display clock divide
+    0xA8, 0x3F, // Set multiplex ratio
+    0xD3, 0x00, // Set display offset
+    0x40,       // Set start line
+    0x8D, 0x14, // Charge pump
+    0x20, 0x00, // Memory mode
+    0xA1,       // Set segment re-map
+    0xC8,       // Set COM output scan direction
+    0xDA, 0x12, // Set COM pins
+    0x81, 0xCF, // Set contrast
+    0xD9, 0xF1, // Set pre-charge
+    0xDB, 0x40, // Set VCOM detect
+    0xA4,       // Entire display on
+    0xA6,       // Set normal display
+    0xAF        // Display on
+};
+
+static uint32_t display_now_ms() {
+    return (uint32_t)(time_us_64() / 1000);
+}
+
+static void display_mark_offline() {
+    display_present = false;
+    display_probe_interval_ms = DISPLAY_PROBE_MIN_MS;
+    display_next_probe_ms = display_now_ms() + DISPLAY_PROBE_MIN_MS;
+}
+
+// Every write is bounded; a run of failures takes the panel offline so
+// later flushes return without touching the bus
+static bool display_write(const uint8_t* src, size_t len) {
+    int result = i2c_write_timeout_us(DISPLAY_I2C, DISPLAY_ADDR, src, len, false, DISPLAY_TIMEOUT_US(len));
+    if (result >= 0) {
+        display_failures = 0;
+        return true;
+    }
+
+    if (display_present && ++display_failures >= DISPLAY_OFFLINE_AFTER) {
+        printf("Display at 0x%02X went offline\n", DISPLAY_ADDR);
+        display_mark_offline();
+    }
+    return false;
+}
+
+static bool display_probe() {
+    uint8_t control = 0x00; // Empty command stream
+    return i2c_write_timeout_us(DISPLAY_I2C, DISPLAY_ADDR, &control, 1, false, DISPLAY_TIMEOUT_US(1)) >= 0;
+}
+
+// A panel that (re)appears has unknown RAM and configuration: set it up
+// and resend the whole framebuffer on the next flush
+static void display_setup() {
+    display_present = true;
+    display_failures = 0;
+    display_write(display_init_commands, sizeof(display_init_commands));
+    fb_mark_all_dirty(&display_fb);
+}
+
+// One probe once the interval has passed, doubling it on every miss
+static void display_reprobe() {
+    uint32_t now = display_now_ms();
+    if ((int32_t)(now - display_next_probe_ms) < 0) return;
+
+    if (!display_probe()) {
+        display_probe_interval_ms *= 2;
+        if (display_probe_interval_ms > DISPLAY_PROBE_MAX_MS) {
+            display_probe_interval_ms = DISPLAY_PROBE_MAX_MS;
+        }
+        display_next_probe_ms = now + display_probe_interval_ms;
+        return;
+    }
+
+    printf("Display at 0x%02X back online, re-initialising\n", DISPLAY_ADDR);
+    display_setup();
+}
+
+// Address one dirty window with the column/page range commands, then
+// stream just those columns. Returns the bytes sent, or 0 if a write failed.
+static uint32_t display_send_window(const FramebufferWindow* window) {
+    uint8_t addr_cmd[] = {
+        0x00,                               // Command stream
+        0x21, window->start, window->end,   // Column address range
+        0x22, window->page, window->page    // Page address range
+    };
+    if (!display_write(addr_cmd, sizeof(addr_cmd))) return 0;
+
+    uint8_t data[1 + FB_WIDTH];
+    data[0] = 0x40; // Data mode
+    memcpy(&data[1], window->data, window->length);
+    if (!display_write(data, window->length + 1)) return 0;
+
+    return sizeof(addr_cmd) + window->length + 1;
+}
+
+void display_init() {
+    i2c_init(DISPLAY_I2C, 400000); // 400kHz
+    gpio_set_function(DISPLAY_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(DISPLAY_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(DISPLAY_SDA);
+    gpio_pull_up(DISPLAY_SCL);
+
+    fb_init(&display_fb);
+
+    // Test if display is connected; if not, flushes keep probing for it
+    if (!display_probe()) {
+        printf("No display found at 0x%02X (will keep probing)\n", DISPLAY_ADDR);
+        display_mark_offline();
+        return;
+    }
+
+    printf("Display connected at 0x%02X\n", DISPLAY_ADDR);
+    display_setup();
+    display_flush(); // Every page is dirty, so this clears the panel
+}
+
+bool display_available() {
+    return display_present;
+}
+
+Framebuffer* display_get_framebuffer() {
+    return &display_fb;
+}
+
+void display_flush() {
+    if (!display_present) {
+        display_reprobe();
+        if (!display_present) return;
+    }
+
+    uint32_t bytes = 0;
+    uint32_t windows = 0;
+    FramebufferWindow window;
+
+    while (fb_next_window(&display_fb, &window)) {
+        uint32_t sent = display_send_window(&window);
+        if (sent == 0) {
+            // Panel RAM no longer matches: resend everything next time
+            fb_mark_all_dirty(&display_fb);
+            break;
+        }
+        bytes += sent;
+        windows++;
+    }
+
+    fb_record_flush(&display_fb, bytes, windows);
+}
+
+const FramebufferStats* display_get_stats() {
+    return &display_fb.stats;
+}
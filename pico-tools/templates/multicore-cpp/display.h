@@ -0,0 +1,22 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include "pico/stdlib.h"
+#include "framebuffer.h"
+
+// SSD1306 on i2c1 with blocking writes. Flushes can take milliseconds, so
+// only call display_flush() from the core that owns rendering (see
+// render_pipeline.h); drawing goes into the framebuffer first.
+//
+// Every write has a timeout. A panel that stops answering is marked
+// offline, and display_flush() re-probes it with a growing interval
+// instead of writing; when it answers it is set up and fully redrawn.
+void display_init();
+bool display_available();   // Panel currently online
+
+// Framebuffer access: draw into the framebuffer, then flush the changed windows
+Framebuffer* display_get_framebuffer();
+void display_flush();
+const FramebufferStats* display_get_stats();
+
+#endif // DISPLAY_H
@@ -0,0 +1,163 @@
+#include "framebuffer.h"
+#include <string.h>
+
+void fb_init(Framebuffer* fb) {
+    memset(fb, 0, sizeof(Framebuffer));
+
+    // Panel RAM content is unknown after power-up, so the first flush sends everything
+    fb_mark_all_dirty(fb);
+}
+
+void fb_clear(Framebuffer* fb) {
+    fb_fill(fb, 0x00);
+}
+
+void fb_fill(Framebuffer* fb, uint8_t pattern) {
+    for (uint8_t page = 0; page < FB_PAGES; page++) {
+        uint8_t* row = fb->pixels[page];
+
+        // Find the changed span so unchanged pages stay clean
+        int first = -1;
+        int last = -1;
+        for (int x = 0; x < FB_WIDTH; x++) {
+            if (row[x] != pattern) {
+                if (first < 0) first = x;
+                last = x;
+            }
+        }
+
+        if (first >= 0) {
+            memset(&row[first], pattern, last - first + 1);
+            fb_mark_dirty(fb, page, (uint8_t)first, (uint8_t)last);
+        }
+    }
+}
+
+void fb_set_pixel(Framebuffer* fb, int x, int y, bool on) {
+    if (x < 0 || x >= FB_WIDTH || y < 0 || y >= FB_HEIGHT) return;
+
+    uint8_t page = (uint8_t)(y >> 3);
+    uint8_t mask = (uint8_t)(1u << (y & 7));
+    uint8_t old_value = fb->pixels[page][x];
+    uint8_t new_value = on ? (old_value | mask) : (old_value & ~mask);
+
+    if (new_value != old_value) {
+        fb->pixels[page][x] = new_value;
+        fb_mark_dirty(fb, page, (uint8_t)x, (uint8_t)x);
+    }
+}
+
+bool fb_get_pixel(const Framebuffer* fb, int x, int y) {
+    if (x < 0 || x >= FB_WIDTH || y < 0 || y >= FB_HEIGHT) return false;
+    return (fb->pixels[y >> 3][x] >> (y & 7)) & 1;
+}
+
+void fb_write(Framebuffer* fb, uint8_t page, uint8_t x, const uint8_t* data, size_t length) {
+    if (page >= FB_PAGES || x >= FB_WIDTH) return;
+    if (length > (size_t)(FB_WIDTH - x)) length = FB_WIDTH - x;
+
+    uint8_t* row = fb->pixels[page];
+    int first = -1;
+    int last = -1;
+
+    for (size_t i = 0; i < length; i++) {
+        if (row[x + i] != data[i]) {
+            row[x + i] = data[i];
+            if (first < 0) first = (int)(x + i);
+            last = (int)(x + i);
+        }
+    }
+
+    if (first >= 0) {
+        fb_mark_dirty(fb, page, (uint8_t)first, (uint8_t)last);
+    }
+}
+
+// Like fb_write(), but only the bits set in mask are replaced; the rest of
+// each page byte keeps its current pixels
+void fb_write_masked(Framebuffer* fb, uint8_t page, uint8_t x, const uint8_t* data, uint8_t mask, size_t length) {
+    if (page >= FB_PAGES || x >= FB_WIDTH) return;
+    if (length > (size_t)(FB_WIDTH - x)) length = FB_WIDTH - x;
+
+    uint8_t* row = fb->pixels[page];
+    int first = -1;
+    int last = -1;
+
+    for (size_t i = 0; i < length; i++) {
+        uint8_t value = (uint8_t)((row[x + i] & ~mask) | (data[i] & mask));
+        if (row[x + i] != value) {
+            row[x + i] = value;
+            if (first < 0) first = (int)(x + i);
+            last = (int)(x + i);
+        }
+    }
+
+    if (first >= 0) {
+        fb_mark_dirty(fb, page, (uint8_t)first, (uint8_t)last);
+    }
+}
+
+void fb_mark_dirty(Framebuffer* fb, uint8_t page, uint8_t start, uint8_t end) {
+    if (page >= FB_PAGES || start > end) return;
+    if (end >= FB_WIDTH) end = FB_WIDTH - 1;
+
+    uint8_t bit = (uint8_t)(1u << page);
+    if (fb->dirty_pages & bit) {
+        // Grow the existing window to cover the new span
+        if (start < fb->dirty_start[page]) fb->dirty_start[page] = start;
+        if (end > fb->dirty_end[page]) fb->dirty_end[page] = end;
+    } else {
+        fb->dirty_pages |= bit;
+        fb->dirty_start[page] = start;
+        fb->dirty_end[page] = end;
+    }
+}
+
+void fb_mark_all_dirty(Framebuffer* fb) {
+    for (uint8_t page = 0; page < FB_PAGES; page++) {
+        fb_mark_dirty(fb, page, 0, FB_WIDTH - 1);
+    }
+}
+
+bool fb_is_dirty(const Framebuffer* fb) {
+    return fb->dirty_pages != 0;
+}
+
+// What the next flush will cost on the bus, before it is sent
+uint32_t fb_dirty_bytes(const Framebuffer* fb) {
+    uint32_t bytes = 0;
+    for (uint8_t page = 0; page < FB_PAGES; page++) {
+        if (fb->dirty_pages & (1u << page)) {
+            bytes += FB_WINDOW_OVERHEAD_BYTES + fb->dirty_end[page] - fb->dirty_start[page] + 1;
+        }
+    }
+    return bytes;
+}
+
+bool fb_next_window(Framebuffer* fb, FramebufferWindow* window) {
+    if (fb->dirty_pages == 0) return false;
+
+    // Lowest dirty page first, matching the panel's natural page order
+    uint8_t page = 0;
+    while (!(fb->dirty_pages & (1u << page))) {
+        page++;
+    }
+
+    window->page = page;
+    window->start = fb->dirty_start[page];
+    window->end = fb->dirty_end[page];
+    window->data = &fb->pixels[page][window->start];
+    window->length = (uint8_t)(window->end - window->start + 1);
+
+    fb->dirty_pages &= (uint8_t)~(1u << page);
+    return true;
+}
+
+void fb_record_flush(Framebuffer* fb, uint32_t bytes, uint32_t windows) {
+    if (windows == 0) return;
+
+    fb->stats.frames++;
+    fb->stats.last_frame_bytes = bytes;
+    fb->stats.last_frame_windows = windows;
+    fb->stats.total_bytes += bytes;
+}
@@ -0,0 +1,214 @@
+#include "gfx.h"
+#include "blit.h"
+#include <stdio.h>
+#include <string.h>
+
+// Clips [start, start + length) to [0, limit); false if nothing is left
+static bool gfx_clip(int* start, int* length, int limit) {
+    if (*start < 0) {
+        *length += *start;
+        *start = 0;
+    }
+    if (*start + *length > limit) *length = limit - *start;
+    return *length > 0;
+}
+
+// Rows [y, y + h) as a bit mask over the whole column, bit n = row n
+static uint64_t gfx_column_mask(int y, int h) {
+    uint64_t rows = (h >= 64) ? ~0ull : ((1ull << h) - 1);
+    return rows << y;
+}
+
+// Sets (or clears) the mask bits of columns [x0, x1] in one page, four
+// columns per 32-bit word, marking only the changed columns dirty
+static void gfx_apply_mask(Framebuffer* fb, uint8_t page, int x0, int x1, uint8_t mask, bool on) {
+    uint8_t* row = fb->pixels[page];
+    int first = -1;
+    int last = -1;
+    int x = x0;
+
+    // Leading bytes up to a word boundary
+    for (; x <= x1 && (x & 3); x++) {
+        uint8_t value = on ? (uint8_t)(row[x] | mask) : (uint8_t)(row[x] & ~mask);
+        if (value != row[x]) {
+            row[x] = value;
+            if (first < 0) first = x;
+            last = x;
+        }
+    }
+
+    uint32_t mask32 = mask * 0x01010101u;
+    for (; x + 3 <= x1; x += 4) {
+        uint32_t word;
+        memcpy(&word, &row[x], 4);
+        uint32_t value = on ? (word | mask32) : (word & ~mask32);
+        uint32_t diff = value ^ word;
+        if (!diff) continue;
+
+        memcpy(&row[x], &value, 4);
+        // Little endian: the lowest changed byte is the leftmost column
+        if (first < 0) first = x + (__builtin_ctz(diff) >> 3);
+        last = x + 3 - (__builtin_clz(diff) >> 3);
+    }
+
+    for (; x <= x1; x++) {
+        uint8_t value = on ? (uint8_t)(row[x] | mask) : (uint8_t)(row[x] & ~mask);
+        if (value != row[x]) {
+            row[x] = value;
+            if (first < 0) first = x;
+            last = x;
+        }
+    }
+
+    if (first >= 0) {
+        fb_mark_dirty(fb, page, (uint8_t)first, (uint8_t)last);
+    }
+}
+
+void gfx_fill_rect(Framebuffer* fb, int x, int y, int w, int h, bool on) {
+    if (!gfx_clip(&x, &w, FB_WIDTH) || !gfx_clip(&y, &h, FB_HEIGHT)) return;
+
+    uint64_t mask = gfx_column_mask(y, h);
+    for (int page = y >> 3; page <= (y + h - 1) >> 3; page++) {
+        gfx_apply_mask(fb, (uint8_t)page, x, x + w - 1, (uint8_t)(mask >> (page * 8)), on);
+    }
+}
+
+void gfx_hline(Framebuffer* fb, int x, int y, int w, bool on) {
+    gfx_fill_rect(fb, x, y, w, 1, on);
+}
+
+void gfx_vline(Framebuffer* fb, int x, int y, int h, bool on) {
+    gfx_fill_rect(fb, x, y, 1, h, on);
+}
+
+void gfx_rect(Framebuffer* fb, int x, int y, int w, int h, bool on) {
+    if (w <= 0 || h <= 0) return;
+
+    gfx_hline(fb, x, y, w, on);
+    gfx_hline(fb, x, y + h - 1, w, on);
+    gfx_vline(fb, x, y + 1, h - 2, on);
+    gfx_vline(fb, x + w - 1, y + 1, h - 2, on);
+}
+
+void gfx_bar(Framebuffer* fb, int x, int y, int w, int h, uint32_t value, uint32_t max) {
+    if (w < 3 || h < 3) return;
+
+    int inner = w - 2;
+    int filled = max ? (int)((uint64_t)(value < max ? value : max) * inner / max) : 0;
+
+    gfx_rect(fb, x, y, w, h, true);
+    gfx_fill_rect(fb, x + 1, y + 1, filled, h - 2, true);
+    gfx_fill_rect(fb, x + 1 + filled, y + 1, inner - filled, h - 2, false);
+}
+
+void gfx_blit(Framebuffer* fb, int x, int y, const uint8_t* bitmap, int w, int h) {
+    int stride = w;
+    int src_x = x < 0 ? -x : 0;
+    int dst_y = y;
+    int dst_h = h;
+    if (!gfx_clip(&x, &w, FB_WIDTH) || !gfx_clip(&dst_y, &dst_h, FB_HEIGHT)) return;
+
+    int src_pages = (h + 7) / 8;
+    uint64_t mask = gfx_column_mask(dst_y, dst_h);
+
+    // Single-page sprites (icons, glyphs): one shifted copy split across at
+    // most two pages
+    if (src_pages == 1) {
+        const uint8_t* src = bitmap + src_x;
+        int shift = y & 7;
+        int page = (y - shift) / 8;
+
+        if (shift == 0) {
+            fb_write_masked(fb, (uint8_t)page, (uint8_t)x, src, (uint8_t)(mask >> (page * 8)), (size_t)w);
+            return;
+        }
+
+        uint8_t upper[FB_WIDTH];
+        uint8_t lower[FB_WIDTH];
+        blit_shift_split(src, (size_t)w, shift, upper, lower);
+        if (page >= 0) {
+            fb_write_masked(fb, (uint8_t)page, (uint8_t)x, upper, (uint8_t)(mask >> (page * 8)), (size_t)w);
+        }
+        if (page + 1 < FB_PAGES) {
+            fb_write_masked(fb, (uint8_t)(page + 1), (uint8_t)x, lower, (uint8_t)(mask >> ((page + 1) * 8)), (size_t)w);
+        }
+        return;
+    }
+
+    // Each source column is gathered into one 64-bit word, shifted to its
+    // destination row and split back into pages; the row mask keeps the
+    // pixels outside the bitmap (and off screen) untouched. Only the pages
+    // that reach the screen are gathered: FB_PAGES of them from the first
+    // visible one, so the word starts at most 7 rows above the screen.
+    int first_page = dst_y >> 3;
+    int last_page = (dst_y + dst_h - 1) >> 3;
+    int src_first = (dst_y - y) >> 3;
+    int src_end = src_pages < src_first + FB_PAGES ? src_pages : src_first + FB_PAGES;
+    int base = y + src_first * 8;   // Destination row of the word's bit 0, -7..63
+    uint8_t columns[FB_PAGES][FB_WIDTH];
+
+    for (int i = 0; i < w; i++) {
+        uint64_t column = 0;
+        for (int p = src_first; p < src_end; p++) {
+            column |= (uint64_t)bitmap[p * stride + src_x + i] << ((p - src_first) * 8);
+        }
+        if (base >= 0) {
+            column <<= base;
+        } else {
+            // The rows shifted out above the screen leave room at the
+            // bottom for the top of the next page
+            column >>= -base;
+            if (src_end < src_pages) {
+                column |= (uint64_t)bitmap[src_end * stride + src_x + i] << (64 + base);
+            }
+        }
+
+        for (int page = first_page; page <= last_page; page++) {
+            columns[page][i] = (uint8_t)(column >> (page * 8));
+        }
+    }
+
+    for (int page = first_page; page <= last_page; page++) {
+        fb_write_masked(fb, (uint8_t)page, (uint8_t)x, columns[page], (uint8_t)(mask >> (page * 8)), (size_t)w);
+    }
+}
+
+// Reference meter drawn one pixel at a time, for the benchmark
+static void gfx_bar_per_pixel(Framebuffer* fb, int x, int y, int w, int h, uint32_t value, uint32_t max) {
+    int filled = max ? (int)((uint64_t)(value < max ? value : max) * (w - 2) / max) : 0;
+
+    for (int row = 0; row < h; row++) {
+        for (int col = 0; col < w; col++) {
+            bool edge = row == 0 || row == h - 1 || col == 0 || col == w - 1;
+            fb_set_pixel(fb, x + col, y + row, edge || col - 1 < filled);
+        }
+    }
+}
+
+void gfx_benchmark() {
+    static Framebuffer scratch;
+    fb_init(&scratch);
+
+    const uint32_t passes = 500;
+
+    // A meter aligned to a page, then one straddling two pages
+    static const int rows[] = {48, 44};
+    for (int y : rows) {
+        uint64_t start = time_us_64();
+        for (uint32_t i = 0; i < passes; i++) {
+            gfx_bar(&scratch, 0, y, FB_WIDTH, 12, (i * 37) & 0xFFF, 4095);
+        }
+        uint32_t fast_us = (uint32_t)(time_us_64() - start);
+
+        start = time_us_64();
+        for (uint32_t i = 0; i < passes; i++) {
+            gfx_bar_per_pixel(&scratch, 0, y, FB_WIDTH, 12, (i * 37) & 0xFFF, 4095);
+        }
+        uint32_t pixel_us = (uint32_t)(time_us_64() - start);
+
+        printf("Gfx: 128x12 meter at y=%d: %u.%02uus fast path, %u.%02uus per pixel\n", y,
+               fast_us / passes, fast_us * 100 / passes % 100,
+               pixel_us / passes, pixel_us * 100 / passes % 100);
+    }
+}
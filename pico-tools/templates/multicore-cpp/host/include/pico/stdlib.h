@@ -0,0 +1,11 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// Host stand-in for the pico-sdk types the host tests need
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+
+#endif // HOST_PICO_STDLIB_H
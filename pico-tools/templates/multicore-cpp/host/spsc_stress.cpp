@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+#include "spsc_queue.h"
+
+// Runs spsc_queue.h's SpscQueue between two real threads, one producer
+// and one consumer. Every item carries its sequence number and words
+// derived from it, so a torn or stale slot shows up. Two phases:
+//   lossless: the producer retries a full queue, so every item must arrive,
+//             in order, exactly once
+//   lossy:    the producer drops on a full queue and the consumer
+//             dawdles, so items arrive in order and every gap must
+//             match the overrun count
+// Build with -DHOST_TSAN=ON to run it under ThreadSanitizer as well.
+// Exits non-zero on any mismatch.
+#define SIM_DEFAULT_ITEMS 4000000u
+#define SIM_QUEUE_SIZE 64
+
+struct SimItem {
+    uint32_t seq;
+    uint32_t check[3];   // ~seq, seq * odd constant, seq ^ pattern
+};
+
+typedef SpscQueue<SimItem, SIM_QUEUE_SIZE> SimQueue;
+
+static SimItem sim_make(uint32_t seq) {
+    SimItem item = {seq, {~seq, seq * 2654435761u, seq ^ 0xA5A5A5A5u}};
+    return item;
+}
+
+static bool sim_valid(const SimItem* item) {
+    SimItem expected = sim_make(item->seq);
+    return item->check[0] == expected.check[0] && item->check[1] == expected.check[1] &&
+           item->check[2] == expected.check[2];
+}
+
+struct SimResult {
+    uint32_t delivered;
+    uint32_t skipped;     // Sequence numbers missing between deliveries
+    uint32_t torn;        // Items whose check words don't match their sequence number
+    uint32_t reordered;   // Items at or below the previous sequence number
+};
+
+static SimResult sim_run(SimQueue* queue, uint32_t items, bool lossless) {
+    SimResult result = {0, 0, 0, 0};
+    std::atomic<bool> done{false};
+
+    std::thread producer([&]() {
+        for (uint32_t seq = 0; seq < items; seq++) {
+            SimItem item = sim_make(seq);
+            while (!queue->push(item) && lossless) {
+                std::this_thread::yield();
+            }
+            // Lets the consumer in on a single-core host
+            if ((seq & 0x3FF) == 0) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    std::thread consumer([&]() {
+        uint32_t next = 0;   // Sequence number expected next
+        SimItem item;
+        while (true) {
+            if (!queue->pop(&item)) {
+                if (!done.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                // Empty after the producer finished: nothing more can arrive
+                if (!queue->pop(&item)) break;
+            }
+            if (!sim_valid(&item)) result.torn++;
+            if (item.seq < next) {
+                result.reordered++;
+            } else {
+                result.skipped += item.seq - next;
+                next = item.seq + 1;
+            }
+            result.delivered++;
+
+            // The lossy phase drains slowly now and then so the queue fills
+            if (!lossless && (item.seq & 0xFF) == 0) {
+                for (volatile int spin = 0; spin < 2000; spin = spin + 1) {}
+            }
+        }
+        result.skipped += items - next;
+    });
+
+    producer.join();
+    consumer.join();
+    return result;
+}
+
+static int sim_check(const char* name, const SimQueue* queue, const SimResult* r, uint32_t items, bool lossless) {
+    uint32_t overruns = queue->overruns();
+    bool ok = r->torn == 0 && r->reordered == 0 && queue->max_depth() <= SIM_QUEUE_SIZE;
+    if (lossless) {
+        ok = ok && r->delivered == items && r->skipped == 0;
+    } else {
+        ok = ok && r->skipped == overruns && r->delivered + overruns == items;
+    }
+
+    printf("%-9s %8u sent %8u delivered %8u missing %8u overruns, high water %2u/%u, %u torn, %u out of order %s\n",
+           name, items, r->delivered, r->skipped, lossless ? 0 : overruns, queue->max_depth(),
+           SIM_QUEUE_SIZE, r->torn, r->reordered, ok ? "ok" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    uint32_t items = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : SIM_DEFAULT_ITEMS;
+    int failures = 0;
+
+    static SimQueue lossless_queue;
+    SimResult result = sim_run(&lossless_queue, items, true);
+    failures += sim_check("lossless", &lossless_queue, &result, items, true);
+
+    static SimQueue lossy_queue;
+    result = sim_run(&lossy_queue, items, false);
+    failures += sim_check("lossy", &lossy_queue, &result, items, false);
+    if (lossy_queue.overruns() == 0) {
+        printf("  the lossy phase never filled the queue\n");
+        failures++;
+    }
+
+    printf("\n%s\n", failures ? "FAILED: SPSC queue lost, tore or reordered items" : "SPSC queue delivered every item in order or counted it");
+    return failures ? 1 : 0;
+}
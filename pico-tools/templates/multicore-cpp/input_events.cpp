@@ -0,0 +1,140 @@
+#include "input_events.h"
+#include <stdio.h>
+
+#define INPUT_QUEUE_MASK (INPUT_QUEUE_SIZE - 1)
+
+struct InputChannel {
+    const char* name;
+    int32_t deadband;
+    uint32_t idle_after_us;
+    bool primed;              // Has reported a first value
+    int32_t reported;         // Value of the last event
+    uint32_t last_event_us;
+    uint32_t last_scan_pass;
+    uint32_t events;
+};
+
+static InputChannel input_channels[INPUT_MAX_CHANNELS];
+static uint8_t input_channel_count = 0;
+
+static InputEvent input_queue[INPUT_QUEUE_SIZE];
+static uint32_t input_queue_head = 0;   // Next slot to write
+static uint32_t input_queue_tail = 0;   // Next slot to read
+
+static InputStats input_stats;
+static uint32_t input_pass = 0;
+static uint32_t input_pass_start_us = 0;
+static uint32_t input_rate_us = 0;
+static uint32_t input_rate_scans = 0;
+static uint32_t input_rate_events = 0;
+
+int input_add_channel(const char* name, int32_t deadband, uint32_t idle_after_ms) {
+    if (input_channel_count >= INPUT_MAX_CHANNELS) return -1;
+
+    InputChannel* ch = &input_channels[input_channel_count];
+    ch->name = name;
+    ch->deadband = deadband;
+    ch->idle_after_us = idle_after_ms * 1000;
+    ch->primed = false;
+    ch->reported = 0;
+    ch->last_event_us = 0;
+    ch->last_scan_pass = 0;
+    ch->events = 0;
+    return input_channel_count++;
+}
+
+static bool input_is_active(const InputChannel* ch, uint32_t now_us) {
+    return !ch->primed || now_us - ch->last_event_us < ch->idle_after_us;
+}
+
+void input_scan_begin() {
+    input_pass_start_us = time_us_32();
+    input_pass++;
+}
+
+bool input_channel_due(int channel) {
+    if (channel < 0 || channel >= input_channel_count) return false;
+
+    const InputChannel* ch = &input_channels[channel];
+    return input_is_active(ch, input_pass_start_us) ||
+           input_pass - ch->last_scan_pass >= INPUT_IDLE_DIVIDER;
+}
+
+bool input_update(int channel, int32_t value) {
+    if (channel < 0 || channel >= input_channel_count) return false;
+
+    InputChannel* ch = &input_channels[channel];
+    ch->last_scan_pass = input_pass;
+    input_stats.channel_scans++;
+
+    // Inside the band around the last report: noise, not a change
+    int32_t delta = value - ch->reported;
+    if (ch->primed && delta <= ch->deadband && delta >= -ch->deadband) return false;
+
+    uint32_t now = time_us_32();
+    if (input_queue_head - input_queue_tail < INPUT_QUEUE_SIZE) {
+        InputEvent* event = &input_queue[input_queue_head++ & INPUT_QUEUE_MASK];
+        event->timestamp_us = now;
+        event->channel = (uint8_t)channel;
+        event->value = value;
+        event->previous = ch->primed ? ch->reported : value;
+    } else {
+        input_stats.dropped++;
+    }
+
+    ch->primed = true;
+    ch->reported = value;
+    ch->last_event_us = now;
+    ch->events++;
+    input_stats.events++;
+    return true;
+}
+
+void input_scan_end() {
+    uint32_t now = time_us_32();
+    uint32_t elapsed = now - input_pass_start_us;
+
+    input_stats.scans++;
+    input_stats.last_scan_us = elapsed;
+    input_stats.total_scan_us += elapsed;
+    if (elapsed > input_stats.max_scan_us) input_stats.max_scan_us = elapsed;
+
+    if (now - input_rate_us >= 1000000) {
+        input_stats.scan_rate = input_stats.scans - input_rate_scans;
+        input_stats.event_rate = input_stats.events - input_rate_events;
+        input_rate_scans = input_stats.scans;
+        input_rate_events = input_stats.events;
+        input_rate_us = now;
+    }
+}
+
+bool input_next_event(InputEvent* event) {
+    if (input_queue_tail == input_queue_head) return false;
+
+    *event = input_queue[input_queue_tail++ & INPUT_QUEUE_MASK];
+    return true;
+}
+
+bool input_channel_active(int channel) {
+    if (channel < 0 || channel >= input_channel_count) return false;
+    return input_is_active(&input_channels[channel], time_us_32());
+}
+
+const InputStats* input_get_stats() {
+    return &input_stats;
+}
+
+void input_print_stats() {
+    const InputStats* stats = &input_stats;
+    uint32_t avg_us = stats->scans ? (uint32_t)(stats->total_scan_us / stats->scans) : 0;
+
+    printf("Input: %u scans/s, %u events/s (%u total, %u dropped), "
+           "CPU per scan avg %uus max %uus, %u channel updates\n",
+           stats->scan_rate, stats->event_rate, stats->events, stats->dropped,
+           avg_us, stats->max_scan_us, stats->channel_scans);
+    for (uint8_t i = 0; i < input_channel_count; i++) {
+        const InputChannel* ch = &input_channels[i];
+        printf("  %-8s %s, value %d (deadband %d), %u events\n", ch->name,
+               input_channel_active(i) ? "active" : "idle", ch->reported, ch->deadband, ch->events);
+    }
+}
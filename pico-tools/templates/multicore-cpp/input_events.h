@@ -0,0 +1,55 @@
+#ifndef INPUT_EVENTS_H
+#define INPUT_EVENTS_H
+
+#include "pico/stdlib.h"
+
+// Change-driven input layer for core1. Each scan pass reports channel values
+// (averaged ADC readings, pot positions) and a channel emits an event only
+// when its value moves more than its deadband away from the last value it
+// reported, so noise inside the band produces nothing downstream. Channels
+// with no event for their idle time are only due every INPUT_IDLE_DIVIDER
+// passes; an event makes them active again. What a skipped channel saves
+// is up to the caller: core1 still has the ADC convert it and only skips
+// averaging and the deadband check.
+#define INPUT_MAX_CHANNELS 8
+#define INPUT_QUEUE_SIZE 16     // Events waiting for the consumer (power of two)
+#define INPUT_IDLE_DIVIDER 5    // Idle channels are due every 5th pass
+
+struct InputEvent {
+    uint32_t timestamp_us;
+    uint8_t channel;
+    int32_t value;
+    int32_t previous;     // Last reported value (equal to value for a channel's first event)
+};
+
+struct InputStats {
+    uint32_t scans;          // Passes
+    uint32_t channel_scans;  // input_update() calls, over all passes
+    uint32_t events;
+    uint32_t dropped;        // Events lost to a full queue
+    uint32_t scan_rate;      // Passes during the last second
+    uint32_t event_rate;     // Events during the last second
+    uint32_t last_scan_us;   // CPU time of the last pass
+    uint32_t max_scan_us;
+    uint64_t total_scan_us;
+};
+
+// Setup: returns the channel index, or -1 if the table is full
+int input_add_channel(const char* name, int32_t deadband, uint32_t idle_after_ms);
+
+// One scan pass: begin, then input_update() for each channel that is due,
+// then end. The time between begin and end counts as the pass's CPU time.
+void input_scan_begin();
+bool input_channel_due(int channel);
+bool input_update(int channel, int32_t value);  // True if the value emitted an event
+void input_scan_end();
+
+// Consumer (same core): false when no event is waiting
+bool input_next_event(InputEvent* event);
+
+// Statistics
+bool input_channel_active(int channel);
+const InputStats* input_get_stats();
+void input_print_stats();
+
+#endif // INPUT_EVENTS_H
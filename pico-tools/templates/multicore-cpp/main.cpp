@@ -1,10 +1,13 @@
 #include <stdio.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
 #include "hardware/gpio.h"
 #include "hardware/pwm.h"
 #include "shared_data.h"
 #include "core1_tasks.h"
+#include "render_pipeline.h"
+#include "debounce.h"
 
 // Core0 pin definitions
 const uint LED_PIN = PICO_DEFAULT_LED_PIN;
@@ -15,12 +18,16 @@ const uint PWM_PIN = 15;
 struct Core0State {
     bool led_state;
     bool button_pressed;
-    bool button_last_state;
     uint32_t button_press_count;
-    uint32_t last_button_time;
     uint32_t last_status_time;
 } core0_state = {0};
 
+static int button_input = -1;   // Debounce input number
+
+// Newest sample from core1, and how many arrived through the queue
+static SensorSample core0_sample = {0, 0.0f, 0, 0};
+static uint32_t core0_samples_received = 0;
+
 void setup_core0_hardware() {
     stdio_init_all();
     
@@ -33,6 +40,10 @@ void setup_core0_hardware() {
     gpio_set_dir(BUTTON_PIN, GPIO_IN);
     gpio_pull_up(BUTTON_PIN);
     
+    // Debounced from a 1ms tick that only runs while the button is moving
+    button_input = debounce_add_gpio(BUTTON_PIN, true);
+    debounce_start();
+    
     // PWM setup
     gpio_set_function(PWM_PIN, GPIO_FUNC_PWM);
     uint slice_num = pwm_gpio_to_slice_num(PWM_PIN);
@@ -45,42 +56,45 @@ void setup_core0_hardware() {
 }
 
 void handle_button_input() {
-    uint32_t current_time = to_ms_since_boot(get_absolute_time());
-    bool button_current = !gpio_get(BUTTON_PIN);
-    
-    // Debounce button (50ms)
-    if (button_current != core0_state.button_last_state) {
-        if (current_time - core0_state.last_button_time > 50) {
-            core0_state.button_pressed = button_current;
-            
-            if (button_current && !core0_state.button_last_state) {
-                // Button press detected
-                core0_state.button_press_count++;
-                printf("Core0: Button pressed (count: %u)\n", core0_state.button_press_count);
-                
-                // Toggle LED enable state
-                bool led_enable, led_brightness;
-                uint32_t sample_rate;
-                get_control_data(&led_enable, &led_brightness, &sample_rate);
-                
-                // Cycle through sample rates: 50ms, 100ms, 200ms, 500ms
-                uint32_t new_rate = sample_rate;
-                switch (sample_rate) {
-                    case 50: new_rate = 100; break;
-                    case 100: new_rate = 200; break;
-                    case 200: new_rate = 500; break;
-                    case 500: new_rate = 50; break;
-                    default: new_rate = 100; break;
-                }
-                
-                set_control_data(!led_enable, led_brightness, new_rate);
-                printf("Core0: LED %s, Sample rate: %ums\n", 
-                       !led_enable ? "ON" : "OFF", new_rate);
-            }
-            
-            core0_state.last_button_time = current_time;
+    // Press and release events from the debouncer, in order, even if
+    // several arrived since the last loop
+    DebounceEvent event;
+    while (debounce_next_event(&event)) {
+        if (event.input != button_input) continue;
+        
+        core0_state.button_pressed = event.pressed;
+        if (!event.pressed) continue;
+        
+        // Button press detected
+        core0_state.button_press_count++;
+        printf("Core0: Button pressed (count: %u, %uus after the edge)\n",
+               core0_state.button_press_count, event.timestamp_us - event.edge_us);
+        
+        // Toggle LED enable state
+        bool led_enable;
+        uint8_t led_brightness;
+        uint32_t sample_rate;
+        get_control_data(&led_enable, &led_brightness, &sample_rate);
+        
+        // Cycle through sample rates: 50ms, 100ms, 200ms, 500ms
+        uint32_t new_rate = sample_rate;
+        switch (sample_rate) {
+            case 50: new_rate = 100; break;
+            case 100: new_rate = 200; break;
+            case 200: new_rate = 500; break;
+            case 500: new_rate = 50; break;
+            default: new_rate = 100; break;
         }
-        core0_state.button_last_state = button_current;
+        
+        // The control data shows the new rate; core1 changes its loop
+        // period when it takes the command
+        set_control_data(!led_enable, led_brightness, new_rate);
+        Core1Command command = {CORE1_CMD_SAMPLE_RATE, new_rate};
+        if (!g_command_queue.push(command)) {
+            printf("Core0: Command queue full, rate change dropped\n");
+        }
+        printf("Core0: LED %s, Sample rate: %ums\n", 
+               !led_enable ? "ON" : "OFF", new_rate);
     }
 }
 
@@ -113,16 +127,79 @@ void update_outputs() {
     pwm_set_gpio_level(PWM_PIN, led_brightness);
 }
 
+// Takes every sample core1 queued since the last loop; the display and
+// status show the newest
+void drain_sensor_samples() {
+    SensorSample sample;
+    while (g_sensor_queue.pop(&sample)) {
+        core0_sample = sample;
+        core0_samples_received++;
+    }
+}
+
+// Snapshot of what the display shows; render_submit() copies it and
+// returns. Unless always is set, an unchanged scene is not sent, so the
+// display only redraws when an input or setting changed.
+void publish_scene(bool always) {
+    static RenderScene last_scene;
+    RenderScene scene;
+    memset(&scene, 0, sizeof(scene));  // Padding too: scenes are compared bytewise
+    scene.temperature = core0_sample.temperature;
+    scene.light_level = core0_sample.light_level;
+    scene.sample_count = core0_sample.sample_count;
+    get_control_data(&scene.led_enable, &scene.led_brightness, &scene.sample_rate_ms);
+    scene.button_presses = core0_state.button_press_count;
+    
+    if (!always && memcmp(&scene, &last_scene, sizeof(scene)) == 0) return;
+    last_scene = scene;
+    render_submit(&scene);
+}
+
+// Core0 loop latency with the display rendered inline vs on core1. Runs the
+// main loop body without its waits, so the numbers are the time between
+// input polls that display work adds.
+#define RENDER_BENCH_LOOPS 200
+
+void benchmark_render_offload() {
+    printf("\n=== Render Offload Benchmark (%u loops each) ===\n", RENDER_BENCH_LOOPS);
+    
+    for (int pass = 0; pass < 2; pass++) {
+        bool offload = pass == 1;
+        render_set_offload(offload);
+        render_reset_stats();
+        
+        uint32_t max_us = 0;
+        uint64_t total_us = 0;
+        for (int i = 0; i < RENDER_BENCH_LOOPS; i++) {
+            uint32_t start = time_us_32();
+            handle_button_input();
+            update_outputs();
+            publish_scene(true);
+            uint32_t elapsed = time_us_32() - start;
+            
+            total_us += elapsed;
+            if (elapsed > max_us) max_us = elapsed;
+            sleep_ms(10);
+        }
+        
+        const RenderStats* stats = render_get_stats();
+        printf("Render on core%d: core0 loop avg %uus, max %uus (%u frames, last flush %uus)\n",
+               offload ? 1 : 0, (uint32_t)(total_us / RENDER_BENCH_LOOPS), max_us,
+               stats->rendered, stats->last_flush_us);
+    }
+    
+    render_set_offload(RENDER_ON_CORE1);
+}
+
 void print_system_status() {
     static uint32_t last_print = 0;
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
     
     if (current_time - last_print > 3000) { // Every 3 seconds
-        // Get sensor data
-        float temperature;
-        uint16_t light_level;
-        uint32_t sample_count;
-        get_sensor_data(&temperature, &light_level, &sample_count);
+        // Newest sensor data from the queue
+        float temperature = core0_sample.temperature;
+        uint16_t light_level = core0_sample.light_level;
+        uint32_t sample_count = core0_sample.sample_count;
         
         // Get control data
         bool led_enable;
@@ -143,7 +220,7 @@ void print_system_status() {
         printf("\nSensor Data:\n");
         printf("  Temperature: %.1f°C (avg: %.1f°C)\n", temperature, avg_temperature);
         printf("  Light Level: %d/4095\n", light_level);
-        printf("  Sample Count: %u\n", sample_count);
+        printf("  Sample Count: %u (%u updates received)\n", sample_count, core0_samples_received);
         printf("  Sample Rate: %ums\n", sample_rate);
         printf("\nControl State:\n");
         printf("  LED Enable: %s\n", led_enable ? "ON" : "OFF");
@@ -151,6 +228,9 @@ void print_system_status() {
         printf("  Button Presses: %u\n", core0_state.button_press_count);
         printf("\nPerformance:\n");
         printf("  Max Loop Time: %uus\n", max_loop_time);
+        render_print_stats();
+        debounce_print_stats();
+        print_queue_stats();
         
         last_print = current_time;
         core0_state.last_status_time = current_time;
@@ -178,6 +258,9 @@ int main() {
     // Initialize shared data structures
     shared_data_init();
     
+    // Display comes up before core1 starts rendering to it
+    render_pipeline_init();
+    
     printf("Core0: Launching Core1...\n");
     
     // Start core1
@@ -188,29 +271,37 @@ int main() {
         sleep_ms(10);
     }
     
+    benchmark_render_offload();
+    debounce_benchmark();
+    
     printf("Core0: Both cores running, starting main loop\n");
     
     while (true) {
         // Update core0 heartbeat
         g_shared_data.core0_heartbeat++;
         
+        // Take every sample core1 sent since the last loop
+        drain_sensor_samples();
+        
         // Handle user input
         handle_button_input();
         
         // Update outputs based on shared data
         update_outputs();
         
+        // Hand the display state to core1 if it changed (never waits on I2C)
+        publish_scene(false);
+        
         // Print periodic status
         print_system_status();
         
         // Monitor core1 health
         monitor_core1_health();
         
-        // Wait for new data from core1 (with timeout)
-        bool got_data = sem_acquire_timeout_ms(&g_sync.data_ready_sem, 100);
-        if (!got_data) {
-            printf("Core0: Timeout waiting for Core1 data\n");
-        }
+        // Wait for new data from core1 (with timeout). Core1 only signals
+        // when an input changed, so a timeout is normal while nothing
+        // moves; a stalled core1 shows in its heartbeat instead.
+        sem_acquire_timeout_ms(&g_sync.data_ready_sem, 100);
         
         // Small delay to prevent overwhelming the system
         sleep_ms(10);
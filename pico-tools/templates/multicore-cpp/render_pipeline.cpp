@@ -0,0 +1,142 @@
+#include "render_pipeline.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/sync.h"
+#include "display.h"
+#include "text.h"
+#include "gfx.h"
+
+// Hand-off slot between the cores: core0 overwrites it, core1 empties it.
+// The lock only covers copying a few words, never drawing or I2C.
+static critical_section_t render_lock;
+static RenderScene render_latest;
+static bool render_pending = false;
+static bool render_offload = RENDER_ON_CORE1;
+
+// Set while core1 is drawing or flushing a scene it took from the slot
+static volatile bool render_busy = false;
+
+static RenderStats render_stats;
+
+// One text row, cleared to the right edge so a shorter value leaves no tail
+static void render_line(Framebuffer* fb, uint8_t row, const char* text) {
+    int y = row * TEXT_LINE_HEIGHT;
+    int end = text_draw(fb, 0, y, text);
+    if (end < FB_WIDTH) {
+        gfx_fill_rect(fb, end, y, FB_WIDTH - end, TEXT_LINE_HEIGHT, false);
+    }
+}
+
+// Redraws the whole scene; the framebuffer only marks bytes that changed,
+// so the flush still sends just the values that moved
+static void render_rasterise(Framebuffer* fb, const RenderScene* scene) {
+    char line[24];
+
+    snprintf(line, sizeof(line), "Temp    %.1f°C", scene->temperature);
+    render_line(fb, 0, line);
+    snprintf(line, sizeof(line), "Light   %u", (unsigned)scene->light_level);
+    render_line(fb, 1, line);
+    snprintf(line, sizeof(line), "Samples %u", (unsigned)scene->sample_count);
+    render_line(fb, 2, line);
+    snprintf(line, sizeof(line), "Rate    %ums", (unsigned)scene->sample_rate_ms);
+    render_line(fb, 3, line);
+    if (scene->led_enable) {
+        snprintf(line, sizeof(line), "LED     ON %u", (unsigned)scene->led_brightness);
+    } else {
+        snprintf(line, sizeof(line), "LED     OFF");
+    }
+    render_line(fb, 4, line);
+    snprintf(line, sizeof(line), "Button  %u", (unsigned)scene->button_presses);
+    render_line(fb, 5, line);
+
+    gfx_bar(fb, 0, FB_HEIGHT - 12, FB_WIDTH, 12, scene->light_level, 4095);
+}
+
+static void render_frame(const RenderScene* scene) {
+    uint32_t start = time_us_32();
+    render_rasterise(display_get_framebuffer(), scene);
+    uint32_t rasterised = time_us_32();
+    display_flush();
+
+    render_stats.last_raster_us = rasterised - start;
+    render_stats.last_flush_us = time_us_32() - rasterised;
+    render_stats.rendered++;
+}
+
+void render_pipeline_init() {
+    critical_section_init(&render_lock);
+    memset(&render_stats, 0, sizeof(render_stats));
+    display_init();
+}
+
+void render_submit(const RenderScene* scene) {
+    critical_section_enter_blocking(&render_lock);
+    bool offload = render_offload;
+    render_stats.submitted++;
+    if (offload) {
+        if (render_pending) {
+            render_stats.replaced++;
+        }
+        render_latest = *scene;
+        render_pending = true;
+    }
+    critical_section_exit(&render_lock);
+
+    if (!offload) {
+        render_frame(scene);
+    }
+}
+
+void render_pipeline_service() {
+    RenderScene scene;
+    bool have_scene = false;
+
+    // Busy is raised under the same lock that checks the mode, so
+    // render_set_offload(false) cannot miss a frame about to start
+    critical_section_enter_blocking(&render_lock);
+    if (render_offload && render_pending) {
+        scene = render_latest;
+        render_pending = false;
+        render_busy = true;
+        have_scene = true;
+    }
+    critical_section_exit(&render_lock);
+
+    if (!have_scene) return;
+
+    render_frame(&scene);
+    render_busy = false;
+}
+
+void render_set_offload(bool enabled) {
+    critical_section_enter_blocking(&render_lock);
+    render_offload = enabled;
+    render_pending = false;
+    critical_section_exit(&render_lock);
+
+    // The display now belongs to the submitting core once core1 lets go
+    while (!enabled && render_busy) {
+        tight_loop_contents();
+    }
+}
+
+bool render_offload_enabled() {
+    return render_offload;
+}
+
+const RenderStats* render_get_stats() {
+    return &render_stats;
+}
+
+void render_reset_stats() {
+    critical_section_enter_blocking(&render_lock);
+    memset(&render_stats, 0, sizeof(render_stats));
+    critical_section_exit(&render_lock);
+}
+
+void render_print_stats() {
+    printf("  Render: %s, %u frames (%u of %u scenes replaced), raster %uus, flush %uus\n",
+           render_offload ? "core1" : "core0", render_stats.rendered,
+           render_stats.replaced, render_stats.submitted,
+           render_stats.last_raster_us, render_stats.last_flush_us);
+}
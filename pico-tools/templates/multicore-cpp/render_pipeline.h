@@ -0,0 +1,53 @@
+#ifndef RENDER_PIPELINE_H
+#define RENDER_PIPELINE_H
+
+#include "pico/stdlib.h"
+
+// Display rendering as a pipeline stage. Core0 publishes a RenderScene
+// snapshot and carries on; core1 rasterises the newest snapshot into the
+// back buffer and flushes it, so core0 never waits on display I/O. A scene
+// published before core1 took the previous one replaces it (no queue).
+// With the offload off, render_submit() rasterises and flushes on the
+// calling core instead.
+#ifndef RENDER_ON_CORE1
+#define RENDER_ON_CORE1 1
+#endif
+
+// Everything the screen shows, copied by value inside a critical section
+struct RenderScene {
+    float temperature;
+    uint16_t light_level;
+    uint32_t sample_count;
+    uint32_t sample_rate_ms;
+    uint32_t button_presses;
+    uint8_t led_brightness;
+    bool led_enable;
+};
+
+struct RenderStats {
+    uint32_t submitted;       // Scenes published with render_submit()
+    uint32_t rendered;        // Frames rasterised and flushed
+    uint32_t replaced;        // Scenes overwritten before core1 took them
+    uint32_t last_raster_us;  // Drawing into the back buffer
+    uint32_t last_flush_us;   // Sending the changed windows
+};
+
+// Setup: brings up the display (call on core0 before launching core1)
+void render_pipeline_init();
+
+// Core0: publish the latest state. Offloaded, this only copies the scene.
+void render_submit(const RenderScene* scene);
+
+// Core1: renders the newest published scene, if any (call from the core1 loop)
+void render_pipeline_service();
+
+// Offload control; turning it off waits for a frame core1 has in hand
+void render_set_offload(bool enabled);
+bool render_offload_enabled();
+
+// Statistics
+const RenderStats* render_get_stats();
+void render_reset_stats();
+void render_print_stats();
+
+#endif // RENDER_PIPELINE_H
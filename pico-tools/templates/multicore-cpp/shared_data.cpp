@@ -1,9 +1,12 @@
 #include "shared_data.h"
+#include <stdio.h>
 #include <string.h>
 
 // Global shared data instances
 SharedData g_shared_data = {0};
 SyncObjects g_sync;
+SpscQueue<SensorSample, SENSOR_QUEUE_SIZE> g_sensor_queue;
+SpscQueue<Core1Command, COMMAND_QUEUE_SIZE> g_command_queue;
 
 void shared_data_init() {
     // Initialize shared data to safe defaults
@@ -19,26 +22,23 @@ void shared_data_init() {
 }
 
 void set_sensor_data(float temp, uint16_t light, uint32_t count) {
-    critical_section_enter_blocking(&g_sync.critical_sec);
-    
+    // Only core1 touches the latest values, so they need no lock
     g_shared_data.temperature = temp;
     g_shared_data.light_level = light;
     g_shared_data.sample_count = count;
     
-    critical_section_exit(&g_sync.critical_sec);
+    // Core0 gets every sample, not just the latest; a full queue counts an overrun
+    SensorSample sample = {time_us_32(), temp, light, count};
+    g_sensor_queue.push(sample);
     
     // Signal that new data is available
     sem_release(&g_sync.data_ready_sem);
 }
 
 void get_sensor_data(float* temp, uint16_t* light, uint32_t* count) {
-    critical_section_enter_blocking(&g_sync.critical_sec);
-    
     if (temp) *temp = g_shared_data.temperature;
     if (light) *light = g_shared_data.light_level;
     if (count) *count = g_shared_data.sample_count;
-    
-    critical_section_exit(&g_sync.critical_sec);
 }
 
 void set_control_data(bool led_en, uint8_t brightness, uint32_t rate) {
@@ -62,8 +62,10 @@ void get_control_data(bool* led_en, uint8_t* brightness, uint32_t* rate) {
 }
 
 void update_statistics(uint32_t loop_time_us, float temperature) {
+    // Summed in whole millidegrees: a float sum rounds away more of each
+    // sample as it grows (within a day at 100ms) and eventually stops moving
     static uint32_t temp_samples = 0;
-    static float temp_sum = 0.0f;
+    static int64_t temp_sum_mdeg = 0;
     
     critical_section_enter_blocking(&g_sync.critical_sec);
     
@@ -73,9 +75,9 @@ void update_statistics(uint32_t loop_time_us, float temperature) {
     }
     
     // Update running average temperature
-    temp_sum += temperature;
+    temp_sum_mdeg += (int32_t)(temperature * 1000.0f + (temperature < 0 ? -0.5f : 0.5f));
     temp_samples++;
-    g_shared_data.avg_temperature = temp_sum / temp_samples;
+    g_shared_data.avg_temperature = (float)(temp_sum_mdeg / temp_samples) / 1000.0f;
     
     critical_section_exit(&g_sync.critical_sec);
 }
@@ -87,4 +89,11 @@ void get_statistics(uint32_t* max_loop, float* avg_temp) {
     if (avg_temp) *avg_temp = g_shared_data.avg_temperature;
     
     critical_section_exit(&g_sync.critical_sec);
-}
\ No newline at end of file
+}
+
+void print_queue_stats() {
+    printf("  Sensor queue: %u/%u queued, high water %u, %u overruns\n",
+           g_sensor_queue.depth(), SENSOR_QUEUE_SIZE, g_sensor_queue.max_depth(), g_sensor_queue.overruns());
+    printf("  Command queue: %u/%u queued, high water %u, %u overruns\n",
+           g_command_queue.depth(), COMMAND_QUEUE_SIZE, g_command_queue.max_depth(), g_command_queue.overruns());
+}
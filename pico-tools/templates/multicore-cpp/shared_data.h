@@ -3,10 +3,32 @@
 
 #include "pico/stdlib.h"
 #include "pico/sync.h"
+#include "spsc_queue.h"
+
+// Sensor readings as core1 publishes them, every one in order
+struct SensorSample {
+    uint32_t timestamp_us;
+    float temperature;
+    uint16_t light_level;
+    uint32_t sample_count;
+};
+
+// Requests from core0, applied by core1 at the top of its loop
+enum Core1CommandType : uint8_t {
+    CORE1_CMD_SAMPLE_RATE   // value: loop period in ms
+};
+
+struct Core1Command {
+    Core1CommandType type;
+    uint32_t value;
+};
+
+#define SENSOR_QUEUE_SIZE 64
+#define COMMAND_QUEUE_SIZE 8
 
 // Shared data structure between cores
 struct SharedData {
-    // Sensor readings (updated by core1)
+    // Latest sensor readings (core1's own copy; core0 reads g_sensor_queue)
     volatile float temperature;
     volatile uint16_t light_level;
     volatile uint32_t sample_count;
@@ -37,10 +59,15 @@ struct SyncObjects {
 extern SharedData g_shared_data;
 extern SyncObjects g_sync;
 
+// Lock-free streams between the cores
+extern SpscQueue<SensorSample, SENSOR_QUEUE_SIZE> g_sensor_queue;    // core1 -> core0
+extern SpscQueue<Core1Command, COMMAND_QUEUE_SIZE> g_command_queue;  // core0 -> core1
+
 // Initialization
 void shared_data_init();
 
-// Thread-safe data access functions
+// Data access functions. Sensor data belongs to core1: setting it also
+// queues a SensorSample for core0.
 void set_sensor_data(float temp, uint16_t light, uint32_t count);
 void get_sensor_data(float* temp, uint16_t* light, uint32_t* count);
 void set_control_data(bool led_en, uint8_t brightness, uint32_t rate);
@@ -49,5 +76,6 @@ void get_control_data(bool* led_en, uint8_t* brightness, uint32_t* rate);
 // Statistics functions
 void update_statistics(uint32_t loop_time_us, float temperature);
 void get_statistics(uint32_t* max_loop, float* avg_temp);
+void print_queue_stats();
 
 #endif // SHARED_DATA_H
\ No newline at end of file
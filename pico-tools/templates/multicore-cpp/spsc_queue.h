@@ -0,0 +1,70 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include "pico/stdlib.h"
+
+// Lock-free ring for one producer core and one consumer core. Only the
+// producer writes head and only the consumer writes tail, so neither side
+// ever waits or masks interrupts: an item is copied into its slot before
+// head is published with release ordering, and the consumer reads head
+// with acquire ordering before copying the slot out (tail likewise in the
+// other direction). Head and tail count items forever and wrap at 2^32;
+// Size must be a power of two so the slot index stays right across the wrap.
+// Only plain atomic loads and stores are used (no read-modify-write), so
+// the queue also works between the RP2040's M0+ cores.
+//
+//   static SpscQueue<SensorSample, 64> samples;   // core1 -> core0
+//   samples.push(sample);                         // core1
+//   while (samples.pop(&sample)) { ... }          // core0
+//
+// A full queue drops the new item (the producer cannot move tail) and
+// counts it as an overrun.
+template <typename T, uint32_t Size>
+struct SpscQueue {
+    static_assert(Size >= 2 && (Size & (Size - 1)) == 0, "SpscQueue size must be a power of two");
+    static constexpr uint32_t capacity = Size;
+
+    T slots[Size];
+    std::atomic<uint32_t> head{0};         // Next slot to fill; producer only
+    std::atomic<uint32_t> tail{0};         // Next slot to empty; consumer only
+    std::atomic<uint32_t> overrun_count{0};   // Items dropped on a full queue
+    std::atomic<uint32_t> high_water{0};      // Deepest the queue has been after a push
+
+    // Producer side
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t depth = h - tail.load(std::memory_order_acquire);
+        if (depth >= Size) {
+            overrun_count.store(overrun_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slots[h & (Size - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        if (depth + 1 > high_water.load(std::memory_order_relaxed)) {
+            high_water.store(depth + 1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T* item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+
+        *item = slots[t & (Size - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Snapshot from either side; the other side may move it at any time
+    uint32_t depth() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    uint32_t overruns() const { return overrun_count.load(std::memory_order_relaxed); }
+    uint32_t max_depth() const { return high_water.load(std::memory_order_relaxed); }
+};
+
+#endif // SPSC_QUEUE_H
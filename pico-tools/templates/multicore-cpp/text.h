@@ -0,0 +1,21 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include "pico/stdlib.h"
+#include "framebuffer.h"
+#include "font5x7.h"
+
+// Text is drawn in 8-pixel tall cells (7 glyph rows plus a blank row) that
+// replace whatever was underneath, so redrawing a value needs no clear first
+#define TEXT_LINE_HEIGHT 8
+
+// Drawing: one line of UTF-8 text (stops at '\n'), clipped to the framebuffer.
+// y on a page boundary (multiple of 8) is a straight column copy; any other
+// y is split across two pages. Returns the x just past the last glyph.
+int text_draw(Framebuffer* fb, int x, int y, const char* text);
+int text_width(const char* text);
+
+// Prints aligned and unaligned glyphs per second (draws into a scratch buffer)
+void text_benchmark();
+
+#endif // TEXT_H